@@ -22,13 +22,21 @@
 
 using namespace XFILE;
 
+namespace
+{
+// Images decoded at once, bounded by the low priority workers
+const unsigned int MAX_CACHE_JOBS = 2;
+// Completed textures stored in one database transaction
+const size_t MAX_PENDING_TEXTURES = 50;
+}
+
 CTextureCache &CTextureCache::GetInstance()
 {
   static CTextureCache s_cache;
   return s_cache;
 }
 
-CTextureCache::CTextureCache() : CJobQueue(false, 1, CJob::PRIORITY_LOW_PAUSABLE)
+CTextureCache::CTextureCache() : CJobQueue(false, MAX_CACHE_JOBS, CJob::PRIORITY_LOW_PAUSABLE)
 {
 }
 
@@ -44,7 +52,12 @@ void CTextureCache::Initialize()
 void CTextureCache::Deinitialize()
 {
   CancelJobs();
+  {
+    CSingleLock lock(m_processingSection);
+    m_queuedlist.clear();
+  }
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   m_database.Close();
 }
 
@@ -114,17 +127,29 @@ void CTextureCache::BackgroundCacheImage(const std::string &url)
   if (url.empty())
     return;
 
-  CTextureDetails details;
-  std::string path(GetCachedImage(url, details));
-  if (!path.empty() && details.hash.empty())
-    return; // image is already cached and doesn't need to be checked further
-
-  path = CTextureUtils::UnwrapImageURL(url);
+  std::string path = CTextureUtils::UnwrapImageURL(url);
   if (path.empty())
     return;
 
-  // needs (re)caching
-  AddJob(new CTextureCacheJob(path, details.hash));
+  { // coalesce with a request that is already queued, without a database lookup
+    CSingleLock lock(m_processingSection);
+    if (!m_queuedlist.insert(path).second)
+      return;
+  }
+
+  CTextureDetails details;
+  std::string cachedPath(GetCachedImage(url, details));
+  bool queued = false;
+  if (cachedPath.empty() || !details.hash.empty())
+  { // needs (re)caching
+    queued = AddJob(new CTextureCacheJob(path, details.hash));
+  }
+
+  if (!queued)
+  {
+    CSingleLock lock(m_processingSection);
+    m_queuedlist.erase(path);
+  }
 }
 
 std::string CTextureCache::CacheImage(const std::string &image, CBaseTexture **texture /* = NULL */, CTextureDetails *details /* = NULL */)
@@ -206,12 +231,25 @@ bool CTextureCache::ClearCachedImage(int id)
 bool CTextureCache::GetCachedTexture(const std::string &url, CTextureDetails &details)
 {
   CSingleLock lock(m_databaseSection);
-  return m_database.GetCachedTexture(url, details);
+  m_lookups++;
+  std::map<std::string, PendingTexture>::const_iterator i = m_pendingTextures.find(url);
+  if (i != m_pendingTextures.end() && !i->second.validate)
+  { // cached, but not yet in the database. The details need the id of the
+    // database row, so store the batch now
+    FlushCachedTextures();
+    return m_database.GetCachedTexture(url, details);
+  }
+  if (!m_database.GetCachedTexture(url, details))
+    return false;
+  if (i != m_pendingTextures.end())
+    details.hash.clear(); // just checked for updates
+  return true;
 }
 
 bool CTextureCache::AddCachedTexture(const std::string &url, const CTextureDetails &details)
 {
   CSingleLock lock(m_databaseSection);
+  m_pendingTextures.erase(url);
   return m_database.AddCachedTexture(url, details);
 }
 
@@ -237,12 +275,14 @@ bool CTextureCache::SetCachedTextureValid(const std::string &url, bool updateabl
 bool CTextureCache::ClearCachedTexture(const std::string &url, std::string &cachedURL)
 {
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   return m_database.ClearCachedTexture(url, cachedURL);
 }
 
 bool CTextureCache::ClearCachedTexture(int id, std::string &cachedURL)
 {
   CSingleLock lock(m_databaseSection);
+  FlushCachedTextures();
   return m_database.ClearCachedTexture(id, cachedURL);
 }
 
@@ -261,14 +301,42 @@ std::string CTextureCache::GetCachedPath(const std::string &file)
   return URIUtils::AddFileToFolder(profileManager->GetThumbnailsFolder(), file);
 }
 
-void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
+void CTextureCache::FlushCachedTextures()
 {
-  if (success)
+  CSingleLock lock(m_databaseSection);
+  if (m_pendingTextures.empty())
+    return;
+
+  m_database.BeginTransaction();
+  for (std::map<std::string, PendingTexture>::const_iterator i = m_pendingTextures.begin(); i != m_pendingTextures.end(); ++i)
   {
-    if (job->m_oldHash == job->m_details.hash)
-      SetCachedTextureValid(job->m_url, job->m_details.updateable);
+    if (i->second.validate)
+      m_database.SetCachedTextureValid(i->first, i->second.details.updateable);
     else
-      AddCachedTexture(job->m_url, job->m_details);
+      m_database.AddCachedTexture(i->first, i->second.details);
+  }
+  if (!m_database.CommitTransaction())
+    CLog::Log(LOGERROR, "%s failed storing %u textures", __FUNCTION__, static_cast<unsigned int>(m_pendingTextures.size()));
+  m_pendingTextures.clear();
+}
+
+void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
+{
+  const bool queueEmpty = QueueEmpty();
+  {
+    CSingleLock lock(m_databaseSection);
+    if (success)
+    {
+      PendingTexture texture = { job->m_details, job->m_oldHash == job->m_details.hash };
+      if (texture.validate)
+        m_pendingTextures.insert(std::make_pair(job->m_url, texture)); // never replaces a new texture
+      else
+        m_pendingTextures[job->m_url] = texture;
+    }
+
+    // store the batch once it's full, or once no more images are waiting
+    if (m_pendingTextures.size() >= MAX_PENDING_TEXTURES || queueEmpty)
+      FlushCachedTextures();
   }
 
   { // remove from our processing list
@@ -276,6 +344,7 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
     std::set<std::string>::iterator i = m_processinglist.find(job->m_url);
     if (i != m_processinglist.end())
       m_processinglist.erase(i);
+    m_queuedlist.erase(job->m_url);
   }
 
   m_completeEvent.Set();
@@ -301,6 +370,8 @@ void CTextureCache::OnJobProgress(unsigned int jobID, unsigned int progress, uns
         m_processinglist.insert(cacheJob->m_url);
         return;
       }
+      // already being cached directly
+      m_queuedlist.erase(cacheJob->m_url);
     }
     CancelJob(job);
   }
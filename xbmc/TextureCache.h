@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -27,9 +28,14 @@ class CBaseTexture;
  may be periodically checked for updates and may be purged from the cache if
  unused for a set period of time.
 
+ Background caching requests for the same image are coalesced, and the results
+ are written to the texture database in batches, one transaction per batch.
+
  */
 class CTextureCache : public CJobQueue
 {
+  friend class TestTextureCache;
+
 public:
   /*!
    \brief The only way through which the global instance of the CTextureCache should be accessed.
@@ -196,19 +202,34 @@ private:
    */
   bool SetCachedTextureValid(const std::string &url, bool updateable);
 
+  /*! \brief Write the textures cached since the last flush to the database
+   All pending textures are stored in a single transaction.
+   \sa OnCachingComplete
+   */
+  void FlushCachedTextures();
+
   void OnJobComplete(unsigned int jobID, bool success, CJob *job) override;
   void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job) override;
 
   /*! \brief Called when a caching job has completed.
-   Removes the job from our processing list, updates the database
-   and fires a DDS job if appropriate.
+   Removes the job from our processing list and queues the result for the
+   database, which is flushed once a batch is full or no more jobs are queued.
    \param success whether the job was successful.
    \param job the caching job.
    */
   void OnCachingComplete(bool success, CTextureCacheJob *job);
 
+  struct PendingTexture
+  {
+    CTextureDetails details;
+    bool validate; ///< true if the texture was unchanged and only the update check is stored
+  };
+
   CCriticalSection m_databaseSection;
   CTextureDatabase m_database;
+  std::map<std::string, PendingTexture> m_pendingTextures; ///< completed textures not yet in the database, guarded by m_databaseSection
+  unsigned int m_lookups = 0; ///< database lookups, guarded by m_databaseSection
+  std::set<std::string> m_queuedlist; ///< images queued for background caching, to coalesce requests
   std::set<std::string> m_processinglist; ///< currently processing list to avoid 2 jobs being processed at once
   CCriticalSection     m_processingSection;
   CEvent               m_completeEvent; ///< Set whenever a job has finished
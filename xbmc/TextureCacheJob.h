@@ -108,9 +108,12 @@ private:
    \param width the desired maximum width.
    \param height the desired maximum height.
    \param additional_info extra info for loading, such as whether to flip horizontally.
+   \param scaleWidth the width the image is scaled to after loading, 0 if not scaled.
+   \param scaleHeight the height the image is scaled to after loading, 0 if not scaled.
    \return a pointer to a CBaseTexture object, NULL if failed.
    */
-  static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false);
+  static CBaseTexture *LoadImage(const std::string &image, unsigned int width, unsigned int height, const std::string &additional_info, bool requirePixels = false,
+                                 unsigned int scaleWidth = 0, unsigned int scaleHeight = 0);
 
   std::string    m_cachePath;
 };
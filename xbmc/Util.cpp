@@ -1381,6 +1381,26 @@ void CUtil::DeleteDirectoryCache(const std::string &prefix)
   }
 }
 
+void CUtil::PruneCacheFolder(const std::string &path, unsigned int maxFiles, int maxAgeDays)
+{
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(path, items, "", DIR_FLAG_NO_FILE_DIRS | DIR_FLAG_BYPASS_CACHE))
+    return;
+
+  items.Sort(SortByDate, SortOrderDescending);
+
+  const CDateTime oldest = CDateTime::GetCurrentDateTime() - CDateTimeSpan(maxAgeDays, 0, 0, 0);
+  unsigned int kept = 0;
+  for (const auto &item : items)
+  {
+    if (item->m_bIsFolder)
+      continue;
+    if (kept < maxFiles && item->m_dateTime.IsValid() && item->m_dateTime >= oldest)
+      kept++;
+    else
+      XFILE::CFile::Delete(item->GetPath());
+  }
+}
 
 void CUtil::GetRecursiveListing(const std::string& strPath, CFileItemList& items, const std::string& strMask, unsigned int flags /* = DIR_FLAG_DEFAULTS */)
 {
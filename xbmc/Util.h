@@ -136,6 +136,12 @@ public:
   static void DeleteDirectoryCache(const std::string &prefix = "");
   static void DeleteMusicDatabaseDirectoryCache();
   static void DeleteVideoDatabaseDirectoryCache();
+  /*! \brief Delete the oldest files of a cache folder
+   \param path the folder to prune
+   \param maxFiles the number of most recently modified files to keep
+   \param maxAgeDays delete files not modified for this many days
+   */
+  static void PruneCacheFolder(const std::string &path, unsigned int maxFiles, int maxAgeDays);
   static std::string MusicPlaylistsLocation();
   static std::string VideoPlaylistsLocation();
 
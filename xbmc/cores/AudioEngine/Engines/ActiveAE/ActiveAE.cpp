@@ -30,6 +30,11 @@ using namespace ActiveAE;
 #define MAX_WATER_LEVEL 0.2   // buffered time after stream stages in seconds
 #define MAX_BUFFER_TIME 0.1   // max time of a buffer in seconds
 
+// smaller buffers while a low latency stream is playing
+#define LOW_LATENCY_CACHE_LEVEL 0.05
+#define LOW_LATENCY_WATER_LEVEL 0.04
+#define LOW_LATENCY_BUFFER_TIME 0.01
+
 void CEngineStats::Reset(unsigned int sampleRate, bool pcm)
 {
   CSingleLock lock(m_lock);
@@ -205,14 +210,21 @@ float CEngineStats::GetCacheTime(CActiveAEStream *stream)
 
 float CEngineStats::GetCacheTotal()
 {
-  return MAX_CACHE_LEVEL;
+  return m_lowLatency ? LOW_LATENCY_CACHE_LEVEL : MAX_CACHE_LEVEL;
 }
 
 float CEngineStats::GetMaxDelay()
 {
+  if (m_lowLatency)
+    return LOW_LATENCY_CACHE_LEVEL + LOW_LATENCY_WATER_LEVEL + m_sinkCacheTotal;
   return MAX_CACHE_LEVEL + MAX_WATER_LEVEL + m_sinkCacheTotal;
 }
 
+float CEngineStats::GetMaxWaterLevel()
+{
+  return m_lowLatency ? LOW_LATENCY_WATER_LEVEL : MAX_WATER_LEVEL;
+}
+
 float CEngineStats::GetWaterLevel()
 {
   CSingleLock lock(m_lock);
@@ -269,6 +281,7 @@ CActiveAE::CActiveAE() :
   m_aeGUISoundForce = false;
   m_stats.Reset(44100, true);
   m_streamIdGen = 0;
+  m_lowLatency = false;
 
   m_settingsHandler.reset(new CActiveAESettings(*this));
 }
@@ -960,6 +973,15 @@ void CActiveAE::StateMachine(int signal, Protocol *port, Message *msg)
             m_extTimeout = 100;
             return;
           }
+          if (m_lowLatency && !m_streams.empty() && !NeedLowLatency())
+          {
+            // the last low latency stream has drained or was removed,
+            // go back to normal buffering
+            m_state = AE_TOP_RECONFIGURING;
+            m_extTimeout = 0;
+            m_extDeferData = true;
+            return;
+          }
           if (RunStages())
           {
             m_extTimeout = 0;
@@ -1132,16 +1154,23 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
 
   inputFormat = GetInputFormat(desiredFmt);
 
+  bool lowLatency = NeedLowLatency();
+
   m_sinkRequestFormat = inputFormat;
   ApplySettingsToFormat(m_sinkRequestFormat, m_settings, (int*)&m_mode);
   m_extKeepConfig = 0;
 
+  // ask the sink for short periods, 0 leaves the choice to the sink
+  if (m_sinkRequestFormat.m_dataFormat != AE_FMT_RAW)
+    m_sinkRequestFormat.m_frames = lowLatency ? LOW_LATENCY_BUFFER_TIME * m_sinkRequestFormat.m_sampleRate : 0;
+
   std::string device = (m_sinkRequestFormat.m_dataFormat == AE_FMT_RAW) ? m_settings.passthroughdevice : m_settings.device;
   std::string driver;
   CAESinkFactory::ParseDevice(device, driver);
   if ((!CompareFormat(m_sinkRequestFormat, m_sinkFormat) && !CompareFormat(m_sinkRequestFormat, oldSinkRequestFormat)) ||
       m_currDevice.compare(device) != 0 ||
-      m_settings.driver.compare(driver) != 0)
+      m_settings.driver.compare(driver) != 0 ||
+      lowLatency != m_lowLatency)
   {
     FlushEngine();
     if (!InitSink())
@@ -1156,12 +1185,18 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     {
       // limit buffer size in case of sink returns large buffer
       double buffertime = (double)m_sinkFormat.m_frames / m_sinkFormat.m_sampleRate;
-      if (buffertime > MAX_BUFFER_TIME)
+      double maxBufferTime = lowLatency ? LOW_LATENCY_BUFFER_TIME : MAX_BUFFER_TIME;
+      if (buffertime > maxBufferTime)
       {
-        CLog::Log(LOGWARNING, "ActiveAE::%s - sink returned large buffer of %d ms, reducing to %d ms", __FUNCTION__, (int)(buffertime * 1000), (int)(MAX_BUFFER_TIME*1000));
-        m_sinkFormat.m_frames = MAX_BUFFER_TIME * m_sinkFormat.m_sampleRate;
+        CLog::Log(lowLatency ? LOGDEBUG : LOGWARNING, "ActiveAE::%s - sink returned large buffer of %d ms, reducing to %d ms", __FUNCTION__, (int)(buffertime * 1000), (int)(maxBufferTime*1000));
+        m_sinkFormat.m_frames = maxBufferTime * m_sinkFormat.m_sampleRate;
       }
     }
+
+    m_lowLatency = lowLatency;
+    m_stats.SetLowLatency(lowLatency);
+    if (lowLatency)
+      CLog::Log(LOGDEBUG, "ActiveAE::%s - low latency mode", __FUNCTION__);
   }
 
   if (m_silenceBuffers)
@@ -1183,7 +1218,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
     inputFormat.m_frameSize = inputFormat.m_channelLayout.Count() *
                               (CAEUtil::DataFormatToBits(inputFormat.m_dataFormat) >> 3);
     m_silenceBuffers = new CActiveAEBufferPool(inputFormat);
-    m_silenceBuffers->Create(MAX_WATER_LEVEL*1000);
+    m_silenceBuffers->Create(m_stats.GetMaxWaterLevel()*1000);
     sinkInputFormat = inputFormat;
     m_internalFormat = inputFormat;
 
@@ -1263,7 +1298,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         if (!m_encoderBuffers)
         {
           m_encoderBuffers = new CActiveAEBufferPool(format);
-          m_encoderBuffers->Create(MAX_WATER_LEVEL*1000);
+          m_encoderBuffers->Create(m_stats.GetMaxWaterLevel()*1000);
         }
       }
 
@@ -1305,7 +1340,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
 
         // create buffer pool
         (*it)->m_inputBuffers = new CActiveAEBufferPool((*it)->m_format);
-        (*it)->m_inputBuffers->Create(MAX_CACHE_LEVEL*1000);
+        (*it)->m_inputBuffers->Create(m_stats.GetCacheTotal()*1000);
         (*it)->m_streamSpace = (*it)->m_format.m_frameSize * (*it)->m_format.m_frames;
 
         // if input format does not follow ffmpeg channel mask, we may need to remap channels
@@ -1324,7 +1359,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
         (*it)->m_processingBuffers = new CActiveAEStreamBuffers((*it)->m_inputBuffers->m_format, outputFormat, m_settings.resampleQuality);
         (*it)->m_processingBuffers->ForceResampler((*it)->m_forceResampler);
 
-        (*it)->m_processingBuffers->Create(MAX_CACHE_LEVEL*1000, false, m_settings.stereoupmix, m_settings.normalizelevels);
+        (*it)->m_processingBuffers->Create(m_stats.GetCacheTotal()*1000, false, m_settings.stereoupmix, m_settings.normalizelevels);
       }
       if (m_mode == MODE_TRANSCODE || m_streams.size() > 1)
         (*it)->m_processingBuffers->FillBuffer();
@@ -1382,7 +1417,7 @@ void CActiveAE::Configure(AEAudioFormat *desiredFmt)
   if (!m_sinkBuffers)
   {
     m_sinkBuffers = new CActiveAEBufferPoolResample(sinkInputFormat, m_sinkFormat, m_settings.resampleQuality);
-    m_sinkBuffers->Create(MAX_WATER_LEVEL*1000, true, false);
+    m_sinkBuffers->Create(m_stats.GetMaxWaterLevel()*1000, true, false);
   }
 
   // reset gui sounds
@@ -1447,6 +1482,9 @@ CActiveAEStream* CActiveAE::CreateStream(MsgStreamNew *streamMsg)
   if (streamMsg->options & AESTREAM_FORCE_RESAMPLE)
     stream->m_forceResampler = true;
 
+  if (streamMsg->options & AESTREAM_LOW_LATENCY)
+    stream->m_lowLatency = true;
+
   stream->m_pClock = streamMsg->clock;
 
   m_streams.push_back(stream);
@@ -1735,12 +1773,24 @@ bool CActiveAE::NeedReconfigureSink()
 
   if (!CompareFormat(newFormat, m_sinkFormat) ||
       m_currDevice.compare(device) != 0 ||
-      m_settings.driver.compare(driver) != 0)
+      m_settings.driver.compare(driver) != 0 ||
+      NeedLowLatency() != m_lowLatency)
     return true;
 
   return false;
 }
 
+bool CActiveAE::NeedLowLatency()
+{
+  // low latency mode as long as a stream asks for it
+  for (auto stream : m_streams)
+  {
+    if (stream->m_lowLatency && !stream->IsDrained())
+      return true;
+  }
+  return false;
+}
+
 bool CActiveAE::InitSink()
 {
   SinkConfig config;
@@ -1877,7 +1927,7 @@ bool CActiveAE::RunStages()
       float buftime = (float)(*it)->m_inputBuffers->m_format.m_frames / (*it)->m_inputBuffers->m_format.m_sampleRate;
       if ((*it)->m_inputBuffers->m_format.m_dataFormat == AE_FMT_RAW)
         buftime = (*it)->m_inputBuffers->m_format.m_streamInfo.GetDuration() / 1000;
-      while ((time < MAX_CACHE_LEVEL || (*it)->m_streamIsBuffering) && !(*it)->m_inputBuffers->m_freeSamples.empty())
+      while ((time < m_stats.GetCacheTotal() || (*it)->m_streamIsBuffering) && !(*it)->m_inputBuffers->m_freeSamples.empty())
       {
         buffer = (*it)->m_inputBuffers->GetFreeBuffer();
         (*it)->m_processingSamples.push_back(buffer);
@@ -1916,7 +1966,7 @@ bool CActiveAE::RunStages()
     }
   }
 
-  if (m_stats.GetWaterLevel() < MAX_WATER_LEVEL &&
+  if (m_stats.GetWaterLevel() < m_stats.GetMaxWaterLevel() &&
      (m_mode != MODE_TRANSCODE || (m_encoderBuffers && !m_encoderBuffers->m_freeSamples.empty())))
   {
     // calculate sync error
@@ -2044,6 +2094,8 @@ bool CActiveAE::RunStages()
               nb_loops = out->pkt->nb_samples;
             }
 
+            // volume per frame, the limiter looks at the unscaled samples
+            m_frameGains.resize(nb_loops);
             for(int i=0; i<nb_loops; i++)
             {
               if ((*it)->m_fadingSamples > 0)
@@ -2063,20 +2115,11 @@ bool CActiveAE::RunStages()
               float volume = (*it)->m_volume * (*it)->m_rgain;
               if(nb_loops > 1)
                 volume *= (*it)->m_limiter.Run((float**)out->pkt->data, out->pkt->config.channels, i*nb_floats, out->pkt->planes > 1);
-
-              for(int j=0; j<out->pkt->planes; j++)
-              {
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulArray((float*)out->pkt->data[j]+i*nb_floats, volume, nb_floats);
-#else
-                float* fbuffer = (float*) out->pkt->data[j]+i*nb_floats;
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  fbuffer[k] *= volume;
-                }
-#endif
-              }
+              m_frameGains[i] = volume;
             }
+
+            for(int j=0; j<out->pkt->planes; j++)
+              CAEUtil::MulFrames((float*)out->pkt->data[j], m_frameGains.data(), nb_floats, nb_loops);
           }
           else
           {
@@ -2111,6 +2154,8 @@ bool CActiveAE::RunStages()
               nb_loops = out->pkt->nb_samples;
             }
 
+            // volume per frame, the limiter looks at the unscaled samples
+            m_frameGains.resize(nb_loops);
             for(int i=0; i<nb_loops; i++)
             {
               if ((*it)->m_fadingSamples > 0)
@@ -2130,30 +2175,16 @@ bool CActiveAE::RunStages()
               float volume = (*it)->m_volume * (*it)->m_rgain;
               if(nb_loops > 1)
                 volume *= (*it)->m_limiter.Run((float**)mix->pkt->data, mix->pkt->config.channels, i*nb_floats, mix->pkt->planes > 1);
+              m_frameGains[i] = volume;
+            }
 
-              for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
-              {
-                float *dst = (float*)out->pkt->data[j]+i*nb_floats;
-                float *src = (float*)mix->pkt->data[j]+i*nb_floats;
-#if defined(HAVE_SSE) && defined(__SSE__)
-                CAEUtil::SSEMulAddArray(dst, src, volume, nb_floats);
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  if (fabs(dst[k]) > 1.0f)
-                  {
-                    needClamp = true;
-                    break;
-                  }
-                }
-#else
-                for (int k = 0; k < nb_floats; ++k)
-                {
-                  dst[k] += src[k] * volume;
-                  if (fabs(dst[k]) > 1.0f)
-                    needClamp = true;
-                }
-#endif
-              }
+            for(int j=0; j<out->pkt->planes && j<mix->pkt->planes; j++)
+            {
+              float *dst = (float*)out->pkt->data[j];
+              float *src = (float*)mix->pkt->data[j];
+              CAEUtil::MulAddFrames(dst, src, m_frameGains.data(), nb_floats, nb_loops);
+              if (!needClamp && CAEUtil::PeakArray(dst, nb_floats * nb_loops) > 1.0f)
+                needClamp = true;
             }
             mix->Return();
           }
@@ -2535,12 +2566,7 @@ void CActiveAE::MixSounds(CSoundPacket &dstSample)
       out = (float*)dstSample.data[j];
       sample_buffer = (float*)(it->sound->GetSound(false)->data[j]+start);
       int nb_floats = mix_samples * dstSample.config.channels / dstSample.planes;
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulAddArray(out, sample_buffer, volume, nb_floats);
-#else
-      for (int k = 0; k < nb_floats; ++k)
-        *out++ += *sample_buffer++ * volume;
-#endif
+      CAEUtil::MulAddArray(out, sample_buffer, volume, nb_floats);
     }
 
     it->samples_played += mix_samples;
@@ -2565,13 +2591,7 @@ void CActiveAE::Deamplify(CSoundPacket &dstSample)
     for(int j=0; j<dstSample.planes; j++)
     {
       float* buffer = reinterpret_cast<float*>(dstSample.data[j]);
-#if defined(HAVE_SSE) && defined(__SSE__)
-      CAEUtil::SSEMulArray(buffer, volume, nb_floats);
-#else
-      float *fbuffer = buffer;
-      for (int i = 0; i < nb_floats; i++)
-        *fbuffer++ *= volume;
-#endif
+      CAEUtil::MulArray(buffer, volume, nb_floats);
     }
   }
 }
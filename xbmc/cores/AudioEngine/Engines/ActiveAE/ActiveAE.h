@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <string>
 #include <vector>
@@ -186,10 +187,12 @@ public:
   float GetCacheTotal();
   float GetMaxDelay();
   float GetWaterLevel();
+  float GetMaxWaterLevel();
   void SetSuspended(bool state);
   void SetCurrentSinkFormat(const AEAudioFormat& SinkFormat);
   void SetSinkCacheTotal(float time) { m_sinkCacheTotal = time; }
   void SetSinkLatency(float time) { m_sinkLatency = time; }
+  void SetLowLatency(bool lowLatency) { m_lowLatency = lowLatency; }
   bool IsSuspended();
   AEAudioFormat GetCurrentSinkFormat();
 protected:
@@ -201,6 +204,7 @@ protected:
   bool m_suspended;
   AEAudioFormat m_sinkFormat;
   bool m_pcmOutput;
+  std::atomic<bool> m_lowLatency{false};
   CCriticalSection m_lock;
   struct StreamStats
   {
@@ -293,6 +297,7 @@ protected:
   void LoadSettings();
   bool NeedReconfigureBuffers();
   bool NeedReconfigureSink();
+  bool NeedLowLatency();
   void ApplySettingsToFormat(AEAudioFormat &format, AudioSettings &settings, int *mode = NULL);
   void Configure(AEAudioFormat *desiredFmt = NULL);
   AEAudioFormat GetInputFormat(AEAudioFormat *desiredFmt = NULL);
@@ -361,6 +366,8 @@ protected:
   std::list<CActiveAEStream*> m_streams;
   std::list<CActiveAEBufferPool*> m_discardBufferPools;
   unsigned int m_streamIdGen;
+  bool m_lowLatency;
+  std::vector<float> m_frameGains; // volume of each frame while mixing a stream
 
   // gui sounds
   struct SoundState
@@ -27,6 +27,7 @@ public:
     The sink does NOT have to honour anything in the format struct or the device
     if however it does not honour what is requested, it MUST update device/format
     with what it does support.
+    A non-zero format.m_frames is the period size the engine would prefer.
   */
   virtual bool Initialize  (AEAudioFormat &format, std::string &device) = 0;
 
@@ -502,6 +502,9 @@ bool CAESinkALSA::Initialize(AEAudioFormat &format, std::string &device)
   {
     m_passthrough   = false;
   }
+
+  /* a preferred period size, 0 if the engine has none */
+  inconfig.periodSize = m_passthrough ? 0 : format.m_frames;
 #if defined(HAS_LIBAMCODEC)
   if (aml_present())
   {
@@ -730,6 +733,16 @@ bool CAESinkALSA::InitializeHW(const ALSAConfig &inconfig, ALSAConfig &outconfig
   periodSize  = std::min(periodSize, (snd_pcm_uframes_t) sampleRate / 20);
   bufferSize  = std::min(bufferSize, (snd_pcm_uframes_t) sampleRate / 5);
 
+  /*
+   The engine asks for shorter periods in low latency mode, e.g. for games.
+   Keep 4 of them buffered, like above.
+  */
+  if (inconfig.periodSize > 0)
+  {
+    periodSize = std::min(periodSize, (snd_pcm_uframes_t) std::max(inconfig.periodSize, (unsigned int) AE_MIN_PERIODSIZE));
+    bufferSize = std::min(bufferSize, periodSize * 4);
+  }
+
   /*
    According to upstream we should set buffer size first - so make sure it is always at least
    4x period size to not get underruns (some systems seem to have issues with only 2 periods)
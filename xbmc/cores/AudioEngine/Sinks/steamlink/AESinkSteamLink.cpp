@@ -174,7 +174,7 @@ unsigned int CAESinkSteamLink::AddPackets(uint8_t **data, unsigned int frames, u
 
   // Create buffer and copy data
   const size_t packetSize = frameCount * m_format.m_frameSize;
-  std::unique_ptr<uint8_t[]> buffer(new uint8_t[packetSize]);
+  std::unique_ptr<uint8_t[]> buffer = m_stream->GetBuffer(packetSize);
 
   std::memcpy(buffer.get(), *data + offset * m_format.m_frameSize, packetSize);
 
@@ -23,13 +23,24 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <inttypes.h>
 
 using namespace KODI;
 using namespace STEAMLINK;
 
-#define MAX_AUDIO_DELAY_MS  100 // Skip packets if audio delay exceeds this value
+#define MAX_AUDIO_DELAY_MS  100 // Flush if audio delay exceeds the target latency by this value
 #define SL_INTRINSIC_DELAY_MS  250 // Observed audio delay while playing video
 
+#define MIN_TARGET_LATENCY_MS  20 // Audio delay to maintain when packets arrive on time
+#define MAX_TARGET_LATENCY_MS  150
+#define JITTER_HEADROOM  3.0 // Target latency above the minimum, in multiples of the arrival jitter
+#define TARGET_LATENCY_DECAY  0.01 // Rate at which the target latency falls after the jitter subsides
+#define DELAY_SMOOTHING  0.1 // Weight of each new audio delay measurement
+#define DRIFT_GAIN  0.1 // Resample ratio correction per second of delay error
+#define MAX_DRIFT_RATIO  0.005 // Max resample ratio deviation, inaudible for music
+#define MAX_POOLED_BUFFERS  16
+#define STATS_INTERVAL_MS  10000
+
 CAESinkSteamLinkStream::CAESinkSteamLinkStream(CSLAudioContext* context, unsigned int sampleRateHz, unsigned int channels, unsigned int packetSize) :
   CThread("SteamLinkAudio"),
   m_context(context),
@@ -38,8 +49,13 @@ CAESinkSteamLinkStream::CAESinkSteamLinkStream(CSLAudioContext* context, unsigne
   m_packetSize(packetSize),
   m_stream(nullptr),
   m_steamLinkBuffer(nullptr),
-  m_remainingBytes(0)
+  m_remainingBytes(0),
+  m_targetLatencySecs(MIN_TARGET_LATENCY_MS / 1000.0)
 {
+  // Room for one packet stretched by the max drift correction
+  m_resampleBuffer.reserve(static_cast<size_t>(m_packetSize * (1.0 + MAX_DRIFT_RATIO)) + m_channels * sizeof(int16_t));
+  m_freeBuffers.reserve(MAX_POOLED_BUFFERS);
+
   CServiceBroker::GetAnnouncementManager()->AddAnnouncer(this);
 }
 
@@ -63,6 +79,7 @@ bool CAESinkSteamLinkStream::Open()
   if (m_stream)
   {
     bSuccess = true;
+    m_statsTimer.Set(STATS_INTERVAL_MS);
     lock.Leave();
     Create(false);
   }
@@ -82,6 +99,7 @@ void CAESinkSteamLinkStream::Close()
 
   if (m_stream)
   {
+    AbandonPacket();
     SLAudio_FreeStream(m_stream);
     m_stream = nullptr;
   }
@@ -97,6 +115,7 @@ bool CAESinkSteamLinkStream::Flush()
     if (m_stream)
     {
       bOpen = true;
+      AbandonPacket();
       SLAudio_FreeStream(m_stream);
       m_stream = nullptr;
     }
@@ -105,9 +124,17 @@ bool CAESinkSteamLinkStream::Flush()
   // Clear queue
   {
     CSingleLock lock(m_queueMutex);
+
+    for (auto& packet : m_queue)
+      ReturnBuffer(std::move(packet.buffer));
     m_queue.clear();
+
+    // Don't count the gap as jitter
+    m_lastArrivalTimeSecs = 0.0;
   }
 
+  m_bStarted = false;
+
   // Reopen stream
   bool bSuccess = true;
   if (bOpen)
@@ -120,14 +147,37 @@ bool CAESinkSteamLinkStream::Flush()
   return bSuccess;
 }
 
+std::unique_ptr<uint8_t[]> CAESinkSteamLinkStream::GetBuffer(unsigned int size)
+{
+  // Pooled buffers hold at least one Steam Link packet
+  if (size <= m_packetSize)
+  {
+    CSingleLock lock(m_bufferMutex);
+
+    if (!m_freeBuffers.empty())
+    {
+      std::unique_ptr<uint8_t[]> buffer = std::move(m_freeBuffers.back());
+      m_freeBuffers.pop_back();
+      return buffer;
+    }
+  }
+
+  return std::unique_ptr<uint8_t[]>(new uint8_t[std::max(size, m_packetSize)]);
+}
+
 bool CAESinkSteamLinkStream::AddPacket(std::unique_ptr<uint8_t[]> data, unsigned int size, double presentTimeSecs)
 {
   {
     CSingleLock lock(m_streamMutex);
     if (m_stream == nullptr)
+    {
+      ReturnBuffer(std::move(data));
       return true; // This might have been called during a Flush()
+    }
   }
 
+  const double arrivalTimeSecs = static_cast<double>(CurrentHostCounter()) / CurrentHostFrequency();
+
   /*! @todo
   int delayMs = CSteamLinkVideo::GetDelayMs();
 
@@ -139,6 +189,7 @@ bool CAESinkSteamLinkStream::AddPacket(std::unique_ptr<uint8_t[]> data, unsigned
 
   {
     CSingleLock lock(m_queueMutex);
+    UpdateJitter(arrivalTimeSecs, presentTimeSecs);
     m_queue.emplace_back(std::move(data), size, presentTimeSecs);
   }
 
@@ -156,8 +207,9 @@ void CAESinkSteamLinkStream::Process()
   {
     if (packet.buffer || GetNextPacket(packet))
     {
-      // Sleep until we're ready to show the frame
-      WaitUntilReady(packet.presentTimeSecs);
+      // Sleep until the packet is due, ahead of its present time by the
+      // latency of the Steam Link queue
+      WaitUntilReady(packet.presentTimeSecs - GetTargetLatencySecs());
 
       if (m_bStop)
         break;
@@ -172,8 +224,13 @@ void CAESinkSteamLinkStream::Process()
   }
 
   // Make sure we haven't left a Steam Link packet open
-  if (m_steamLinkBuffer != nullptr)
-    EndPacket();
+  {
+    CSingleLock lock(m_streamMutex);
+    if (m_steamLinkBuffer != nullptr)
+      EndPacket();
+  }
+
+  LogStats();
 }
 
 void CAESinkSteamLinkStream::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
@@ -221,21 +278,6 @@ void CAESinkSteamLinkStream::WaitUntilReady(double targetTimeSecs)
     Sleep(sleepTimeMs);
 }
 
-bool CAESinkSteamLinkStream::HasLatePacket(double nextPresentTimeSecs) const
-{
-  return std::find_if(m_queue.begin(), m_queue.end(),
-    [nextPresentTimeSecs](const AudioPacket& packet)
-    {
-      return packet.presentTimeSecs >= nextPresentTimeSecs;
-    }) != m_queue.end();
-}
-
-void CAESinkSteamLinkStream::ClearLatePackets(double nextPresentTimeSecs)
-{
-  while (HasLatePacket(nextPresentTimeSecs))
-    m_queue.pop_front();
-}
-
 void CAESinkSteamLinkStream::BeginPacket()
 {
   m_steamLinkBuffer = static_cast<uint8_t*>(SLAudio_BeginFrame(m_stream));
@@ -249,40 +291,95 @@ void CAESinkSteamLinkStream::EndPacket()
   m_remainingBytes = 0;
 }
 
+void CAESinkSteamLinkStream::AbandonPacket()
+{
+  // The open frame belongs to the stream and is freed with it
+  m_steamLinkBuffer = nullptr;
+  m_remainingBytes = 0;
+}
+
 void CAESinkSteamLinkStream::SendPacket(AudioPacket packet)
 {
+  const double targetLatencySecs = GetTargetLatencySecs();
+
   CSingleLock lock(m_streamMutex);
 
   if (m_stream == nullptr)
+  {
+    ReturnBuffer(std::move(packet.buffer));
     return;
+  }
+
+  double delaySecs = GetSLDelaySecs();
+
+  if (!m_bStarted)
+  {
+    m_smoothedDelaySecs = delaySecs;
+    m_bStarted = true;
+  }
+  else if (delaySecs == 0.0)
+  {
+    // Audio dropout, the packet will be played late
+    m_underrunCount++;
+    CLog::Log(LOGDEBUG, "SteamLinkAudio: Underrun, queue ran dry with target latency %.1f ms", targetLatencySecs * 1000.0);
+  }
 
-  if (GetSLDelaySecs() > MAX_AUDIO_DELAY_MS)
+  if (delaySecs > targetLatencySecs + MAX_AUDIO_DELAY_MS / 1000.0)
   {
+    m_overrunCount++;
+    CLog::Log(LOGDEBUG, "SteamLinkAudio: Overrun, flushing %.1f ms of queued audio", delaySecs * 1000.0);
+
     // Flush() grabs the queue mutex, so don't hold the stream mutex
     CSingleExit exit(m_streamMutex);
     if (!Flush())
+    {
+      ReturnBuffer(std::move(packet.buffer));
       return;
+    }
   }
 
   if (m_stream == nullptr)
+  {
+    ReturnBuffer(std::move(packet.buffer));
     return;
+  }
+
+  // The flushed stream starts empty
+  if (!m_bStarted)
+  {
+    delaySecs = GetSLDelaySecs();
+    m_smoothedDelaySecs = delaySecs;
+    m_bStarted = true;
+  }
+
+  const uint8_t* data = packet.buffer.get();
+  unsigned int size = packet.size;
+
+  // Correct clock drift by stretching or shrinking the packet instead of
+  // letting the queue run dry or overflow
+  const unsigned int resampledSize = Resample(data, size, GetDriftRatio(delaySecs, targetLatencySecs));
+  if (resampledSize > 0)
+  {
+    data = m_resampleBuffer.data();
+    size = resampledSize;
+  }
 
   unsigned int bytesWritten = 0;
 
   // Loop until all bytes have been written
-  while (bytesWritten < packet.size)
+  while (bytesWritten < size)
   {
     if (m_steamLinkBuffer == nullptr)
       BeginPacket();
 
-    const unsigned int bytesToWrite = std::min(m_remainingBytes, packet.size - bytesWritten);
+    const unsigned int bytesToWrite = std::min(m_remainingBytes, size - bytesWritten);
 
     // Sanity check (shouldn't happen)
     if (bytesToWrite == 0 || m_remainingBytes == 0)
       break;
 
     const unsigned int bufferOffset = m_packetSize - m_remainingBytes;
-    std::memcpy(m_steamLinkBuffer + bufferOffset, packet.buffer.get() + bytesWritten, bytesToWrite);
+    std::memcpy(m_steamLinkBuffer + bufferOffset, data + bytesWritten, bytesToWrite);
 
     m_remainingBytes -= bytesToWrite;
     bytesWritten += bytesToWrite;
@@ -290,6 +387,16 @@ void CAESinkSteamLinkStream::SendPacket(AudioPacket packet)
     if (m_remainingBytes == 0)
       EndPacket();
   }
+
+  ReturnBuffer(std::move(packet.buffer));
+
+  m_packetCount++;
+
+  if (m_statsTimer.IsTimePast())
+  {
+    LogStats();
+    m_statsTimer.Set(STATS_INTERVAL_MS);
+  }
 }
 
 double CAESinkSteamLinkStream::GetSLDelaySecs()
@@ -301,3 +408,118 @@ double CAESinkSteamLinkStream::GetSLDelaySecs()
 
   return static_cast<double>(queuedFrames) / m_sampleRateHz;
 }
+
+void CAESinkSteamLinkStream::UpdateJitter(double arrivalTimeSecs, double presentTimeSecs)
+{
+  if (m_lastArrivalTimeSecs != 0.0)
+  {
+    // Interarrival jitter, estimated as in RFC 3550
+    const double deviationSecs = (arrivalTimeSecs - m_lastArrivalTimeSecs) - (presentTimeSecs - m_lastPresentTimeSecs);
+    m_jitterSecs += (std::abs(deviationSecs) - m_jitterSecs) / 16.0;
+
+    const double targetLatencySecs = std::min(MIN_TARGET_LATENCY_MS / 1000.0 + JITTER_HEADROOM * m_jitterSecs,
+                                              MAX_TARGET_LATENCY_MS / 1000.0);
+
+    // Rise quickly to absorb bursts, but fall slowly to avoid oscillating
+    if (targetLatencySecs > m_targetLatencySecs)
+      m_targetLatencySecs = targetLatencySecs;
+    else
+      m_targetLatencySecs += (targetLatencySecs - m_targetLatencySecs) * TARGET_LATENCY_DECAY;
+  }
+
+  m_lastArrivalTimeSecs = arrivalTimeSecs;
+  m_lastPresentTimeSecs = presentTimeSecs;
+}
+
+double CAESinkSteamLinkStream::GetTargetLatencySecs()
+{
+  CSingleLock lock(m_queueMutex);
+
+  return m_targetLatencySecs;
+}
+
+double CAESinkSteamLinkStream::GetDriftRatio(double delaySecs, double targetLatencySecs)
+{
+  m_smoothedDelaySecs += (delaySecs - m_smoothedDelaySecs) * DELAY_SMOOTHING;
+
+  // A queue deeper than the target is drained by playing fewer frames
+  const double errorSecs = m_smoothedDelaySecs - targetLatencySecs;
+  const double correction = std::max(-MAX_DRIFT_RATIO, std::min(errorSecs * DRIFT_GAIN, MAX_DRIFT_RATIO));
+
+  const double ratio = 1.0 - correction;
+
+  m_minDriftRatio = std::min(m_minDriftRatio, ratio);
+  m_maxDriftRatio = std::max(m_maxDriftRatio, ratio);
+
+  return ratio;
+}
+
+unsigned int CAESinkSteamLinkStream::Resample(const uint8_t* data, unsigned int size, double ratio)
+{
+  // Steam Link audio is always 16-bit interleaved
+  const unsigned int frameSize = m_channels * sizeof(int16_t);
+  const unsigned int inFrames = size / frameSize;
+  const unsigned int outFrames = static_cast<unsigned int>(std::lround(inFrames * ratio));
+
+  // Nothing to do if the correction is less than a frame
+  if (inFrames < 2 || outFrames < 2 || outFrames == inFrames)
+    return 0;
+
+  m_resampleBuffer.resize(outFrames * frameSize);
+
+  const int16_t* in = reinterpret_cast<const int16_t*>(data);
+  int16_t* out = reinterpret_cast<int16_t*>(m_resampleBuffer.data());
+
+  // Keep the first and last frames, so that consecutive packets join up
+  const double step = static_cast<double>(inFrames - 1) / (outFrames - 1);
+
+  for (unsigned int frame = 0; frame < outFrames; frame++)
+  {
+    const double position = frame * step;
+    const unsigned int index = std::min(static_cast<unsigned int>(position), inFrames - 2);
+    const double fraction = position - index;
+
+    const int16_t* in0 = in + index * m_channels;
+    const int16_t* in1 = in0 + m_channels;
+
+    for (unsigned int channel = 0; channel < m_channels; channel++)
+      *out++ = static_cast<int16_t>(std::lround(in0[channel] + (in1[channel] - in0[channel]) * fraction));
+  }
+
+  m_resampledCount++;
+
+  return outFrames * frameSize;
+}
+
+void CAESinkSteamLinkStream::LogStats()
+{
+  double jitterSecs;
+  double targetLatencySecs;
+
+  {
+    CSingleLock lock(m_queueMutex);
+    jitterSecs = m_jitterSecs;
+    targetLatencySecs = m_targetLatencySecs;
+  }
+
+  CLog::Log(LOGDEBUG, "SteamLinkAudio: %" PRIu64 " packets, jitter %.1f ms, target latency %.1f ms, "
+            "delay %.1f ms, %" PRIu64 " underruns, %" PRIu64 " overruns, "
+            "%" PRIu64 " packets resampled (ratio %.4f to %.4f)",
+            m_packetCount, jitterSecs * 1000.0, targetLatencySecs * 1000.0,
+            m_smoothedDelaySecs * 1000.0, m_underrunCount, m_overrunCount,
+            m_resampledCount, m_minDriftRatio, m_maxDriftRatio);
+
+  m_minDriftRatio = 1.0;
+  m_maxDriftRatio = 1.0;
+}
+
+void CAESinkSteamLinkStream::ReturnBuffer(std::unique_ptr<uint8_t[]> buffer)
+{
+  if (!buffer)
+    return;
+
+  CSingleLock lock(m_bufferMutex);
+
+  if (m_freeBuffers.size() < MAX_POOLED_BUFFERS)
+    m_freeBuffers.push_back(std::move(buffer));
+}
@@ -14,9 +14,11 @@
 #include "threads/SystemClock.h"
 #include "threads/Thread.h"
 
+#include <atomic>
 #include <memory>
 #include <deque>
 #include <stdint.h>
+#include <vector>
 
 struct CSLAudioContext;
 struct CSLAudioStream;
@@ -36,6 +38,17 @@ public:
   bool Open();
   void Close();
   bool Flush();
+
+  /*!
+   * \brief Get a buffer for a packet from the pool
+   *
+   * \param size The size of the packet, in bytes
+   *
+   * \return A buffer of at least the given size. Ownership is returned to
+   *         the pool when the packet is passed to AddPacket().
+   */
+  std::unique_ptr<uint8_t[]> GetBuffer(unsigned int size);
+
   bool AddPacket(std::unique_ptr<uint8_t[]> data, unsigned int size, double presentTimeSecs);
 
   // implementation of IAnnouncer
@@ -70,17 +83,22 @@ private:
 
   void WaitUntilReady(double targetTimeSecs);
 
-  bool HasLatePacket(double nextPresentTimeSecs) const;
-
-  void ClearLatePackets(double nextPresentTimeSecs);
-
   void BeginPacket();
   void EndPacket();
+  void AbandonPacket();
 
   void SendPacket(AudioPacket packet);
 
   double GetSLDelaySecs();
 
+  // Jitter buffer functions
+  void UpdateJitter(double arrivalTimeSecs, double presentTimeSecs);
+  double GetTargetLatencySecs();
+  double GetDriftRatio(double delaySecs, double targetLatencySecs);
+  unsigned int Resample(const uint8_t* data, unsigned int size, double ratio);
+  void LogStats();
+  void ReturnBuffer(std::unique_ptr<uint8_t[]> buffer);
+
   // Construction parameters
   CSLAudioContext* const m_context;
   const unsigned int m_sampleRateHz;
@@ -96,6 +114,28 @@ private:
   uint8_t* m_steamLinkBuffer;
   unsigned int m_remainingBytes; // Bytes remaining in the Steam Link audio buffer
   XbmcThreads::EndTime m_videoDelay;
+
+  // Jitter buffer parameters (arrival is protected by the queue mutex)
+  double m_lastArrivalTimeSecs = 0.0;
+  double m_lastPresentTimeSecs = 0.0;
+  double m_jitterSecs = 0.0; // Smoothed deviation of arrival times from present times
+  double m_targetLatencySecs; // Depth of the Steam Link queue to maintain
+  double m_smoothedDelaySecs = 0.0; // Only accessed by the audio thread
+  std::atomic<bool> m_bStarted{false}; // True if the Steam Link queue has been fed since the last flush
+  std::vector<uint8_t> m_resampleBuffer; // Only accessed by the audio thread
+
+  // Jitter buffer statistics
+  uint64_t m_packetCount = 0;
+  uint64_t m_underrunCount = 0;
+  uint64_t m_overrunCount = 0;
+  uint64_t m_resampledCount = 0;
+  double m_minDriftRatio = 1.0;
+  double m_maxDriftRatio = 1.0;
+  XbmcThreads::EndTime m_statsTimer;
+
+  // Packet pool
+  std::vector<std::unique_ptr<uint8_t[]>> m_freeBuffers;
+  CCriticalSection m_bufferMutex;
 };
 
 }
@@ -13,8 +13,13 @@
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 
+#include <algorithm>
 #include <cassert>
 
+#if defined(HAS_NEON) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 extern "C" {
 #include "libavutil/channel_layout.h"
 }
@@ -221,104 +226,156 @@ const char* CAEUtil::DataFormatToStr(const enum AEDataFormat dataFormat)
   return formats[dataFormat];
 }
 
+namespace
+{
+/* single source for the vector kernels, on the instruction set the build enables */
 #if defined(HAVE_SSE) && defined(__SSE__)
-void CAEUtil::SSEMulArray(float *data, const float mul, uint32_t count)
+#define AE_VECTOR
+typedef __m128 vfloat;
+const uint32_t VECTOR_SIZE = 4;
+
+inline vfloat VLoad(const float *p) { return _mm_loadu_ps(p); }
+inline void VStore(float *p, vfloat v) { _mm_storeu_ps(p, v); }
+inline vfloat VSet(float f) { return _mm_set_ps1(f); }
+inline vfloat VAdd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+inline vfloat VMul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+inline vfloat VDiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+inline vfloat VMin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+inline vfloat VMax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+inline vfloat VAbs(vfloat a) { return _mm_andnot_ps(_mm_set_ps1(-0.0f), a); }
+inline float VMaxAcross(vfloat a)
+{
+  __m128 m = _mm_max_ps(a, _mm_movehl_ps(a, a));
+  m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+  return _mm_cvtss_f32(m);
+}
+#elif defined(HAS_NEON) && defined(__ARM_NEON)
+#define AE_VECTOR
+typedef float32x4_t vfloat;
+const uint32_t VECTOR_SIZE = 4;
+
+inline vfloat VLoad(const float *p) { return vld1q_f32(p); }
+inline void VStore(float *p, vfloat v) { vst1q_f32(p, v); }
+inline vfloat VSet(float f) { return vdupq_n_f32(f); }
+inline vfloat VAdd(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+inline vfloat VMul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+inline vfloat VDiv(vfloat a, vfloat b)
 {
-  const __m128 m = _mm_set_ps1(mul);
+#if defined(__aarch64__)
+  return vdivq_f32(a, b);
+#else
+  /* no divide on ARMv7, refine the reciprocal estimate to full precision */
+  vfloat r = vrecpeq_f32(b);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  return vmulq_f32(a, r);
+#endif
+}
+inline vfloat VMin(vfloat a, vfloat b) { return vminq_f32(a, b); }
+inline vfloat VMax(vfloat a, vfloat b) { return vmaxq_f32(a, b); }
+inline vfloat VAbs(vfloat a) { return vabsq_f32(a); }
+inline float VMaxAcross(vfloat a)
+{
+#if defined(__aarch64__)
+  return vmaxvq_f32(a);
+#else
+  float32x2_t m = vpmax_f32(vget_low_f32(a), vget_high_f32(a));
+  m = vpmax_f32(m, m);
+  return vget_lane_f32(m, 0);
+#endif
+}
+#endif
 
-  /* work around invalid alignment */
-  while (((uintptr_t)data & 0xF) && count > 0)
-  {
-    data[0] *= mul;
-    ++data;
-    --count;
-  }
+inline void MulSpan(float *data, const float mul, uint32_t count)
+{
+  uint32_t i = 0;
+#ifdef AE_VECTOR
+  const vfloat m = VSet(mul);
+  for (; i + VECTOR_SIZE <= count; i += VECTOR_SIZE)
+    VStore(data + i, VMul(VLoad(data + i), m));
+#endif
+  for (; i < count; ++i)
+    data[i] *= mul;
+}
 
-  uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i+=4, data+=4)
-  {
-    __m128 to      = _mm_load_ps(data);
-    *(__m128*)data = _mm_mul_ps (to, m);
-  }
+inline void MulAddSpan(float *data, const float *add, const float mul, uint32_t count)
+{
+  uint32_t i = 0;
+#ifdef AE_VECTOR
+  const vfloat m = VSet(mul);
+  for (; i + VECTOR_SIZE <= count; i += VECTOR_SIZE)
+    VStore(data + i, VAdd(VLoad(data + i), VMul(VLoad(add + i), m)));
+#endif
+  for (; i < count; ++i)
+    data[i] += add[i] * mul;
+}
+}
 
-  if (even != count)
-  {
-    uint32_t odd = count - even;
-    if (odd == 1)
-      data[0] *= mul;
-    else
-    {
-      __m128 to;
-      if (odd == 2)
-      {
-        to = _mm_setr_ps(data[0], data[1], 0, 0);
-        __m128 ou = _mm_mul_ps(to, m);
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-      }
-      else
-      {
-        to = _mm_setr_ps(data[0], data[1], data[2], 0);
-        __m128 ou = _mm_mul_ps(to, m);
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-        data[2] = ((float*)&ou)[2];
-      }
-    }
-  }
+void CAEUtil::MulArray(float *data, const float mul, uint32_t count)
+{
+  MulSpan(data, mul, count);
 }
 
-void CAEUtil::SSEMulAddArray(float *data, float *add, const float mul, uint32_t count)
+void CAEUtil::MulAddArray(float *data, const float *add, const float mul, uint32_t count)
 {
-  const __m128 m = _mm_set_ps1(mul);
+  MulAddSpan(data, add, mul, count);
+}
 
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)add & 0xF)) && count > 0)
+void CAEUtil::MulFrames(float *data, const float *gains, uint32_t channels, uint32_t frames)
+{
+  if (channels == 1)
   {
-    data[0] += add[0] * mul;
-    ++add;
-    ++data;
-    --count;
+    /* planar data, one gain per sample */
+    uint32_t i = 0;
+#ifdef AE_VECTOR
+    for (; i + VECTOR_SIZE <= frames; i += VECTOR_SIZE)
+      VStore(data + i, VMul(VLoad(data + i), VLoad(gains + i)));
+#endif
+    for (; i < frames; ++i)
+      data[i] *= gains[i];
+    return;
   }
 
-  uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i+=4, data+=4, add+=4)
+  for (uint32_t i = 0; i < frames; ++i, data += channels)
+    MulSpan(data, gains[i], channels);
+}
+
+void CAEUtil::MulAddFrames(float *data, const float *add, const float *gains, uint32_t channels, uint32_t frames)
+{
+  if (channels == 1)
   {
-    __m128 ad      = _mm_load_ps(add );
-    __m128 to      = _mm_load_ps(data);
-    *(__m128*)data = _mm_add_ps (to, _mm_mul_ps(ad, m));
+    /* planar data, one gain per sample */
+    uint32_t i = 0;
+#ifdef AE_VECTOR
+    for (; i + VECTOR_SIZE <= frames; i += VECTOR_SIZE)
+      VStore(data + i, VAdd(VLoad(data + i), VMul(VLoad(add + i), VLoad(gains + i))));
+#endif
+    for (; i < frames; ++i)
+      data[i] += add[i] * gains[i];
+    return;
   }
 
-  if (even != count)
+  for (uint32_t i = 0; i < frames; ++i, data += channels, add += channels)
+    MulAddSpan(data, add, gains[i], channels);
+}
+
+float CAEUtil::PeakArray(const float *data, uint32_t count)
+{
+  float peak = 0.0f;
+  uint32_t i = 0;
+#ifdef AE_VECTOR
+  if (count >= VECTOR_SIZE)
   {
-    uint32_t odd = count - even;
-    if (odd == 1)
-      data[0] += add[0] * mul;
-    else
-    {
-      __m128 ad;
-      __m128 to;
-      if (odd == 2)
-      {
-        ad = _mm_setr_ps(add [0], add [1], 0, 0);
-        to = _mm_setr_ps(data[0], data[1], 0, 0);
-        __m128 ou = _mm_add_ps(to, _mm_mul_ps(ad, m));
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-      }
-      else
-      {
-        ad = _mm_setr_ps(add [0], add [1], add [2], 0);
-        to = _mm_setr_ps(data[0], data[1], data[2], 0);
-        __m128 ou = _mm_add_ps(to, _mm_mul_ps(ad, m));
-        data[0] = ((float*)&ou)[0];
-        data[1] = ((float*)&ou)[1];
-        data[2] = ((float*)&ou)[2];
-      }
-    }
+    vfloat m = VAbs(VLoad(data));
+    for (i = VECTOR_SIZE; i + VECTOR_SIZE <= count; i += VECTOR_SIZE)
+      m = VMax(m, VAbs(VLoad(data + i)));
+    peak = VMaxAcross(m);
   }
-}
 #endif
+  for (; i < count; ++i)
+    peak = std::max(peak, fabsf(data[i]));
+  return peak;
+}
 
 inline float CAEUtil::SoftClamp(const float x)
 {
@@ -357,83 +414,23 @@ inline float CAEUtil::SoftClamp(const float x)
 
 void CAEUtil::ClampArray(float *data, uint32_t count)
 {
-#if !defined(HAVE_SSE) || !defined(__SSE__)
-  for (uint32_t i = 0; i < count; ++i)
-    data[i] = SoftClamp(data[i]);
-
-#else
-  const __m128 c1 = _mm_set_ps1(27.0f);
-  const __m128 c2 = _mm_set_ps1(27.0f + 9.0f);
-
-  /* work around invalid alignment */
-  while (((uintptr_t)data & 0xF) && count > 0)
-  {
-    data[0] = SoftClamp(data[0]);
-    ++data;
-    --count;
-  }
-
-  uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i+=4, data+=4)
+  uint32_t i = 0;
+#ifdef AE_VECTOR
+  const vfloat lo  = VSet(-3.0f);
+  const vfloat hi  = VSet( 3.0f);
+  const vfloat c27 = VSet(27.0f);
+  const vfloat c9  = VSet( 9.0f);
+
+  for (; i + VECTOR_SIZE <= count; i += VECTOR_SIZE)
   {
-    /* tanh approx clamp */
-    __m128 dt = _mm_load_ps(data);
-    __m128 tmp     = _mm_mul_ps(dt, dt);
-    *(__m128*)data = _mm_div_ps(
-      _mm_mul_ps(
-        dt,
-        _mm_add_ps(c1, tmp)
-      ),
-      _mm_add_ps(c2, tmp)
-    );
-  }
-
-  if (even != count)
-  {
-    uint32_t odd = count - even;
-    if (odd == 1)
-      data[0] = SoftClamp(data[0]);
-    else
-    {
-      __m128 dt;
-      __m128 tmp;
-      __m128 out;
-      if (odd == 2)
-      {
-        /* tanh approx clamp */
-        dt  = _mm_setr_ps(data[0], data[1], 0, 0);
-        tmp = _mm_mul_ps(dt, dt);
-        out = _mm_div_ps(
-          _mm_mul_ps(
-            dt,
-            _mm_add_ps(c1, tmp)
-          ),
-          _mm_add_ps(c2, tmp)
-        );
-
-        data[0] = ((float*)&out)[0];
-        data[1] = ((float*)&out)[1];
-      }
-      else
-      {
-        /* tanh approx clamp */
-        dt  = _mm_setr_ps(data[0], data[1], data[2], 0);
-        tmp = _mm_mul_ps(dt, dt);
-        out = _mm_div_ps(
-          _mm_mul_ps(
-            dt,
-            _mm_add_ps(c1, tmp)
-          ),
-          _mm_add_ps(c2, tmp)
-        );
-
-        data[0] = ((float*)&out)[0];
-        data[1] = ((float*)&out)[1];
-        data[2] = ((float*)&out)[2];
-      }
-    }
+    /* same tanh approx as SoftClamp, which reaches +-1 at +-3 */
+    const vfloat x = VMin(VMax(VLoad(data + i), lo), hi);
+    const vfloat y = VMul(x, x);
+    VStore(data + i, VDiv(VMul(x, VAdd(c27, y)), VAdd(c27, VMul(c9, y))));
   }
 #endif
+  for (; i < count; ++i)
+    data[i] = SoftClamp(data[i]);
 }
 
 bool CAEUtil::S16NeedsByteSwap(AEDataFormat in, AEDataFormat out)
@@ -180,10 +180,28 @@ public:
     return 20*log10(scale);
   }
 
-  #if defined(HAVE_SSE) && defined(__SSE__)
-  static void SSEMulArray     (float *data, const float mul, uint32_t count);
-  static void SSEMulAddArray  (float *data, float *add, const float mul, uint32_t count);
-  #endif
+  /*! \brief Sample processing kernels
+   These use SSE or NEON when the build enables them, with a plain C
+   fallback. The data doesn't need to be aligned.
+   */
+  static void MulArray   (float *data, const float mul, uint32_t count);
+  static void MulAddArray(float *data, const float *add, const float mul, uint32_t count);
+
+  /*! \brief Apply a gain to each frame of samples
+   \param data the samples, channels * frames of them
+   \param gains the gain of each frame
+   \param channels the number of samples in a frame
+   \param frames the number of frames
+   */
+  static void MulFrames   (float *data, const float *gains, uint32_t channels, uint32_t frames);
+  static void MulAddFrames(float *data, const float *add, const float *gains, uint32_t channels, uint32_t frames);
+
+  /*! \brief Get the largest absolute value of the samples
+   */
+  static float PeakArray(const float *data, uint32_t count);
+
+  /*! \brief Soft clip the samples to -1.0 .. 1.0
+   */
   static void ClampArray(float *data, uint32_t count);
 
   static bool S16NeedsByteSwap(AEDataFormat in, AEDataFormat out);
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/AudioEngine/Utils/AEUtil.h"
+#include "test/BenchmarkUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // Odd sizes, so both the vector loops and the tails are used
+  constexpr uint32_t COUNT = 1027;
+
+  std::vector<float> GetSamples(uint32_t count, float scale)
+  {
+    std::vector<float> samples(count);
+    for (uint32_t i = 0; i < count; i++)
+      samples[i] = scale * std::sin(i * 0.37f);
+    return samples;
+  }
+}
+
+TEST(TestAEUtil, MulArray)
+{
+  std::vector<float> data = GetSamples(COUNT, 1.0f);
+  const std::vector<float> ref = data;
+
+  // Start off the alignment of the buffer
+  CAEUtil::MulArray(data.data() + 1, 0.5f, COUNT - 1);
+
+  EXPECT_EQ(data[0], ref[0]);
+  for (uint32_t i = 1; i < COUNT; i++)
+    EXPECT_FLOAT_EQ(data[i], ref[i] * 0.5f);
+}
+
+TEST(TestAEUtil, MulAddArray)
+{
+  std::vector<float> data = GetSamples(COUNT, 1.0f);
+  const std::vector<float> add = GetSamples(COUNT, 0.3f);
+  const std::vector<float> ref = data;
+
+  CAEUtil::MulAddArray(data.data(), add.data(), 0.5f, COUNT);
+
+  for (uint32_t i = 0; i < COUNT; i++)
+    EXPECT_FLOAT_EQ(data[i], ref[i] + add[i] * 0.5f);
+}
+
+TEST(TestAEUtil, MulFrames)
+{
+  for (uint32_t channels : {1u, 2u, 6u, 8u, 11u})
+  {
+    const uint32_t frames = COUNT / channels;
+    std::vector<float> data = GetSamples(frames * channels, 1.0f);
+    std::vector<float> add = GetSamples(frames * channels, 0.3f);
+    const std::vector<float> gains = GetSamples(frames, 0.8f);
+    const std::vector<float> ref = data;
+
+    CAEUtil::MulFrames(data.data(), gains.data(), channels, frames);
+    for (uint32_t i = 0; i < frames * channels; i++)
+      EXPECT_FLOAT_EQ(data[i], ref[i] * gains[i / channels]) << "channels " << channels;
+
+    data = ref;
+    CAEUtil::MulAddFrames(data.data(), add.data(), gains.data(), channels, frames);
+    for (uint32_t i = 0; i < frames * channels; i++)
+      EXPECT_FLOAT_EQ(data[i], ref[i] + add[i] * gains[i / channels]) << "channels " << channels;
+  }
+}
+
+TEST(TestAEUtil, PeakArray)
+{
+  std::vector<float> data = GetSamples(COUNT, 0.5f);
+  EXPECT_LE(CAEUtil::PeakArray(data.data(), COUNT), 0.5f);
+
+  // In the tail and in the vector part
+  data[COUNT - 1] = -1.5f;
+  EXPECT_EQ(CAEUtil::PeakArray(data.data(), COUNT), 1.5f);
+  data[10] = 2.0f;
+  EXPECT_EQ(CAEUtil::PeakArray(data.data(), COUNT), 2.0f);
+
+  EXPECT_EQ(CAEUtil::PeakArray(data.data(), 0), 0.0f);
+}
+
+TEST(TestAEUtil, ClampArray)
+{
+  std::vector<float> data = GetSamples(COUNT, 4.0f);
+  const std::vector<float> ref = data;
+
+  CAEUtil::ClampArray(data.data(), COUNT);
+
+  for (uint32_t i = 0; i < COUNT; i++)
+  {
+    EXPECT_LE(std::fabs(data[i]), 1.0f + 1e-6f);
+
+    // Same curve as the scalar clipper
+    const float x = std::max(-3.0f, std::min(3.0f, ref[i]));
+    const float y = x * x;
+    EXPECT_NEAR(data[i], x * (27.0f + y) / (27.0f + 9.0f * y), 1e-6f);
+  }
+}
+
+// Not a check, reports the cost of the mixing kernels against plain loops on
+// the target hardware. Run with --gtest_also_run_disabled_tests.
+TEST(TestAEUtil, DISABLED_KernelCost)
+{
+  // One second of 7.1 at 48 kHz, in periods of 1024 frames
+  constexpr uint32_t CHANNELS = 8;
+  constexpr uint32_t FRAMES = 1024;
+  constexpr uint32_t PERIODS = 48000 / FRAMES;
+  const std::string unit = "us per second of 7.1";
+
+  std::vector<float> data = GetSamples(FRAMES * CHANNELS, 1.0f);
+  const std::vector<float> add = GetSamples(FRAMES * CHANNELS, 0.3f);
+  const std::vector<float> gains = GetSamples(FRAMES, 0.8f);
+  float peak = 0.0f;
+
+  double us = CBenchmarkUtils::MeanUs(PERIODS, [&]()
+  {
+    CAEUtil::MulAddFrames(data.data(), add.data(), gains.data(), CHANNELS, FRAMES);
+  });
+  CBenchmarkUtils::Report("MulAddFrames", us * PERIODS, unit);
+
+  us = CBenchmarkUtils::MeanUs(PERIODS, [&]()
+  {
+    for (uint32_t j = 0; j < FRAMES * CHANNELS; j++)
+      data[j] += add[j] * gains[j / CHANNELS];
+  });
+  CBenchmarkUtils::Report("MulAddFrames (plain loop)", us * PERIODS, unit);
+
+  us = CBenchmarkUtils::MeanUs(PERIODS, [&]()
+  {
+    peak = std::max(peak, CAEUtil::PeakArray(data.data(), FRAMES * CHANNELS));
+  });
+  CBenchmarkUtils::Report("PeakArray", us * PERIODS, unit);
+
+  us = CBenchmarkUtils::MeanUs(PERIODS, [&]()
+  {
+    CAEUtil::ClampArray(data.data(), FRAMES * CHANNELS);
+  });
+  CBenchmarkUtils::Report("ClampArray", us * PERIODS, unit);
+
+  us = CBenchmarkUtils::MeanUs(PERIODS, [&]()
+  {
+    for (uint32_t j = 0; j < FRAMES * CHANNELS; j++)
+    {
+      const float x = std::max(-3.0f, std::min(3.0f, data[j]));
+      data[j] = x * (27.0f + x * x) / (27.0f + 9.0f * x * x);
+    }
+  });
+  CBenchmarkUtils::Report("ClampArray (plain loop)", us * PERIODS, unit);
+
+  // Keep the results alive
+  EXPECT_GE(peak, 0.0f);
+}
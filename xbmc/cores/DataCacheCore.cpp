@@ -33,6 +33,7 @@ void CDataCacheCore::Reset()
   m_stateInfo.m_stateSeeking = false;
   m_stateInfo.m_renderGuiLayer = false;
   m_stateInfo.m_renderVideoLayer = false;
+  m_stateInfo.m_timeToFirstFrame = 0;
   m_playerStateChanged = false;
 }
 
@@ -173,6 +174,20 @@ float CDataCacheCore::GetVideoDAR()
   return m_playerVideoInfo.dar;
 }
 
+void CDataCacheCore::SetVideoLatency(const VideoLatencyInfo &latency)
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  m_videoLatency = latency;
+}
+
+VideoLatencyInfo CDataCacheCore::GetVideoLatency()
+{
+  CSingleLock lock(m_videoPlayerSection);
+
+  return m_videoLatency;
+}
+
 // player audio info
 void CDataCacheCore::SetAudioDecoderName(std::string name)
 {
@@ -378,6 +393,18 @@ int64_t CDataCacheCore::GetMaxTime()
   return m_timeInfo.m_timeMax;
 }
 
+void CDataCacheCore::SetTimeToFirstFrame(unsigned int ms)
+{
+  CSingleLock lock(m_stateSection);
+  m_stateInfo.m_timeToFirstFrame = ms;
+}
+
+unsigned int CDataCacheCore::GetTimeToFirstFrame()
+{
+  CSingleLock lock(m_stateSection);
+  return m_stateInfo.m_timeToFirstFrame;
+}
+
 float CDataCacheCore::GetPlayPercentage()
 {
   CSingleLock lock(m_stateSection);
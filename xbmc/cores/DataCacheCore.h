@@ -12,6 +12,30 @@
 #include <string>
 #include "threads/CriticalSection.h"
 
+/*!
+ * \brief Percentiles of a latency distribution, in milliseconds
+ */
+struct LatencyPercentiles
+{
+  double p50Ms = 0.0;
+  double p95Ms = 0.0;
+  double p99Ms = 0.0;
+  double maxMs = 0.0;
+};
+
+/*!
+ * \brief Latency of the video decoder path, for decoders that measure it
+ */
+struct VideoLatencyInfo
+{
+  unsigned int sampleCount = 0;
+  LatencyPercentiles demuxToDecoder; // Packet read from the demuxer until it was submitted to the decoder
+  LatencyPercentiles decoderWrite; // Time spent writing a packet to the decoder
+  LatencyPercentiles decoderQueue; // Video queued in the decoder after a packet was submitted
+  unsigned int starvedBuffers = 0; // Packets that found no free video buffer
+  unsigned int decoderDelayMs = 0; // Delay last reported by the decoder
+};
+
 class CDataCacheCore
 {
 public:
@@ -40,6 +64,8 @@ public:
   float GetVideoFps();
   void SetVideoDAR(float dar);
   float GetVideoDAR();
+  void SetVideoLatency(const VideoLatencyInfo &latency);
+  VideoLatencyInfo GetVideoLatency();
 
   // player audio info
   void SetAudioDecoderName(std::string name);
@@ -112,6 +138,20 @@ public:
    */
   int64_t GetMaxTime();
 
+  /*!
+   * \brief Set the time it took to show the first video frame
+   */
+  void SetTimeToFirstFrame(unsigned int ms);
+
+  /*!
+   * \brief Get the time, in ms, from opening the file until the first video
+   * frame was shown
+   *
+   * This is measured until the player finished buffering and started the
+   * clock, and is zero until then, or for files without video.
+   */
+  unsigned int GetTimeToFirstFrame();
+
 protected:
   std::atomic_bool m_hasAVInfoChanges;
 
@@ -128,6 +168,7 @@ protected:
     float fps;
     float dar;
   } m_playerVideoInfo;
+  VideoLatencyInfo m_videoLatency;
 
   CCriticalSection m_audioPlayerSection;
   struct SPlayerAudioInfo
@@ -154,6 +195,7 @@ protected:
     float m_tempo;
     float m_speed;
     bool m_frameAdvance;
+    unsigned int m_timeToFirstFrame;
   } m_stateInfo;
 
   struct STimeInfo
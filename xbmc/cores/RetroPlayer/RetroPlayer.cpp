@@ -208,15 +208,34 @@ bool CRetroPlayer::CloseFile(bool reopen /* = false */)
 
   if (m_gameClient && m_gameServices.GameSettings().AutosaveEnabled())
   {
+    // The savestate is written when the playback is destroyed below, which
+    // reports a failure to write it
     std::string savePath = m_playback->CreateSavestate();
     if (!savePath.empty())
-      CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Saved state to %s", CURL::GetRedacted(savePath).c_str());
+      CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Saving state to %s", CURL::GetRedacted(savePath).c_str());
     else
       CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Failed to save state at close");
   }
 
   m_playback.reset();
 
+  if (m_processInfo)
+  {
+    const FrameTimingStats frameTiming = m_processInfo->GetFrameTiming();
+    if (frameTiming.frameIntervalMs.SampleCount() > 0)
+    {
+      CLog::Log(LOGDEBUG, "RetroPlayer[PLAYBACK]: Frame interval %.3f ms mean, %.3f ms min, %.3f ms max, %.2f ms 99th percentile",
+        frameTiming.frameIntervalMs.MeanMs(),
+        frameTiming.frameIntervalMs.MinMs(),
+        frameTiming.frameIntervalMs.MaxMs(),
+        frameTiming.frameIntervalMs.PercentileMs(0.99));
+      CLog::Log(LOGDEBUG, "RetroPlayer[PLAYBACK]: Frame drift %.3f ms mean, %.2f ms 99th percentile, %llu missed deadlines",
+        frameTiming.driftMs.MeanMs(),
+        frameTiming.driftMs.PercentileMs(0.99),
+        static_cast<unsigned long long>(frameTiming.droppedDeadlines));
+    }
+  }
+
   if (m_gameClient)
     m_gameClient->CloseFile();
 
@@ -550,7 +569,7 @@ void CRetroPlayer::CreatePlayback(bool bRestoreState)
   if (m_gameClient->RequiresGameLoop())
   {
     m_playback->Deinitialize();
-    m_playback.reset(new CReversiblePlayback(m_gameClient.get(), m_gameClient->GetFrameRate(), m_gameClient->GetSerializeSize()));
+    m_playback.reset(new CReversiblePlayback(m_gameClient.get(), *m_processInfo, *m_streamManager, m_gameClient->GetFrameRate(), m_gameClient->GetSerializeSize()));
   }
   else
     ResetPlayback();
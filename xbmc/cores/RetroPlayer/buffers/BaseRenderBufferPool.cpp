@@ -10,11 +10,27 @@
 #include "IRenderBuffer.h"
 #include "cores/RetroPlayer/rendering/VideoRenderers/RPBaseRenderer.h"
 #include "threads/SingleLock.h"
+#include "utils/TimeUtils.h"
 #include "utils/log.h"
 
+#include <algorithm>
+#include <inttypes.h>
+
 using namespace KODI;
 using namespace RETRO;
 
+namespace
+{
+  // Max number of free buffers in the queue. Pools normally hold a handful
+  // of buffers, buffers returned to a full queue are kept until Flush().
+  constexpr size_t FREE_BUFFER_CAPACITY = 16;
+}
+
+CBaseRenderBufferPool::CBaseRenderBufferPool() :
+  m_free(FREE_BUFFER_CAPACITY)
+{
+}
+
 CBaseRenderBufferPool::~CBaseRenderBufferPool()
 {
   Flush();
@@ -62,32 +78,22 @@ IRenderBuffer *CBaseRenderBufferPool::GetBuffer(unsigned int width, unsigned int
   if (!m_bConfigured)
     return nullptr;
 
+  const int64_t startTime = CurrentHostCounter();
+  bool bAllocated = false;
+
   IRenderBuffer *renderBuffer = nullptr;
 
   void *header = nullptr;
 
   if (GetHeaderWithTimeout(header))
   {
-    CSingleLock lock(m_bufferMutex);
+    renderBuffer = GetFreeBuffer(width, height);
 
-    for (auto it = m_free.begin(); it != m_free.end(); ++it)
+    if (renderBuffer != nullptr)
     {
-      std::unique_ptr<IRenderBuffer> &buffer = *it;
-
-      // Only return buffers of the same dimensions
-      const unsigned int bufferWidth = buffer->GetWidth();
-      const unsigned int bufferHeight = buffer->GetHeight();
-
-      if (bufferWidth == width && bufferHeight == height)
-      {
-        renderBuffer = buffer.release();
-        renderBuffer->SetHeader(header);
-        m_free.erase(it);
-        break;
-      }
+      renderBuffer->SetHeader(header);
     }
-
-    if (renderBuffer == nullptr)
+    else
     {
       CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Creating render buffer of size %ux%u for buffer pool",
                 width,
@@ -98,6 +104,8 @@ IRenderBuffer *CBaseRenderBufferPool::GetBuffer(unsigned int width, unsigned int
         renderBuffer = renderBufferPtr.release();
       else
         CLog::Log(LOGERROR, "RetroPlayer[RENDER]: Failed to allocate render buffer");
+
+      bAllocated = true;
     }
 
     if (renderBuffer != nullptr)
@@ -107,24 +115,33 @@ IRenderBuffer *CBaseRenderBufferPool::GetBuffer(unsigned int width, unsigned int
     }
   }
 
+  // Update statistics
+  const int64_t acquireTime = CurrentHostCounter() - startTime;
+
+  m_acquireCount++;
+  if (bAllocated)
+    m_allocationCount++;
+  m_acquireTimeTotal += acquireTime;
+
+  int64_t maxTime = m_acquireTimeMax.load();
+  while (acquireTime > maxTime && !m_acquireTimeMax.compare_exchange_weak(maxTime, acquireTime))
+  {
+  }
+
   return renderBuffer;
 }
 
 void CBaseRenderBufferPool::Return(IRenderBuffer *buffer)
 {
-  CSingleLock lock(m_bufferMutex);
-
   buffer->SetLoaded(false);
   buffer->SetRendered(false);
 
-  std::unique_ptr<IRenderBuffer> bufferPtr(buffer);
-  m_free.emplace_back(std::move(bufferPtr));
+  if (!m_free.Push(buffer))
+    KeepBuffer(buffer);
 }
 
 void CBaseRenderBufferPool::Prime(unsigned int width, unsigned int height)
 {
-  CSingleLock lock(m_bufferMutex);
-
   // Allocate two buffers for double buffering
   unsigned int bufferCount = 2;
 
@@ -146,8 +163,91 @@ void CBaseRenderBufferPool::Prime(unsigned int width, unsigned int height)
 
 void CBaseRenderBufferPool::Flush()
 {
-  CSingleLock lock(m_bufferMutex);
+  while (IRenderBuffer *buffer = m_free.Pop())
+    delete buffer;
+
+  {
+    CSingleLock lock(m_overflowMutex);
+    for (IRenderBuffer *buffer : m_overflow)
+      delete buffer;
+    m_overflow.clear();
+  }
 
-  m_free.clear();
   m_bConfigured = false;
+
+  LogStats();
+  ResetStats();
+}
+
+RenderBufferPoolStats CBaseRenderBufferPool::GetStats() const
+{
+  RenderBufferPoolStats stats;
+
+  const double ticksPerUs = static_cast<double>(CurrentHostFrequency()) / 1000000.0;
+
+  stats.acquireCount = m_acquireCount;
+  stats.allocationCount = m_allocationCount;
+  if (stats.acquireCount > 0)
+    stats.meanAcquireUs = m_acquireTimeTotal / ticksPerUs / stats.acquireCount;
+  stats.maxAcquireUs = m_acquireTimeMax / ticksPerUs;
+
+  return stats;
+}
+
+void CBaseRenderBufferPool::ResetStats()
+{
+  m_acquireCount = 0;
+  m_allocationCount = 0;
+  m_acquireTimeTotal = 0;
+  m_acquireTimeMax = 0;
+}
+
+IRenderBuffer *CBaseRenderBufferPool::GetFreeBuffer(unsigned int width, unsigned int height)
+{
+  IRenderBuffer *renderBuffer = nullptr;
+
+  // Visit each free buffer at most once. Buffers of other dimensions are
+  // pushed back instead of destroyed, because they might have to be
+  // destroyed on the rendering thread.
+  for (size_t i = 0; i < m_free.Capacity(); i++)
+  {
+    IRenderBuffer *buffer = m_free.Pop();
+    if (buffer == nullptr)
+      break;
+
+    // Only return buffers of the same dimensions
+    if (buffer->GetWidth() == width && buffer->GetHeight() == height)
+    {
+      renderBuffer = buffer;
+      break;
+    }
+
+    if (!m_free.Push(buffer))
+      KeepBuffer(buffer);
+  }
+
+  return renderBuffer;
+}
+
+void CBaseRenderBufferPool::KeepBuffer(IRenderBuffer *buffer)
+{
+  CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Buffer pool is full, keeping render buffer until flush");
+
+  CSingleLock lock(m_overflowMutex);
+  m_overflow.push_back(buffer);
+}
+
+void CBaseRenderBufferPool::LogStats() const
+{
+  const RenderBufferPoolStats stats = GetStats();
+
+  if (stats.acquireCount > 0)
+  {
+    CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Buffer pool acquired %" PRIu64 " buffers (%" PRIu64 " allocated), "
+              "mean %.1f us, max %.1f us",
+              stats.acquireCount,
+              stats.allocationCount,
+              stats.meanAcquireUs,
+              stats.maxAcquireUs);
+  }
 }
@@ -9,20 +9,40 @@
 #pragma once
 
 #include "IRenderBufferPool.h"
+#include "RenderBufferQueue.h"
 #include "threads/CriticalSection.h"
 
-#include <deque>
+#include <atomic>
 #include <memory>
+#include <stdint.h>
 #include <vector>
 
 namespace KODI
 {
 namespace RETRO
 {
+  /*!
+   * \brief Statistics for the time taken by GetBuffer()
+   */
+  struct RenderBufferPoolStats
+  {
+    uint64_t acquireCount = 0;
+    uint64_t allocationCount = 0; // Acquires that had to allocate a buffer
+    double meanAcquireUs = 0.0;
+    double maxAcquireUs = 0.0;
+  };
+
+  /*!
+   * \brief Base class for render buffer pools
+   *
+   * Free buffers are kept in a lock-free queue, so that the game thread
+   * acquiring a buffer never waits on the rendering thread returning one,
+   * and vice versa. New buffers are allocated without holding a lock.
+   */
   class CBaseRenderBufferPool : public IRenderBufferPool
   {
   public:
-    CBaseRenderBufferPool() = default;
+    CBaseRenderBufferPool();
     ~CBaseRenderBufferPool() override;
 
     // Partial implementation of IRenderBufferPool
@@ -39,6 +59,16 @@ namespace RETRO
     // Buffer properties
     AVPixelFormat Format() const { return m_format; }
 
+    /*!
+     * \brief Get statistics for the time taken to acquire buffers
+     */
+    RenderBufferPoolStats GetStats() const;
+
+    /*!
+     * \brief Reset the acquire statistics
+     */
+    void ResetStats();
+
   protected:
     virtual IRenderBuffer *CreateRenderBuffer(void *header = nullptr) = 0;
     virtual bool ConfigureInternal() { return true; }
@@ -51,16 +81,42 @@ namespace RETRO
     virtual bool SendBuffer(IRenderBuffer *buffer) { return false; }
 
     // Configuration parameters
-    bool m_bConfigured = false;
+    std::atomic<bool> m_bConfigured{false};
     AVPixelFormat m_format = AV_PIX_FMT_NONE;
 
   private:
+    /*!
+     * \brief Take a free buffer of the given dimensions from the queue
+     *
+     * Free buffers of other dimensions are kept for later.
+     *
+     * \return The buffer, or nullptr if no free buffer has the dimensions
+     */
+    IRenderBuffer *GetFreeBuffer(unsigned int width, unsigned int height);
+
+    /*!
+     * \brief Keep a free buffer that doesn't fit in the queue
+     *
+     * Buffers are only destroyed by Flush(), which runs on the rendering
+     * thread, as they might hold resources of the rendering context.
+     */
+    void KeepBuffer(IRenderBuffer *buffer);
+
+    void LogStats() const;
+
     // Buffer properties
-    std::deque<std::unique_ptr<IRenderBuffer>> m_free;
+    CRenderBufferQueue m_free;
+    std::vector<IRenderBuffer*> m_overflow;
+    CCriticalSection m_overflowMutex;
+
+    // Acquire statistics, in host counter ticks
+    std::atomic<uint64_t> m_acquireCount{0};
+    std::atomic<uint64_t> m_allocationCount{0};
+    std::atomic<int64_t> m_acquireTimeTotal{0};
+    std::atomic<int64_t> m_acquireTimeMax{0};
 
     std::vector<CRPBaseRenderer*> m_renderers;
     mutable CCriticalSection m_rendererMutex;
-    CCriticalSection m_bufferMutex;
   };
 }
 }
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "RenderBufferQueue.h"
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  size_t RoundUpToPowerOfTwo(size_t value)
+  {
+    size_t result = 2;
+    while (result < value)
+      result <<= 1;
+    return result;
+  }
+}
+
+CRenderBufferQueue::CRenderBufferQueue(size_t capacity) :
+  m_mask(RoundUpToPowerOfTwo(capacity) - 1),
+  m_slots(new Slot[m_mask + 1]),
+  m_pushPosition(0),
+  m_popPosition(0)
+{
+  // A slot is ready for a push when its sequence equals the push position
+  for (size_t i = 0; i <= m_mask; i++)
+  {
+    m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    m_slots[i].buffer = nullptr;
+  }
+}
+
+bool CRenderBufferQueue::Push(IRenderBuffer *buffer)
+{
+  Slot *slot;
+
+  size_t position = m_pushPosition.load(std::memory_order_relaxed);
+  while (true)
+  {
+    slot = &m_slots[position & m_mask];
+
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position);
+
+    if (difference == 0)
+    {
+      // Slot is free, claim it
+      if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (difference < 0)
+    {
+      // Slot still holds a buffer from the previous lap, queue is full
+      return false;
+    }
+    else
+    {
+      // Another producer claimed the slot
+      position = m_pushPosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->buffer = buffer;
+
+  // Publish the buffer to consumers
+  slot->sequence.store(position + 1, std::memory_order_release);
+
+  return true;
+}
+
+IRenderBuffer *CRenderBufferQueue::Pop()
+{
+  Slot *slot;
+
+  size_t position = m_popPosition.load(std::memory_order_relaxed);
+  while (true)
+  {
+    slot = &m_slots[position & m_mask];
+
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t difference = static_cast<ptrdiff_t>(sequence) - static_cast<ptrdiff_t>(position + 1);
+
+    if (difference == 0)
+    {
+      // Slot holds a buffer, claim it
+      if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (difference < 0)
+    {
+      // Slot hasn't been published yet, queue is empty
+      return nullptr;
+    }
+    else
+    {
+      // Another consumer claimed the slot
+      position = m_popPosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  IRenderBuffer *buffer = slot->buffer;
+
+  // Free the slot for the producer's next lap
+  slot->sequence.store(position + m_mask + 1, std::memory_order_release);
+
+  return buffer;
+}
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+
+namespace KODI
+{
+namespace RETRO
+{
+  class IRenderBuffer;
+
+  /*!
+   * \brief Bounded lock-free queue of render buffers
+   *
+   * Any number of threads may push and pop concurrently. Neither operation
+   * blocks: a push fails if the queue is full, and a pop fails if the queue
+   * is empty.
+   *
+   * Each slot carries a sequence number that tells producers and consumers
+   * whether the slot is ready for them, so threads only contend on the
+   * position counters, and only for a single compare-and-swap.
+   */
+  class CRenderBufferQueue
+  {
+  public:
+    /*!
+     * \brief Create a queue
+     *
+     * \param capacity The max number of buffers, rounded up to a power of two
+     */
+    explicit CRenderBufferQueue(size_t capacity);
+
+    ~CRenderBufferQueue() = default;
+
+    /*!
+     * \brief Add a buffer to the queue
+     *
+     * \return True if the buffer was added, false if the queue is full
+     */
+    bool Push(IRenderBuffer *buffer);
+
+    /*!
+     * \brief Remove the oldest buffer from the queue
+     *
+     * \return The buffer, or nullptr if the queue is empty
+     */
+    IRenderBuffer *Pop();
+
+    /*!
+     * \brief Get the max number of buffers
+     */
+    size_t Capacity() const { return m_mask + 1; }
+
+  private:
+    struct Slot
+    {
+      std::atomic<size_t> sequence;
+      IRenderBuffer *buffer;
+    };
+
+    // Keep the positions on separate cache lines to avoid false sharing
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Construction parameters
+    const size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // Queue positions
+    char m_pad0[CACHE_LINE_SIZE];
+    std::atomic<size_t> m_pushPosition;
+    char m_pad1[CACHE_LINE_SIZE];
+    std::atomic<size_t> m_popPosition;
+    char m_pad2[CACHE_LINE_SIZE];
+  };
+}
+}
@@ -0,0 +1,256 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/buffers/BaseRenderBuffer.h"
+#include "cores/RetroPlayer/buffers/BaseRenderBufferPool.h"
+#include "cores/RetroPlayer/buffers/RenderBufferQueue.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  std::atomic<int> g_liveBuffers(0);
+
+  class CTestRenderBuffer : public CBaseRenderBuffer
+  {
+  public:
+    CTestRenderBuffer() { g_liveBuffers++; }
+    ~CTestRenderBuffer() override { g_liveBuffers--; }
+
+    // implementation of IRenderBuffer via CBaseRenderBuffer
+    bool Allocate(AVPixelFormat format, unsigned int width, unsigned int height) override
+    {
+      m_format = format;
+      m_width = width;
+      m_height = height;
+      return true;
+    }
+    size_t GetFrameSize() const override { return 0; }
+    uint8_t *GetMemory() override { return nullptr; }
+    bool UploadTexture() override { return true; }
+  };
+
+  class CTestRenderBufferPool : public CBaseRenderBufferPool
+  {
+  public:
+    // implementation of IRenderBufferPool via CBaseRenderBufferPool
+    bool IsCompatible(const CRenderVideoSettings &renderSettings) const override { return true; }
+
+  protected:
+    // implementation of CBaseRenderBufferPool
+    IRenderBuffer *CreateRenderBuffer(void *header = nullptr) override { return new CTestRenderBuffer; }
+  };
+
+  IRenderBuffer *ToBuffer(uintptr_t value)
+  {
+    return reinterpret_cast<IRenderBuffer*>(value);
+  }
+}
+
+TEST(TestRenderBufferPool, QueueOrder)
+{
+  CRenderBufferQueue queue(3);
+
+  ASSERT_EQ(queue.Capacity(), 4u);
+
+  for (uintptr_t i = 1; i <= 4; i++)
+    EXPECT_TRUE(queue.Push(ToBuffer(i)));
+  EXPECT_FALSE(queue.Push(ToBuffer(5)));
+
+  for (uintptr_t i = 1; i <= 4; i++)
+    EXPECT_EQ(queue.Pop(), ToBuffer(i));
+  EXPECT_EQ(queue.Pop(), nullptr);
+}
+
+TEST(TestRenderBufferPool, QueueStress)
+{
+  constexpr unsigned int THREAD_COUNT = 4;
+  constexpr uintptr_t ITEMS_PER_PRODUCER = 100000;
+
+  CRenderBufferQueue queue(8);
+
+  std::vector<std::atomic<int>> seen(THREAD_COUNT * ITEMS_PER_PRODUCER);
+  for (auto &count : seen)
+    count = 0;
+
+  std::atomic<uintptr_t> popped(0);
+  std::vector<std::thread> threads;
+
+  for (unsigned int producer = 0; producer < THREAD_COUNT; producer++)
+  {
+    threads.emplace_back([&queue, producer]()
+    {
+      for (uintptr_t i = 0; i < ITEMS_PER_PRODUCER; i++)
+      {
+        // Values are offset by one, because nullptr means empty
+        const uintptr_t value = producer * ITEMS_PER_PRODUCER + i + 1;
+        while (!queue.Push(ToBuffer(value)))
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  for (unsigned int consumer = 0; consumer < THREAD_COUNT; consumer++)
+  {
+    threads.emplace_back([&queue, &seen, &popped]()
+    {
+      while (popped < THREAD_COUNT * ITEMS_PER_PRODUCER)
+      {
+        IRenderBuffer *buffer = queue.Pop();
+        if (buffer == nullptr)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+
+        seen[reinterpret_cast<uintptr_t>(buffer) - 1]++;
+        popped++;
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(queue.Pop(), nullptr);
+
+  unsigned int errors = 0;
+  for (auto &count : seen)
+  {
+    if (count != 1)
+      errors++;
+  }
+  EXPECT_EQ(errors, 0u);
+}
+
+TEST(TestRenderBufferPool, ReuseBuffers)
+{
+  std::shared_ptr<CTestRenderBufferPool> pool(new CTestRenderBufferPool);
+  ASSERT_TRUE(pool->Configure(AV_PIX_FMT_RGB565));
+
+  IRenderBuffer *buffer1 = pool->GetBuffer(100, 100);
+  IRenderBuffer *buffer2 = pool->GetBuffer(100, 100);
+  ASSERT_NE(buffer1, nullptr);
+  ASSERT_NE(buffer2, nullptr);
+  buffer1->Release();
+  buffer2->Release();
+
+  // Buffers of other dimensions are allocated, but don't evict free buffers
+  IRenderBuffer *buffer3 = pool->GetBuffer(200, 100);
+  ASSERT_NE(buffer3, nullptr);
+  buffer3->Release();
+
+  IRenderBuffer *buffer4 = pool->GetBuffer(100, 100);
+  EXPECT_TRUE(buffer4 == buffer1 || buffer4 == buffer2);
+  buffer4->Release();
+
+  const RenderBufferPoolStats stats = pool->GetStats();
+  EXPECT_EQ(stats.acquireCount, 4u);
+  EXPECT_EQ(stats.allocationCount, 3u);
+  EXPECT_GE(stats.maxAcquireUs, stats.meanAcquireUs);
+
+  pool->Flush();
+  EXPECT_EQ(g_liveBuffers, 0);
+}
+
+TEST(TestRenderBufferPool, KeepBuffersUntilFlush)
+{
+  constexpr unsigned int BUFFER_COUNT = 20;
+
+  std::shared_ptr<CTestRenderBufferPool> pool(new CTestRenderBufferPool);
+  ASSERT_TRUE(pool->Configure(AV_PIX_FMT_RGB565));
+
+  std::vector<IRenderBuffer*> buffers;
+  for (unsigned int i = 0; i < BUFFER_COUNT; i++)
+  {
+    IRenderBuffer *buffer = pool->GetBuffer(100, 100);
+    ASSERT_NE(buffer, nullptr);
+    buffers.push_back(buffer);
+  }
+
+  // More buffers are returned than the free queue holds
+  for (IRenderBuffer *buffer : buffers)
+    buffer->Release();
+  EXPECT_EQ(g_liveBuffers, static_cast<int>(BUFFER_COUNT));
+
+  // Free buffers of other dimensions aren't destroyed while acquiring
+  IRenderBuffer *buffer = pool->GetBuffer(200, 100);
+  ASSERT_NE(buffer, nullptr);
+  buffer->Release();
+  EXPECT_EQ(g_liveBuffers, static_cast<int>(BUFFER_COUNT) + 1);
+
+  pool->Flush();
+  EXPECT_EQ(g_liveBuffers, 0);
+}
+
+TEST(TestRenderBufferPool, GameAndRenderThreads)
+{
+  constexpr unsigned int FRAME_COUNT = 100000;
+
+  std::shared_ptr<CTestRenderBufferPool> pool(new CTestRenderBufferPool);
+  ASSERT_TRUE(pool->Configure(AV_PIX_FMT_RGB565));
+
+  // Latest frame, owned by whichever thread exchanges it out
+  std::atomic<IRenderBuffer*> latestFrame(nullptr);
+  std::atomic<bool> bStopped(false);
+
+  std::thread renderThread([&latestFrame, &bStopped]()
+  {
+    while (!bStopped)
+    {
+      IRenderBuffer *buffer = latestFrame.exchange(nullptr);
+      if (buffer != nullptr)
+      {
+        buffer->SetRendered(true);
+        buffer->Release();
+      }
+    }
+  });
+
+  unsigned int failures = 0;
+  for (unsigned int i = 0; i < FRAME_COUNT; i++)
+  {
+    IRenderBuffer *buffer = pool->GetBuffer(320, 240);
+    if (buffer == nullptr)
+    {
+      failures++;
+      continue;
+    }
+
+    IRenderBuffer *oldBuffer = latestFrame.exchange(buffer);
+    if (oldBuffer != nullptr)
+      oldBuffer->Release();
+  }
+
+  bStopped = true;
+  renderThread.join();
+
+  IRenderBuffer *buffer = latestFrame.exchange(nullptr);
+  if (buffer != nullptr)
+    buffer->Release();
+
+  EXPECT_EQ(failures, 0u);
+
+  // At most one buffer each for the game thread, the latest frame and the
+  // render thread
+  const RenderBufferPoolStats stats = pool->GetStats();
+  EXPECT_EQ(stats.acquireCount, FRAME_COUNT);
+  EXPECT_LE(stats.allocationCount, 3u);
+  EXPECT_EQ(g_liveBuffers, static_cast<int>(stats.allocationCount));
+
+  pool->Flush();
+  EXPECT_EQ(g_liveBuffers, 0);
+}
@@ -7,9 +7,16 @@
  */
 
 #include "GameLoop.h"
-#include "threads/SystemClock.h"
+#include "cores/RetroPlayer/process/RPProcessInfo.h"
+#include "cores/VideoPlayer/VideoReferenceClock.h"
+#include "utils/TimeUtils.h"
 
 #include <cmath>
+#include <thread>
+
+#if defined(TARGET_POSIX)
+#include <time.h>
+#endif
 
 using namespace KODI;
 using namespace RETRO;
@@ -17,13 +24,71 @@ using namespace RETRO;
 #define DEFAULT_FPS  60  // In case fps is 0 (shouldn't happen)
 #define FOREVER_MS   (7 * 24 * 60 * 60 * 1000) // 1 week is large enough
 
-CGameLoop::CGameLoop(IGameLoopCallback* callback, double fps) :
+namespace
+{
+  // Time before a deadline when the coarse wait hands over to the precise wait
+  constexpr double PRECISE_WAIT_MS = 2.0;
+
+  // Time before a deadline when the precise wait starts spinning
+  constexpr double SPIN_TAIL_MS = 0.2;
+
+  // Worst case overshoot of Sleep() on Windows, one scheduler tick
+  constexpr double SLEEP_TICK_MS = 1.0;
+
+  // Frames later than this are rescheduled instead of run back-to-back
+  constexpr double MAX_LATE_FRAMES = 2.0;
+
+  // Display sync is used if the refresh rate is within this fraction of the
+  // game's frame rate
+  constexpr double MAX_DISPLAY_SKEW = 0.005;
+
+  // Frame timing is published to the process info once per second
+  constexpr double PUBLISH_INTERVAL_SECS = 1.0;
+
+  /*!
+   * \brief Sleep for a duration shorter than the scheduler's tick
+   */
+  void SleepPreciseMs(double durationMs)
+  {
+    if (durationMs <= 0.0)
+      return;
+
+#if defined(TARGET_POSIX)
+    struct timespec duration;
+    duration.tv_sec = 0;
+    duration.tv_nsec = static_cast<long>(durationMs * 1000.0 * 1000.0);
+#if defined(TARGET_DARWIN)
+    nanosleep(&duration, nullptr);
+#else
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, nullptr);
+#endif
+#else
+    // Sleep() rounds up to the scheduler tick, so sleep whole ticks and
+    // spin through the rest
+    const int64_t start = CurrentHostCounter();
+    const int64_t duration = static_cast<int64_t>(durationMs * static_cast<double>(CurrentHostFrequency()) / 1000.0);
+    const double sleepMs = durationMs - SLEEP_TICK_MS;
+    if (sleepMs >= 1.0)
+      Sleep(static_cast<DWORD>(sleepMs));
+
+    while (CurrentHostCounter() - start < duration)
+      std::this_thread::yield();
+#endif
+  }
+}
+
+CGameLoop::CGameLoop(IGameLoopCallback* callback, CRPProcessInfo& processInfo, double fps, bool bDisplaySync) :
   CThread("GameLoop"),
   m_callback(callback),
+  m_processInfo(processInfo),
   m_fps(fps ? fps : DEFAULT_FPS),
+  m_bDisplaySync(bDisplaySync),
   m_speedFactor(0.0),
   m_lastFrameMs(0.0),
-  m_adjustTime(0.0)
+  m_nextFrameMs(0.0),
+  m_lastFrameStartMs(0.0),
+  m_bDisplaySyncActive(false),
+  m_framesSincePublish(0)
 {
 }
 
@@ -34,6 +99,12 @@ CGameLoop::~CGameLoop()
 
 void CGameLoop::Start()
 {
+  if (m_bDisplaySync && !m_displayClock)
+    m_displayClock.reset(new CVideoReferenceClock);
+
+  m_frameTiming.Reset();
+  m_framesSincePublish = 0;
+
   Create();
 }
 
@@ -42,6 +113,15 @@ void CGameLoop::Stop()
   StopThread(false);
   m_sleepEvent.Set();
   StopThread(true);
+
+  // Publish the final stats, the player logs them when closing the file
+  if (m_frameTiming.frameIntervalMs.SampleCount() > 0)
+  {
+    PublishFrameTiming();
+    m_frameTiming.Reset();
+  }
+
+  m_displayClock.reset();
 }
 
 void CGameLoop::SetSpeed(double speedFactor)
@@ -62,42 +142,47 @@ void CGameLoop::Process(void)
   {
     if (m_speedFactor == 0.0)
     {
-      m_lastFrameMs = 0.0;
+      m_nextFrameMs = 0.0;
       m_sleepEvent.WaitMSec(5000);
+      continue;
+    }
+
+    const double frameStartMs = NowMs();
+
+    if (m_speedFactor > 0.0)
+      m_callback->FrameEvent();
+    else if (m_speedFactor < 0.0)
+      m_callback->RewindEvent();
+
+    const double frameEndMs = NowMs();
+
+    if (m_nextFrameMs > 0.0)
+    {
+      UpdateFrameTiming(frameStartMs, frameEndMs);
+      m_lastFrameMs = m_nextFrameMs;
     }
     else
     {
-      if (m_speedFactor > 0.0)
-        m_callback->FrameEvent();
-      else if (m_speedFactor < 0.0)
-        m_callback->RewindEvent();
+      // First frame after a pause
+      m_lastFrameMs = frameStartMs;
+    }
 
-      if (m_lastFrameMs > 0.0)
-      {
-        m_lastFrameMs += FrameTimeMs();
-        m_adjustTime = m_lastFrameMs - NowMs();
-      }
-      else
-      {
-        m_lastFrameMs = NowMs();
-        m_adjustTime = 0.0;
-      }
+    m_lastFrameStartMs = frameStartMs;
 
-      // Calculate sleep time
-      double sleepTimeMs = SleepTimeMs();
+    // Wait for the next frame, rescheduling if the speed changes
+    do
+    {
+      m_nextFrameMs = NextFrameMs(m_lastFrameMs);
 
-      // Sleep at least 1 ms to avoid sleeping forever
-      while (sleepTimeMs > 1.0)
+      const double nowMs = NowMs();
+      if (nowMs - m_nextFrameMs > MAX_LATE_FRAMES * FrameTimeMs())
       {
-        m_sleepEvent.WaitMSec(static_cast<unsigned int>(sleepTimeMs));
-
-        if (m_bStop)
-          break;
-
-        // Speed may have changed, update sleep time
-        sleepTimeMs = SleepTimeMs();
+        // Too late to catch up, start over from now
+        m_frameTiming.droppedDeadlines++;
+        m_lastFrameMs = nowMs - FrameTimeMs();
+        m_nextFrameMs = nowMs;
       }
-    }
+    } while (!WaitUntilMs(m_nextFrameMs) && !m_bStop && m_speedFactor != 0.0);
   }
 }
 
@@ -109,24 +194,92 @@ double CGameLoop::FrameTimeMs() const
     return 1000.0 / m_fps / 1.0;
 }
 
-double CGameLoop::SleepTimeMs() const
+double CGameLoop::NextFrameMs(double lastFrameMs)
 {
-  // Calculate next frame time
-  const double nextFrameMs = m_lastFrameMs + FrameTimeMs();
+  double vblankMs;
+  double refreshIntervalMs;
 
-  // Calculate sleep time
-  double sleepTimeMs = (nextFrameMs - NowMs()) + m_adjustTime;
+  m_bDisplaySyncActive = GetDisplayTiming(vblankMs, refreshIntervalMs);
 
-  // Reset adjust time
-  m_adjustTime = 0.0;
+  if (!m_bDisplaySyncActive)
+    return lastFrameMs + FrameTimeMs();
 
-  // Positive or zero
-  sleepTimeMs = (sleepTimeMs >= 0.0 ? sleepTimeMs : 0.0);
+  // Snap to the vblank closest to one refresh interval after the last frame
+  const double nextFrameMs = lastFrameMs + refreshIntervalMs;
+  const double vblanks = std::round((nextFrameMs - vblankMs) / refreshIntervalMs);
 
-  return sleepTimeMs;
+  return vblankMs + vblanks * refreshIntervalMs;
 }
 
 double CGameLoop::NowMs() const
 {
-  return static_cast<double>(XbmcThreads::SystemClockMillis());
+  return static_cast<double>(CurrentHostCounter()) * 1000.0 / static_cast<double>(CurrentHostFrequency());
+}
+
+bool CGameLoop::WaitUntilMs(double deadlineMs)
+{
+  // Coarse wait, which can be interrupted by a speed change. It stops while
+  // at least a whole millisecond is left, as shorter waits truncate to 0 ms
+  double remainingMs = deadlineMs - NowMs();
+  while (remainingMs >= PRECISE_WAIT_MS + 1.0)
+  {
+    if (m_sleepEvent.WaitMSec(static_cast<unsigned int>(remainingMs - PRECISE_WAIT_MS)))
+      return false;
+
+    if (m_bStop)
+      return false;
+
+    remainingMs = deadlineMs - NowMs();
+  }
+
+  // Precise wait
+  SleepPreciseMs(remainingMs - SPIN_TAIL_MS);
+
+  while (NowMs() < deadlineMs)
+    std::this_thread::yield();
+
+  return !m_bStop;
+}
+
+bool CGameLoop::GetDisplayTiming(double &vblankMs, double &refreshIntervalMs)
+{
+  // Fast-forward and rewind use the timer
+  if (!m_displayClock || m_speedFactor != 1.0)
+    return false;
+
+  double interval = 0.0;
+  const double refreshRate = m_displayClock->GetRefreshRate(&interval);
+  if (refreshRate <= 0.0 || interval <= 0.0)
+    return false;
+
+  refreshIntervalMs = interval * 1000.0;
+
+  const double frameRate = 1000.0 / refreshIntervalMs;
+  if (std::abs(frameRate - m_fps) > m_fps * MAX_DISPLAY_SKEW)
+    return false;
+
+  const int64_t vblankTime = m_displayClock->GetVblankTime();
+  if (vblankTime < 0)
+    return false;
+
+  vblankMs = static_cast<double>(vblankTime) * 1000.0 / static_cast<double>(CurrentHostFrequency());
+
+  return true;
+}
+
+void CGameLoop::UpdateFrameTiming(double frameStartMs, double frameEndMs)
+{
+  m_frameTiming.frameIntervalMs.AddSample(frameStartMs - m_lastFrameStartMs);
+  m_frameTiming.driftMs.AddSample(frameStartMs - m_nextFrameMs);
+  m_frameTiming.frameTimeMs.AddSample(frameEndMs - frameStartMs);
+  m_frameTiming.bDisplaySync = m_bDisplaySyncActive;
+
+  if (++m_framesSincePublish >= PUBLISH_INTERVAL_SECS * m_fps)
+    PublishFrameTiming();
+}
+
+void CGameLoop::PublishFrameTiming()
+{
+  m_processInfo.SetFrameTiming(m_frameTiming);
+  m_framesSincePublish = 0;
 }
@@ -9,14 +9,20 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 
+#include "cores/RetroPlayer/process/FrameTimingStats.h"
 #include "threads/Event.h"
 #include "threads/Thread.h"
 
+class CVideoReferenceClock;
+
 namespace KODI
 {
 namespace RETRO
 {
+  class CRPProcessInfo;
+
   class IGameLoopCallback
   {
   public:
@@ -33,10 +39,23 @@ namespace RETRO
     virtual void RewindEvent() = 0;
   };
 
+  /*!
+   * \brief Runs frames at the game's frame rate
+   *
+   * Frames are scheduled against a high-resolution clock. Waits are split
+   * into a coarse, interruptible wait and a precise wait that sleeps with
+   * sub-millisecond resolution and spins for the last fraction of a
+   * millisecond.
+   *
+   * If display sync is enabled and the display's refresh rate is close to the
+   * game's frame rate, frames are instead aligned to the display's vsync as
+   * reported by CVideoReferenceClock. The small difference in speed is left
+   * to the audio stream's rate control.
+   */
   class CGameLoop : protected CThread
   {
   public:
-    CGameLoop(IGameLoopCallback* callback, double fps);
+    CGameLoop(IGameLoopCallback* callback, CRPProcessInfo& processInfo, double fps, bool bDisplaySync);
 
     virtual ~CGameLoop();
 
@@ -55,15 +74,47 @@ namespace RETRO
 
   private:
     double FrameTimeMs() const;
-    double SleepTimeMs() const;
+    double NextFrameMs(double lastFrameMs);
     double NowMs() const;
 
+    /*!
+     * \brief Wait until the given time
+     *
+     * \return True if the time was reached, false if the wait was interrupted
+     *         by a speed change or by stopping the thread
+     */
+    bool WaitUntilMs(double deadlineMs);
+
+    /*!
+     * \brief Get the vsync timing, if frames should be synced to the display
+     *
+     * \param vblankMs The time of the last vblank
+     * \param refreshIntervalMs The time between vblanks
+     *
+     * \return True if frames should be synced to the display, false otherwise
+     */
+    bool GetDisplayTiming(double &vblankMs, double &refreshIntervalMs);
+
+    void UpdateFrameTiming(double frameStartMs, double frameEndMs);
+    void PublishFrameTiming();
+
     IGameLoopCallback* const m_callback;
+    CRPProcessInfo&          m_processInfo;
     const double             m_fps;
+    const bool               m_bDisplaySync;
     std::atomic<double>      m_speedFactor;
-    double                   m_lastFrameMs;
-    mutable double           m_adjustTime;
+    double                   m_lastFrameMs; // Scheduled time of the last frame
+    double                   m_nextFrameMs; // Scheduled time of the next frame, or 0 if unscheduled
+    double                   m_lastFrameStartMs;
     CEvent                   m_sleepEvent;
+
+    // Display sync
+    std::unique_ptr<CVideoReferenceClock> m_displayClock;
+    bool                     m_bDisplaySyncActive;
+
+    // Timing statistics
+    FrameTimingStats         m_frameTiming;
+    unsigned int             m_framesSincePublish;
   };
 }
 }
@@ -7,15 +7,18 @@
  */
 
 #include "ReversiblePlayback.h"
+#include "cores/RetroPlayer/savestates/AsyncSavestateWriter.h"
 #include "cores/RetroPlayer/savestates/ISavestate.h"
 #include "cores/RetroPlayer/savestates/SavestateDatabase.h"
-#include "cores/RetroPlayer/streams/memory/DeltaPairMemoryStream.h"
+#include "cores/RetroPlayer/streams/memory/CompressedMemoryStream.h"
+#include "cores/RetroPlayer/streams/RPStreamManager.h"
 #include "games/addons/GameClient.h"
 #include "games/GameServices.h"
 #include "games/GameSettings.h"
 #include "threads/SingleLock.h"
 #include "utils/MathUtils.h"
 #include "utils/URIUtils.h"
+#include "utils/log.h"
 #include "ServiceBroker.h"
 
 #include <algorithm>
@@ -24,11 +27,16 @@ using namespace KODI;
 using namespace RETRO;
 
 #define REWIND_FACTOR  0.25  // Rewind at 25% of gameplay speed
+#define UNCOMPRESSED_REWIND_SEC  3  // Keep the last few seconds uncompressed for instant scrubbing
+#define KEYFRAME_INTERVAL_SEC  1  // Minimum time between full snapshots used for seeking
 
-CReversiblePlayback::CReversiblePlayback(GAME::CGameClient* gameClient, double fps, size_t serializeSize) :
+CReversiblePlayback::CReversiblePlayback(GAME::CGameClient* gameClient, CRPProcessInfo& processInfo, CRPStreamManager& streamManager, double fps, size_t serializeSize) :
   m_gameClient(gameClient),
-  m_gameLoop(this, fps),
+  m_streamManager(streamManager),
+  m_gameLoop(this, processInfo, fps, CServiceBroker::GetGameServices().GameSettings().SyncToDisplay()),
+  m_runaheadFrames(0),
   m_savestateDatabase(new CSavestateDatabase),
+  m_savestateWriter(new CAsyncSavestateWriter),
   m_totalFrameCount(0),
   m_pastFrameCount(0),
   m_futureFrameCount(0),
@@ -37,6 +45,7 @@ CReversiblePlayback::CReversiblePlayback(GAME::CGameClient* gameClient, double f
   m_cacheTimeMs(0)
 {
   UpdateMemoryStream();
+  UpdateRunahead();
 
   GAME::CGameSettings &gameSettings = CServiceBroker::GetGameServices().GameSettings();
   gameSettings.RegisterObserver(this);
@@ -120,25 +129,29 @@ std::string CReversiblePlayback::CreateSavestate()
   }
 
   const CDateTime now = CDateTime::GetCurrentDateTime();
-  const std::string label = now.GetAsLocalizedDateTime();
-  const std::string gameFileName = URIUtils::GetFileName(m_gameClient->GetGamePath());
-  const uint64_t timestampFrames = m_totalFrameCount;
-  const double timestampWallClock = (m_totalFrameCount / m_gameClient->GetFrameRate()); //! @todo Accumulate playtime instead of deriving it
-  const std::string gameClientId = m_gameClient->ID();
-  const std::string gameClientVersion = m_gameClient->Version().asString();
 
-  std::unique_ptr<ISavestate> savestate = m_savestateDatabase->CreateSavestate();
+  GAME::CGameSettings &gameSettings = CServiceBroker::GetGameServices().GameSettings();
+
+  // Only the memory is captured here, the savestate is written asynchronously
+  std::unique_ptr<CAsyncSavestateWriter::Request> request = m_savestateWriter->GetRequest(memorySize);
+  if (!request)
+  {
+    CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Previous savestates are still being written, skipping savestate");
+    return "";
+  }
 
-  savestate->SetType(SAVE_TYPE::AUTO);
-  savestate->SetLabel(label);
-  savestate->SetCreated(now);
-  savestate->SetGameFileName(gameFileName);
-  savestate->SetTimestampFrames(timestampFrames);
-  savestate->SetTimestampWallClock(timestampWallClock);
-  savestate->SetGameClientID(gameClientId);
-  savestate->SetGameClientVersion(gameClientVersion);
+  request->gamePath = m_gameClient->GetGamePath();
+  request->type = SAVE_TYPE::AUTO;
+  request->label = now.GetAsLocalizedDateTime();
+  request->created = now;
+  request->gameFileName = URIUtils::GetFileName(m_gameClient->GetGamePath());
+  request->timestampFrames = m_totalFrameCount;
+  request->timestampWallClock = (m_totalFrameCount / m_gameClient->GetFrameRate()); //! @todo Accumulate playtime instead of deriving it
+  request->gameClientId = m_gameClient->ID();
+  request->gameClientVersion = m_gameClient->Version().asString();
+  request->bCompressMemory = gameSettings.CompressSavestates();
 
-  uint8_t *memoryData = savestate->GetMemoryBuffer(memorySize);
+  uint8_t *memoryData = request->memoryData.data();
 
   {
     CSingleLock lock(m_mutex);
@@ -150,14 +163,14 @@ std::string CReversiblePlayback::CreateSavestate()
     {
       lock.Leave();
       if (!m_gameClient->Serialize(memoryData, memorySize))
+      {
+        m_savestateWriter->ReleaseRequest(std::move(request));
         return "";
+      }
     }
   }
 
-  savestate->Finalize();
-
-  if (!m_savestateDatabase->AddSavestate(m_gameClient->GetGamePath(), *savestate))
-    return "";
+  m_savestateWriter->SubmitRequest(std::move(request));
 
   return m_gameClient->GetGamePath();
 }
@@ -172,6 +185,9 @@ bool CReversiblePlayback::LoadSavestate(const std::string& path)
 
   bool bSuccess = false;
 
+  // Make sure a savestate that is still being written isn't read
+  m_savestateWriter->Flush();
+
   std::unique_ptr<ISavestate> savestate = m_savestateDatabase->CreateSavestate();
   if (m_savestateDatabase->GetSavestate(path, *savestate) && savestate->GetMemorySize() == memorySize)
   {
@@ -179,9 +195,12 @@ bool CReversiblePlayback::LoadSavestate(const std::string& path)
       CSingleLock lock(m_mutex);
       if (m_memoryStream)
       {
-        m_memoryStream->SetFrameCounter(savestate->TimestampFrames());
+        // The loaded state continues the frame history instead of taking the
+        // savestate's timestamp, so seeking can rewind past it as far as
+        // m_pastFrameCount reports
         std::memcpy(m_memoryStream->BeginFrame(), savestate->GetMemoryData(), memorySize);
         m_memoryStream->SubmitFrame();
+        UpdatePlaybackStats();
       }
     }
 
@@ -197,9 +216,19 @@ bool CReversiblePlayback::LoadSavestate(const std::string& path)
 
 void CReversiblePlayback::FrameEvent()
 {
-  m_gameClient->RunFrame();
+  const unsigned int runaheadFrames = m_runaheadFrames;
 
-  AddFrame();
+  // Running ahead only makes sense at normal speed
+  if (runaheadFrames > 0 && !m_bRunaheadFailed && m_gameLoop.GetSpeed() == 1.0)
+  {
+    RunAhead(runaheadFrames);
+  }
+  else
+  {
+    m_gameClient->RunFrame();
+
+    AddFrame();
+  }
 }
 
 void CReversiblePlayback::RewindEvent()
@@ -209,13 +238,70 @@ void CReversiblePlayback::RewindEvent()
   m_gameClient->RunFrame();
 }
 
-void CReversiblePlayback::AddFrame()
+void CReversiblePlayback::RunAhead(unsigned int frameCount)
+{
+  const size_t stateSize = m_gameClient->SerializeSize();
+
+  // Allocated once, so that saving the state is a single serialize call
+  if (m_runaheadState.size() != stateSize)
+    m_runaheadState.resize(stateSize);
+
+  // The real frame is heard but not seen
+  m_streamManager.SuppressOutput(true, false);
+  m_gameClient->RunFrame();
+
+  if (!m_gameClient->Serialize(m_runaheadState.data(), stateSize))
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[PLAYBACK]: Failed to save state, disabling run-ahead");
+    m_bRunaheadFailed = true;
+
+    m_streamManager.SuppressOutput(false, false);
+    AddFrame();
+    return;
+  }
+
+  // Future frames are silent, and only the last one is shown
+  for (unsigned int i = 0; i < frameCount; i++)
+  {
+    const bool bLastFrame = (i + 1 == frameCount);
+
+    m_streamManager.SuppressOutput(!bLastFrame, true);
+    m_gameClient->RunFrame();
+  }
+
+  m_streamManager.SuppressOutput(false, false);
+
+  // Return to the real frame
+  if (!m_gameClient->Deserialize(m_runaheadState.data(), stateSize))
+  {
+    // The game continues from the future frame, which is off by frameCount
+    // frames of input latency
+    CLog::Log(LOGERROR, "RetroPlayer[PLAYBACK]: Failed to load state, disabling run-ahead");
+    m_bRunaheadFailed = true;
+  }
+
+  AddFrame(m_runaheadState.data());
+}
+
+void CReversiblePlayback::AddFrame(const uint8_t* savedState /* = nullptr */)
 {
   CSingleLock lock(m_mutex);
 
   if (m_memoryStream)
   {
-    if (m_gameClient->Serialize(m_memoryStream->BeginFrame(), m_memoryStream->FrameSize()))
+    bool bSuccess = false;
+
+    if (savedState != nullptr)
+    {
+      std::memcpy(m_memoryStream->BeginFrame(), savedState, m_memoryStream->FrameSize());
+      bSuccess = true;
+    }
+    else
+    {
+      bSuccess = m_gameClient->Serialize(m_memoryStream->BeginFrame(), m_memoryStream->FrameSize());
+    }
+
+    if (bSuccess)
     {
       m_memoryStream->SubmitFrame();
       UpdatePlaybackStats();
@@ -231,7 +317,16 @@ void CReversiblePlayback::RewindFrames(uint64_t frames)
 
   if (m_memoryStream)
   {
-    m_memoryStream->RewindFrames(frames);
+    if (frames > 1)
+    {
+      // Seeking can skip most of the deltas by restoring a keyframe
+      const uint64_t frameCounter = m_memoryStream->GetFrameCounter();
+      m_memoryStream->SeekToFrame(frameCounter - std::min(frameCounter, frames));
+    }
+    else
+    {
+      m_memoryStream->RewindFrames(frames);
+    }
     m_gameClient->Deserialize(m_memoryStream->CurrentFrame(), m_memoryStream->FrameSize());
     UpdatePlaybackStats();
   }
@@ -273,6 +368,7 @@ void CReversiblePlayback::Notify(const Observable &obs, const ObservableMessage
   {
   case ObservableMessageSettingsChanged:
     UpdateMemoryStream();
+    UpdateRunahead();
     break;
   default:
     break;
@@ -297,10 +393,14 @@ void CReversiblePlayback::UpdateMemoryStream()
       rewindBufferSec = 10; // Sanity check
 
     unsigned int frameCount = MathUtils::round_int(rewindBufferSec * m_gameLoop.FPS());
+    size_t memorySize = static_cast<size_t>(gameSettings.MaxRewindMemoryMB()) * 1024 * 1024;
 
     if (!m_memoryStream)
     {
-      m_memoryStream.reset(new CDeltaPairMemoryStream);
+      const unsigned int uncompressedFrameCount = MathUtils::round_int(UNCOMPRESSED_REWIND_SEC * m_gameLoop.FPS());
+      const unsigned int keyframeInterval = MathUtils::round_int(KEYFRAME_INTERVAL_SEC * m_gameLoop.FPS());
+
+      m_memoryStream.reset(new CCompressedMemoryStream(uncompressedFrameCount, keyframeInterval));
       m_memoryStream->Init(m_gameClient->SerializeSize(), frameCount);
     }
 
@@ -308,6 +408,8 @@ void CReversiblePlayback::UpdateMemoryStream()
     {
       m_memoryStream->SetMaxFrameCount(frameCount);
     }
+
+    m_memoryStream->SetMaxMemorySize(memorySize);
   }
   else
   {
@@ -321,3 +423,20 @@ void CReversiblePlayback::UpdateMemoryStream()
     m_cacheTimeMs = 0;
   }
 }
+
+void CReversiblePlayback::UpdateRunahead()
+{
+  unsigned int runaheadFrames = 0;
+
+  // Running ahead requires saving and restoring the state every frame
+  if (m_gameClient->SerializeSize() > 0)
+    runaheadFrames = CServiceBroker::GetGameServices().GameSettings().RunaheadFrames();
+
+  if (m_runaheadFrames != runaheadFrames)
+  {
+    CLog::Log(LOGDEBUG, "RetroPlayer[PLAYBACK]: Running %u frames ahead", runaheadFrames);
+    m_runaheadFrames = runaheadFrames;
+  }
+
+  m_bRunaheadFailed = false;
+}
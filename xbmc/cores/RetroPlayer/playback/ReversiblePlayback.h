@@ -13,9 +13,11 @@
 #include "threads/CriticalSection.h"
 #include "utils/Observer.h"
 
+#include <atomic>
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
+#include <vector>
 
 namespace KODI
 {
@@ -26,6 +28,9 @@ namespace GAME
 
 namespace RETRO
 {
+  class CAsyncSavestateWriter;
+  class CRPProcessInfo;
+  class CRPStreamManager;
   class CSavestateDatabase;
   class IMemoryStream;
 
@@ -34,7 +39,7 @@ namespace RETRO
                               public Observer
   {
   public:
-    CReversiblePlayback(GAME::CGameClient* gameClient, double fps, size_t serializeSize);
+    CReversiblePlayback(GAME::CGameClient* gameClient, CRPProcessInfo& processInfo, CRPStreamManager& streamManager, double fps, size_t serializeSize);
 
     virtual ~CReversiblePlayback();
 
@@ -61,22 +66,47 @@ namespace RETRO
     virtual void Notify(const Observable &obs, const ObservableMessage msg) override;
 
   private:
-    void AddFrame();
+    /*!
+     * \brief Run a frame, then run ahead and present a future frame
+     *
+     * The state after the first frame is saved to memory, and restored after
+     * the future frame has been presented. Only the first frame is heard,
+     * and only the last frame is seen.
+     *
+     * \param frameCount The number of frames to run ahead
+     */
+    void RunAhead(unsigned int frameCount);
+
+    /*!
+     * \brief Record the current frame in the rewind buffer
+     *
+     * \param savedState The state of the current frame, if already saved,
+     *        or nullptr to serialize the game
+     */
+    void AddFrame(const uint8_t* savedState = nullptr);
     void RewindFrames(uint64_t frames);
     void AdvanceFrames(uint64_t frames);
     void UpdatePlaybackStats();
     void UpdateMemoryStream();
+    void UpdateRunahead();
 
     // Construction parameter
     GAME::CGameClient* const m_gameClient;
+    CRPStreamManager& m_streamManager;
 
     // Gameplay functionality
     CGameLoop m_gameLoop;
     std::unique_ptr<IMemoryStream> m_memoryStream;
     CCriticalSection m_mutex;
 
+    // Runahead functionality
+    std::atomic<unsigned int> m_runaheadFrames;
+    std::atomic<bool> m_bRunaheadFailed{false}; // Disabled until the setting changes
+    std::vector<uint8_t> m_runaheadState; // Only accessed by the game loop
+
     // Savestate functionality
     std::unique_ptr<CSavestateDatabase> m_savestateDatabase;
+    std::unique_ptr<CAsyncSavestateWriter> m_savestateWriter;
 
     // Playback stats
     uint64_t m_totalFrameCount;
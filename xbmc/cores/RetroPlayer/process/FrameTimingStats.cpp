@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FrameTimingStats.h"
+
+#include <algorithm>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // Frame intervals up to 100 ms, with 0.1 ms resolution
+  constexpr double INTERVAL_BUCKET_WIDTH_MS = 0.1;
+  constexpr unsigned int INTERVAL_BUCKET_COUNT = 1000;
+
+  // Drift up to 20 ms, with 0.05 ms resolution
+  constexpr double DRIFT_BUCKET_WIDTH_MS = 0.05;
+  constexpr unsigned int DRIFT_BUCKET_COUNT = 400;
+}
+
+CFrameTimingHistogram::CFrameTimingHistogram(double bucketWidthMs, unsigned int bucketCount) :
+  m_bucketWidthMs(bucketWidthMs),
+  m_buckets(std::max(bucketCount, 1u))
+{
+}
+
+void CFrameTimingHistogram::Reset()
+{
+  std::fill(m_buckets.begin(), m_buckets.end(), 0);
+  m_sampleCount = 0;
+  m_sumMs = 0.0;
+  m_minMs = 0.0;
+  m_maxMs = 0.0;
+}
+
+void CFrameTimingHistogram::AddSample(double valueMs)
+{
+  size_t bucket = 0;
+  if (valueMs > 0.0)
+    bucket = std::min(static_cast<size_t>(valueMs / m_bucketWidthMs), m_buckets.size() - 1);
+
+  m_buckets[bucket]++;
+
+  if (m_sampleCount == 0)
+  {
+    m_minMs = valueMs;
+    m_maxMs = valueMs;
+  }
+  else
+  {
+    m_minMs = std::min(m_minMs, valueMs);
+    m_maxMs = std::max(m_maxMs, valueMs);
+  }
+
+  m_sampleCount++;
+  m_sumMs += valueMs;
+}
+
+double CFrameTimingHistogram::MeanMs() const
+{
+  if (m_sampleCount == 0)
+    return 0.0;
+
+  return m_sumMs / m_sampleCount;
+}
+
+double CFrameTimingHistogram::PercentileMs(double fraction) const
+{
+  if (m_sampleCount == 0)
+    return 0.0;
+
+  fraction = std::max(0.0, std::min(fraction, 1.0));
+
+  const uint64_t target = std::max(static_cast<uint64_t>(fraction * m_sampleCount + 0.5), static_cast<uint64_t>(1));
+
+  uint64_t count = 0;
+  for (size_t i = 0; i < m_buckets.size(); i++)
+  {
+    count += m_buckets[i];
+    if (count >= target)
+    {
+      // The last bucket has no upper edge
+      if (i == m_buckets.size() - 1)
+        return m_maxMs;
+
+      return (i + 1) * m_bucketWidthMs;
+    }
+  }
+
+  return m_maxMs;
+}
+
+FrameTimingStats::FrameTimingStats() :
+  frameIntervalMs(INTERVAL_BUCKET_WIDTH_MS, INTERVAL_BUCKET_COUNT),
+  driftMs(DRIFT_BUCKET_WIDTH_MS, DRIFT_BUCKET_COUNT),
+  frameTimeMs(INTERVAL_BUCKET_WIDTH_MS, INTERVAL_BUCKET_COUNT)
+{
+}
+
+void FrameTimingStats::Reset()
+{
+  frameIntervalMs.Reset();
+  driftMs.Reset();
+  frameTimeMs.Reset();
+  droppedDeadlines = 0;
+  bDisplaySync = false;
+}
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Histogram of frame timings, in milliseconds
+   *
+   * Samples are counted in fixed-width buckets. Samples below zero are
+   * counted in the first bucket, and samples past the last bucket are counted
+   * in the last bucket.
+   */
+  class CFrameTimingHistogram
+  {
+  public:
+    /*!
+     * \brief Create a histogram
+     *
+     * \param bucketWidthMs The width of each bucket
+     * \param bucketCount The number of buckets
+     */
+    CFrameTimingHistogram(double bucketWidthMs, unsigned int bucketCount);
+
+    void Reset();
+
+    void AddSample(double valueMs);
+
+    uint64_t SampleCount() const { return m_sampleCount; }
+    double MinMs() const { return m_sampleCount > 0 ? m_minMs : 0.0; }
+    double MaxMs() const { return m_sampleCount > 0 ? m_maxMs : 0.0; }
+    double MeanMs() const;
+
+    /*!
+     * \brief Get the value below which the given fraction of samples fall
+     *
+     * \param fraction The fraction, between 0.0 and 1.0 (e.g. 0.99 for the
+     *        99th percentile)
+     *
+     * \return The upper edge of the bucket holding the percentile
+     */
+    double PercentileMs(double fraction) const;
+
+    double BucketWidthMs() const { return m_bucketWidthMs; }
+    const std::vector<uint64_t> &Buckets() const { return m_buckets; }
+
+  private:
+    double m_bucketWidthMs;
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_sampleCount = 0;
+    double m_sumMs = 0.0;
+    double m_minMs = 0.0;
+    double m_maxMs = 0.0;
+  };
+
+  /*!
+   * \brief Timing statistics of the game loop
+   */
+  struct FrameTimingStats
+  {
+    FrameTimingStats();
+
+    void Reset();
+
+    /*!
+     * \brief Time between the start of consecutive frames
+     */
+    CFrameTimingHistogram frameIntervalMs;
+
+    /*!
+     * \brief Time between a frame's deadline and the start of the frame
+     *
+     * This is the drift of the game loop from its schedule, caused by
+     * inaccurate waits and by frames that took too long.
+     */
+    CFrameTimingHistogram driftMs;
+
+    /*!
+     * \brief Time spent running a frame
+     */
+    CFrameTimingHistogram frameTimeMs;
+
+    /*!
+     * \brief Number of frames that were rescheduled because they were too
+     *        late to catch up
+     */
+    uint64_t droppedDeadlines = 0;
+
+    /*!
+     * \brief True if frames are synchronized to the display's vsync
+     */
+    bool bDisplaySync = false;
+  };
+}
+}
@@ -235,3 +235,23 @@ void CRPProcessInfo::SetPlayTimes(time_t start, int64_t current, int64_t min, in
   if (m_dataCache != nullptr)
     m_dataCache->SetPlayTimes(start, current, min, max);
 }
+
+//******************************************************************************
+// player timing info
+//******************************************************************************
+void CRPProcessInfo::SetFrameTiming(const FrameTimingStats &stats)
+{
+  {
+    CSingleLock lock(m_frameTimingMutex);
+    m_frameTiming = stats;
+  }
+
+  if (m_dataCache != nullptr)
+    m_dataCache->SetRenderClockSync(stats.bDisplaySync);
+}
+
+FrameTimingStats CRPProcessInfo::GetFrameTiming() const
+{
+  CSingleLock lock(m_frameTimingMutex);
+  return m_frameTiming;
+}
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "FrameTimingStats.h"
 #include "cores/RetroPlayer/RetroPlayerTypes.h"
 #include "cores/GameSettings.h"
 #include "threads/CriticalSection.h"
@@ -169,6 +170,22 @@ namespace RETRO
     void SetPlayTimes(time_t start, int64_t current, int64_t min, int64_t max);
     ///}
 
+    /// @name Player timing info
+    ///{
+
+    /*!
+     * \brief Publish the timing statistics of the game loop
+     *
+     * Called periodically from the game loop thread.
+     */
+    void SetFrameTiming(const FrameTimingStats &stats);
+
+    /*!
+     * \brief Get the most recently published timing statistics
+     */
+    FrameTimingStats GetFrameTiming() const;
+    ///}
+
   protected:
     /*!
      * \brief Constructor
@@ -196,6 +213,10 @@ namespace RETRO
     // Rendering parameters
     std::unique_ptr<CRenderBufferManager> m_renderBufferManager;
 
+    // Timing parameters
+    mutable CCriticalSection m_frameTimingMutex;
+    FrameTimingStats m_frameTiming;
+
   private:
     // Rendering parameters
     std::unique_ptr<CRenderContext> m_renderContext;
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/process/FrameTimingStats.h"
+
+#include "gtest/gtest.h"
+
+using namespace KODI;
+using namespace RETRO;
+
+TEST(TestFrameTimingStats, Empty)
+{
+  CFrameTimingHistogram histogram(0.1, 100);
+
+  EXPECT_EQ(histogram.SampleCount(), 0u);
+  EXPECT_DOUBLE_EQ(histogram.MeanMs(), 0.0);
+  EXPECT_DOUBLE_EQ(histogram.PercentileMs(0.99), 0.0);
+}
+
+TEST(TestFrameTimingStats, Percentiles)
+{
+  CFrameTimingHistogram histogram(1.0, 100);
+
+  // 1 ms to 100 ms
+  for (unsigned int i = 1; i <= 100; i++)
+    histogram.AddSample(i - 0.5);
+
+  EXPECT_EQ(histogram.SampleCount(), 100u);
+  EXPECT_DOUBLE_EQ(histogram.MinMs(), 0.5);
+  EXPECT_DOUBLE_EQ(histogram.MaxMs(), 99.5);
+  EXPECT_DOUBLE_EQ(histogram.MeanMs(), 50.0);
+  EXPECT_DOUBLE_EQ(histogram.PercentileMs(0.5), 50.0);
+  EXPECT_DOUBLE_EQ(histogram.PercentileMs(0.99), 99.0);
+  EXPECT_DOUBLE_EQ(histogram.PercentileMs(0.0), 1.0);
+}
+
+TEST(TestFrameTimingStats, OutOfRange)
+{
+  CFrameTimingHistogram histogram(0.1, 10);
+
+  histogram.AddSample(-3.0);
+  histogram.AddSample(250.0);
+
+  EXPECT_EQ(histogram.Buckets().front(), 1u);
+  EXPECT_EQ(histogram.Buckets().back(), 1u);
+  EXPECT_DOUBLE_EQ(histogram.MinMs(), -3.0);
+  EXPECT_DOUBLE_EQ(histogram.PercentileMs(1.0), 250.0);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.SampleCount(), 0u);
+  EXPECT_EQ(histogram.Buckets().back(), 0u);
+}
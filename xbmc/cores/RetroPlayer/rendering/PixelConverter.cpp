@@ -0,0 +1,359 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PixelConverter.h"
+#include "utils/CPUInfo.h"
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(HAS_NEON) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <initializer_list>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // Pixels are stored as native-endian words, so the little-endian layout
+  // of 0xAARRGGBB is BGRA in memory
+  constexpr uint32_t ALPHA_MASK = 0xFF000000;
+
+  // Expand a 5 or 6 bit channel to 8 bits by replicating the high bits
+  inline uint32_t Expand5(uint32_t x) { return (x << 3) | (x >> 2); }
+  inline uint32_t Expand6(uint32_t x) { return (x << 2) | (x >> 4); }
+
+  void ConvertRowRGB565_C(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint16_t *src = reinterpret_cast<const uint16_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    for (unsigned int i = 0; i < width; i++)
+    {
+      const uint32_t pixel = src[i];
+      dst[i] = ALPHA_MASK |
+               (Expand5((pixel >> 11) & 0x1F) << 16) |
+               (Expand6((pixel >> 5) & 0x3F) << 8) |
+               Expand5(pixel & 0x1F);
+    }
+  }
+
+  void ConvertRowRGB555_C(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint16_t *src = reinterpret_cast<const uint16_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    for (unsigned int i = 0; i < width; i++)
+    {
+      const uint32_t pixel = src[i];
+      dst[i] = ALPHA_MASK |
+               (Expand5((pixel >> 10) & 0x1F) << 16) |
+               (Expand5((pixel >> 5) & 0x1F) << 8) |
+               Expand5(pixel & 0x1F);
+    }
+  }
+
+  void ConvertRow0RGB32_C(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint32_t *src = reinterpret_cast<const uint32_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    for (unsigned int i = 0; i < width; i++)
+      dst[i] = src[i] | ALPHA_MASK;
+  }
+
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  inline __m128i Expand5_SSE2(__m128i x) { return _mm_or_si128(_mm_slli_epi16(x, 3), _mm_srli_epi16(x, 2)); }
+  inline __m128i Expand6_SSE2(__m128i x) { return _mm_or_si128(_mm_slli_epi16(x, 2), _mm_srli_epi16(x, 4)); }
+
+  /*!
+   * \brief Interleave eight 8-bit channels, stored in 16-bit lanes, as BGRA
+   */
+  inline void StoreBGRA_SSE2(__m128i b, __m128i g, __m128i r, uint32_t *dst)
+  {
+    const __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+    const __m128i ra = _mm_or_si128(r, _mm_set1_epi16(static_cast<short>(0xFF00)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi16(bg, ra));
+  }
+
+  void ConvertRowRGB565_SSE2(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint16_t *src = reinterpret_cast<const uint16_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+
+    unsigned int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+      const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+      const __m128i r = Expand5_SSE2(_mm_srli_epi16(pixels, 11));
+      const __m128i g = Expand6_SSE2(_mm_and_si128(_mm_srli_epi16(pixels, 5), mask6));
+      const __m128i b = Expand5_SSE2(_mm_and_si128(pixels, mask5));
+
+      StoreBGRA_SSE2(b, g, r, dst + i);
+    }
+
+    ConvertRowRGB565_C(source + i * sizeof(uint16_t), target + i * sizeof(uint32_t), width - i);
+  }
+
+  void ConvertRowRGB555_SSE2(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint16_t *src = reinterpret_cast<const uint16_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+
+    unsigned int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+      const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+      const __m128i r = Expand5_SSE2(_mm_and_si128(_mm_srli_epi16(pixels, 10), mask5));
+      const __m128i g = Expand5_SSE2(_mm_and_si128(_mm_srli_epi16(pixels, 5), mask5));
+      const __m128i b = Expand5_SSE2(_mm_and_si128(pixels, mask5));
+
+      StoreBGRA_SSE2(b, g, r, dst + i);
+    }
+
+    ConvertRowRGB555_C(source + i * sizeof(uint16_t), target + i * sizeof(uint32_t), width - i);
+  }
+
+  void ConvertRow0RGB32_SSE2(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint32_t *src = reinterpret_cast<const uint32_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(ALPHA_MASK));
+
+    unsigned int i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+      const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(pixels, alpha));
+    }
+
+    ConvertRow0RGB32_C(source + i * sizeof(uint32_t), target + i * sizeof(uint32_t), width - i);
+  }
+#endif
+
+#if defined(HAS_NEON) && defined(__ARM_NEON)
+  inline uint8x8_t Expand5_NEON(uint16x8_t x) { return vmovn_u16(vorrq_u16(vshlq_n_u16(x, 3), vshrq_n_u16(x, 2))); }
+  inline uint8x8_t Expand6_NEON(uint16x8_t x) { return vmovn_u16(vorrq_u16(vshlq_n_u16(x, 2), vshrq_n_u16(x, 4))); }
+
+  void ConvertRowRGB565_NEON(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint16_t *src = reinterpret_cast<const uint16_t*>(source);
+
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    const uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    unsigned int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+      const uint16x8_t pixels = vld1q_u16(src + i);
+
+      uint8x8x4_t bgra;
+      bgra.val[0] = Expand5_NEON(vandq_u16(pixels, mask5));
+      bgra.val[1] = Expand6_NEON(vandq_u16(vshrq_n_u16(pixels, 5), mask6));
+      bgra.val[2] = Expand5_NEON(vshrq_n_u16(pixels, 11));
+      bgra.val[3] = vdup_n_u8(0xFF);
+
+      vst4_u8(target + i * sizeof(uint32_t), bgra);
+    }
+
+    ConvertRowRGB565_C(source + i * sizeof(uint16_t), target + i * sizeof(uint32_t), width - i);
+  }
+
+  void ConvertRowRGB555_NEON(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint16_t *src = reinterpret_cast<const uint16_t*>(source);
+
+    const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+
+    unsigned int i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+      const uint16x8_t pixels = vld1q_u16(src + i);
+
+      uint8x8x4_t bgra;
+      bgra.val[0] = Expand5_NEON(vandq_u16(pixels, mask5));
+      bgra.val[1] = Expand5_NEON(vandq_u16(vshrq_n_u16(pixels, 5), mask5));
+      bgra.val[2] = Expand5_NEON(vandq_u16(vshrq_n_u16(pixels, 10), mask5));
+      bgra.val[3] = vdup_n_u8(0xFF);
+
+      vst4_u8(target + i * sizeof(uint32_t), bgra);
+    }
+
+    ConvertRowRGB555_C(source + i * sizeof(uint16_t), target + i * sizeof(uint32_t), width - i);
+  }
+
+  void ConvertRow0RGB32_NEON(const uint8_t *source, uint8_t *target, unsigned int width)
+  {
+    const uint32_t *src = reinterpret_cast<const uint32_t*>(source);
+    uint32_t *dst = reinterpret_cast<uint32_t*>(target);
+
+    const uint32x4_t alpha = vdupq_n_u32(ALPHA_MASK);
+
+    unsigned int i = 0;
+    for (; i + 4 <= width; i += 4)
+      vst1q_u32(dst + i, vorrq_u32(vld1q_u32(src + i), alpha));
+
+    ConvertRow0RGB32_C(source + i * sizeof(uint32_t), target + i * sizeof(uint32_t), width - i);
+  }
+#endif
+}
+
+CPixelConverter::CPixelConverter()
+{
+  for (INSTRUCTION_SET instructionSet : { INSTRUCTION_SET::SSE2, INSTRUCTION_SET::NEON })
+  {
+    if (IsAvailable(instructionSet))
+    {
+      m_instructionSet = instructionSet;
+      break;
+    }
+  }
+}
+
+CPixelConverter::CPixelConverter(INSTRUCTION_SET instructionSet)
+{
+  if (IsAvailable(instructionSet))
+    m_instructionSet = instructionSet;
+}
+
+bool CPixelConverter::IsSupported(AVPixelFormat sourceFormat, AVPixelFormat targetFormat)
+{
+#if defined(WORDS_BIGENDIAN)
+  // Kernels assume that BGRA is the little-endian layout of a 0xAARRGGBB word
+  return false;
+#else
+  switch (sourceFormat)
+  {
+  case AV_PIX_FMT_RGB565:
+  case AV_PIX_FMT_RGB555:
+    return targetFormat == AV_PIX_FMT_BGRA || targetFormat == AV_PIX_FMT_0RGB32;
+  case AV_PIX_FMT_0RGB32:
+    return targetFormat == AV_PIX_FMT_BGRA;
+  default:
+    break;
+  }
+
+  return false;
+#endif
+}
+
+bool CPixelConverter::Convert(AVPixelFormat sourceFormat, const uint8_t *source, unsigned int sourceStride,
+                              AVPixelFormat targetFormat, uint8_t *target, unsigned int targetStride,
+                              unsigned int width, unsigned int height) const
+{
+  if (!IsSupported(sourceFormat, targetFormat))
+    return false;
+
+  ConvertRowFunc convertRow = GetConvertRow(sourceFormat);
+  if (convertRow == nullptr)
+    return false;
+
+  for (unsigned int row = 0; row < height; row++)
+    convertRow(source + row * sourceStride, target + row * targetStride, width);
+
+  return true;
+}
+
+bool CPixelConverter::IsAvailable(INSTRUCTION_SET instructionSet)
+{
+  switch (instructionSet)
+  {
+  case INSTRUCTION_SET::C:
+    return true;
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  case INSTRUCTION_SET::SSE2:
+    return (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_SSE2) == CPU_FEATURE_SSE2;
+#endif
+#if defined(HAS_NEON) && defined(__ARM_NEON)
+  case INSTRUCTION_SET::NEON:
+    return (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_NEON) == CPU_FEATURE_NEON;
+#endif
+  default:
+    break;
+  }
+
+  return false;
+}
+
+const char *CPixelConverter::TranslateInstructionSet(INSTRUCTION_SET instructionSet)
+{
+  switch (instructionSet)
+  {
+  case INSTRUCTION_SET::C:
+    return "C";
+  case INSTRUCTION_SET::SSE2:
+    return "SSE2";
+  case INSTRUCTION_SET::NEON:
+    return "NEON";
+  default:
+    break;
+  }
+
+  return "";
+}
+
+CPixelConverter::ConvertRowFunc CPixelConverter::GetConvertRow(AVPixelFormat sourceFormat) const
+{
+  switch (m_instructionSet)
+  {
+#if defined(HAVE_SSE2) && defined(__SSE2__)
+  case INSTRUCTION_SET::SSE2:
+  {
+    switch (sourceFormat)
+    {
+    case AV_PIX_FMT_RGB565: return ConvertRowRGB565_SSE2;
+    case AV_PIX_FMT_RGB555: return ConvertRowRGB555_SSE2;
+    case AV_PIX_FMT_0RGB32: return ConvertRow0RGB32_SSE2;
+    default:
+      break;
+    }
+    break;
+  }
+#endif
+#if defined(HAS_NEON) && defined(__ARM_NEON)
+  case INSTRUCTION_SET::NEON:
+  {
+    switch (sourceFormat)
+    {
+    case AV_PIX_FMT_RGB565: return ConvertRowRGB565_NEON;
+    case AV_PIX_FMT_RGB555: return ConvertRowRGB555_NEON;
+    case AV_PIX_FMT_0RGB32: return ConvertRow0RGB32_NEON;
+    default:
+      break;
+    }
+    break;
+  }
+#endif
+  default:
+    break;
+  }
+
+  switch (sourceFormat)
+  {
+  case AV_PIX_FMT_RGB565: return ConvertRowRGB565_C;
+  case AV_PIX_FMT_RGB555: return ConvertRowRGB555_C;
+  case AV_PIX_FMT_0RGB32: return ConvertRow0RGB32_C;
+  default:
+    break;
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "libavutil/pixfmt.h"
+
+#include <stdint.h>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Vectorized conversion of game pixel formats to 32-bit BGRA
+   *
+   * Game cores usually emit RGB565, 0RGB1555 or 0RGB8888, while GUI
+   * textures are BGRA. These conversions don't need the generality of
+   * swscale, and are cheap enough to do with a few shifts per pixel.
+   *
+   * The conversions don't scale. Callers are expected to fall back to
+   * swscale if the dimensions differ, or if the formats aren't supported.
+   */
+  class CPixelConverter
+  {
+  public:
+    enum class INSTRUCTION_SET
+    {
+      C,
+      SSE2,
+      NEON,
+    };
+
+    /*!
+     * \brief Create a converter using the best instruction set supported by
+     *        the build and the CPU
+     */
+    CPixelConverter();
+
+    /*!
+     * \brief Create a converter using the given instruction set
+     *
+     * If the instruction set isn't available, plain C is used instead.
+     */
+    explicit CPixelConverter(INSTRUCTION_SET instructionSet);
+
+    /*!
+     * \brief Get the instruction set used by this converter
+     */
+    INSTRUCTION_SET GetInstructionSet() const { return m_instructionSet; }
+
+    /*!
+     * \brief Check if a conversion is supported
+     */
+    static bool IsSupported(AVPixelFormat sourceFormat, AVPixelFormat targetFormat);
+
+    /*!
+     * \brief Convert a frame without scaling
+     *
+     * \return True if the frame was converted, false if the conversion isn't
+     *         supported
+     */
+    bool Convert(AVPixelFormat sourceFormat, const uint8_t *source, unsigned int sourceStride,
+                 AVPixelFormat targetFormat, uint8_t *target, unsigned int targetStride,
+                 unsigned int width, unsigned int height) const;
+
+    /*!
+     * \brief Check if an instruction set is available in this build and on
+     *        this CPU
+     */
+    static bool IsAvailable(INSTRUCTION_SET instructionSet);
+
+    /*!
+     * \brief Translate an instruction set to a string suitable for logging
+     */
+    static const char *TranslateInstructionSet(INSTRUCTION_SET instructionSet);
+
+  private:
+    using ConvertRowFunc = void (*)(const uint8_t *source, uint8_t *target, unsigned int width);
+
+    ConvertRowFunc GetConvertRow(AVPixelFormat sourceFormat) const;
+
+    INSTRUCTION_SET m_instructionSet = INSTRUCTION_SET::C;
+  };
+}
+}
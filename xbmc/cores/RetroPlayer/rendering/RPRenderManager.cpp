@@ -44,6 +44,8 @@ CRPRenderManager::CRPRenderManager(CRPProcessInfo &processInfo) :
 void CRPRenderManager::Initialize()
 {
   CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Initializing render manager");
+  CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Using %s pixel converter",
+            CPixelConverter::TranslateInstructionSet(m_pixelConverter.GetInstructionSet()));
 }
 
 void CRPRenderManager::Deinitialize()
@@ -116,11 +118,21 @@ bool CRPRenderManager::GetVideoBuffer(unsigned int width, unsigned int height, A
       CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Unable to get video buffer for frame");
   }
 
-  if (m_pendingBuffers.empty())
+  // The game renders directly into the buffer, so it must be in the stream
+  // format. Buffers of other pools are filled from it in AddFrame().
+  auto it = std::find_if(m_pendingBuffers.begin(), m_pendingBuffers.end(),
+    [this, width, height](IRenderBuffer *renderBuffer)
+    {
+      return renderBuffer->GetFormat() == m_format &&
+             renderBuffer->GetWidth() == width &&
+             renderBuffer->GetHeight() == height &&
+             renderBuffer->GetMemory() != nullptr;
+    });
+
+  if (it == m_pendingBuffers.end())
     return false;
 
-  //! @todo Handle multiple buffers
-  IRenderBuffer *renderBuffer = m_pendingBuffers.at(0);
+  IRenderBuffer *renderBuffer = *it;
 
   format = renderBuffer->GetFormat();
   data = renderBuffer->GetMemory();
@@ -141,48 +153,47 @@ void CRPRenderManager::AddFrame(const uint8_t* data, size_t size, unsigned int w
   // Get render buffers to copy the frame into
   std::vector<IRenderBuffer*> renderBuffers;
 
-  // Check pending buffers
-  for (IRenderBuffer *buffer : m_pendingBuffers)
-  {
-    if (buffer->GetMemory() == data)
+  // Check for a zero-copy frame, rendered directly into a pending buffer
+  IRenderBuffer *zeroCopyBuffer = nullptr;
+
+  auto it = std::find_if(m_pendingBuffers.begin(), m_pendingBuffers.end(),
+    [data](IRenderBuffer *renderBuffer)
     {
-      buffer->Acquire();
-      renderBuffers.emplace_back(buffer);
-    }
+      return renderBuffer->GetMemory() == data;
+    });
+
+  if (it != m_pendingBuffers.end())
+  {
+    zeroCopyBuffer = *it;
+    m_pendingBuffers.erase(it);
+    renderBuffers.emplace_back(zeroCopyBuffer);
   }
 
-  // If we aren't submitting a zero-copy frame, copy into render buffer now
-  if (renderBuffers.empty())
+  // Copy frame to the remaining buffers with visible renderers
+  for (IRenderBufferPool *bufferPool : m_processInfo.GetBufferManager().GetBufferPools())
   {
-    // Copy frame to buffers with visible renderers
-    for (IRenderBufferPool *bufferPool : m_processInfo.GetBufferManager().GetBufferPools())
-    {
-      if (!bufferPool->HasVisibleRenderer())
-        continue;
+    if (!bufferPool->HasVisibleRenderer())
+      continue;
 
-      IRenderBuffer *renderBuffer = bufferPool->GetBuffer(width, height);
-      if (renderBuffer != nullptr)
-      {
-        CopyFrame(renderBuffer, m_format, data, size, width, height);
-        renderBuffers.emplace_back(renderBuffer);
-      }
-      else
-        CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Unable to get render buffer for frame");
+    if (zeroCopyBuffer != nullptr && zeroCopyBuffer->GetPool() == bufferPool)
+      continue;
+
+    IRenderBuffer *renderBuffer = GetPendingBuffer(bufferPool, width, height);
+    if (renderBuffer == nullptr)
+      renderBuffer = bufferPool->GetBuffer(width, height);
+
+    if (renderBuffer != nullptr)
+    {
+      CopyFrame(renderBuffer, m_format, data, size, width, height);
+      renderBuffers.emplace_back(renderBuffer);
     }
+    else
+      CLog::Log(LOGDEBUG, "RetroPlayer[RENDER]: Unable to get render buffer for frame");
   }
 
   {
     CSingleLock lock(m_bufferMutex);
 
-    // Set render buffers
-    for (auto renderBuffer : m_renderBuffers)
-      renderBuffer->Release();
-    m_renderBuffers = std::move(renderBuffers);
-
-    // Apply rotation to render buffers
-    for (auto renderBuffer : m_renderBuffers)
-      renderBuffer->SetRotation(orientationDegCCW);
-
     // Cache frame if it arrived after being paused
     if (m_speed == 0.0)
     {
@@ -210,6 +221,21 @@ void CRPRenderManager::AddFrame(const uint8_t* data, size_t size, unsigned int w
         m_cachedHeight = height;
       }
     }
+
+    // Frame data is no longer accessed by the game thread. The cache copy
+    // above may read a zero-copy frame, so the memory is released after it
+    // and before the renderers get the buffer.
+    if (zeroCopyBuffer != nullptr)
+      zeroCopyBuffer->ReleaseMemory();
+
+    // Set render buffers
+    for (auto renderBuffer : m_renderBuffers)
+      renderBuffer->Release();
+    m_renderBuffers = std::move(renderBuffers);
+
+    // Apply rotation to render buffers
+    for (auto renderBuffer : m_renderBuffers)
+      renderBuffer->SetRotation(orientationDegCCW);
   }
 }
 
@@ -517,6 +543,27 @@ IRenderBuffer *CRPRenderManager::GetRenderBuffer(IRenderBufferPool *bufferPool)
   return renderBuffer;
 }
 
+IRenderBuffer *CRPRenderManager::GetPendingBuffer(IRenderBufferPool *bufferPool, unsigned int width, unsigned int height)
+{
+  IRenderBuffer *renderBuffer = nullptr;
+
+  auto it = std::find_if(m_pendingBuffers.begin(), m_pendingBuffers.end(),
+    [bufferPool, width, height](IRenderBuffer *renderBuffer)
+    {
+      return renderBuffer->GetPool() == bufferPool &&
+             renderBuffer->GetWidth() == width &&
+             renderBuffer->GetHeight() == height;
+    });
+
+  if (it != m_pendingBuffers.end())
+  {
+    renderBuffer = *it;
+    m_pendingBuffers.erase(it);
+  }
+
+  return renderBuffer;
+}
+
 void CRPRenderManager::CreateRenderBuffer(IRenderBufferPool *bufferPool)
 {
   if (m_bFlush || m_state != RENDER_STATE::CONFIGURED)
@@ -571,13 +618,13 @@ void CRPRenderManager::CopyFrame(IRenderBuffer *renderBuffer, AVPixelFormat form
     const unsigned int sourceStride = static_cast<unsigned int>(size / height);
     const unsigned int targetStride = static_cast<unsigned int>(renderBuffer->GetFrameSize() / renderBuffer->GetHeight());
 
-    if (m_format == renderBuffer->GetFormat())
+    if (format == renderBuffer->GetFormat())
     {
       if (sourceStride == targetStride)
         std::memcpy(target, source, size);
       else
       {
-        const unsigned int widthBytes = CRenderTranslator::TranslateWidthToBytes(width, m_format);
+        const unsigned int widthBytes = CRenderTranslator::TranslateWidthToBytes(width, format);
         if (widthBytes > 0)
         {
           for (unsigned int i = 0; i < height; i++)
@@ -587,20 +634,29 @@ void CRPRenderManager::CopyFrame(IRenderBuffer *renderBuffer, AVPixelFormat form
     }
     else
     {
-      SwsContext *&scalerContext = m_scalers[renderBuffer->GetFormat()];
-      scalerContext = sws_getCachedContext(scalerContext,
-                                           width, height, format,
-                                           renderBuffer->GetWidth(), renderBuffer->GetHeight(), renderBuffer->GetFormat(),
-                                           SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+      bool bConverted = false;
+
+      // Unscaled game formats are converted without swscale
+      if (width == renderBuffer->GetWidth() && height == renderBuffer->GetHeight())
+        bConverted = m_pixelConverter.Convert(format, source, sourceStride, renderBuffer->GetFormat(), target, targetStride, width, height);
 
-      if (scalerContext != nullptr)
+      if (!bConverted)
       {
-        uint8_t* src[] =       { const_cast<uint8_t*>(source),    nullptr,   nullptr,   nullptr };
-        int      srcStride[] = { static_cast<int>(sourceStride),  0,         0,         0       };
-        uint8_t *dst[] =       { target,                          nullptr,   nullptr,   nullptr };
-        int      dstStride[] = { static_cast<int>(targetStride),  0,         0,         0       };
+        SwsContext *&scalerContext = m_scalers[renderBuffer->GetFormat()];
+        scalerContext = sws_getCachedContext(scalerContext,
+                                             width, height, format,
+                                             renderBuffer->GetWidth(), renderBuffer->GetHeight(), renderBuffer->GetFormat(),
+                                             SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
 
-        sws_scale(scalerContext, src, srcStride, 0, height, dst, dstStride);
+        if (scalerContext != nullptr)
+        {
+          uint8_t* src[] =       { const_cast<uint8_t*>(source),    nullptr,   nullptr,   nullptr };
+          int      srcStride[] = { static_cast<int>(sourceStride),  0,         0,         0       };
+          uint8_t *dst[] =       { target,                          nullptr,   nullptr,   nullptr };
+          int      dstStride[] = { static_cast<int>(targetStride),  0,         0,         0       };
+
+          sws_scale(scalerContext, src, srcStride, 0, height, dst, dstStride);
+        }
       }
     }
   }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "IRenderManager.h"
+#include "PixelConverter.h"
 #include "RenderVideoSettings.h"
 #include "cores/RetroPlayer/guibridge/IRenderCallback.h"
 #include "threads/CriticalSection.h"
@@ -121,6 +122,18 @@ namespace RETRO
      */
     IRenderBuffer *GetRenderBuffer(IRenderBufferPool *bufferPool);
 
+    /*!
+     * \brief Take ownership of a pending buffer belonging to the specified pool
+     *
+     * Pending buffers are requested from the pools in GetVideoBuffer(). If the
+     * game didn't render into one of them, they are reused for copying the
+     * frame instead of requesting a new buffer from the pool.
+     *
+     * \return The pending buffer, or nullptr if the pool has no pending buffer
+     *         of the given dimensions
+     */
+    IRenderBuffer *GetPendingBuffer(IRenderBufferPool *bufferPool, unsigned int width, unsigned int height);
+
     /*!
      * \brief Create a render buffer for the specified pool from a cached frame
      */
@@ -177,6 +190,7 @@ namespace RETRO
     std::set<std::shared_ptr<CRPBaseRenderer>> m_renderers;
     std::vector<IRenderBuffer*> m_pendingBuffers; // Only access from game thread
     std::vector<IRenderBuffer*> m_renderBuffers;
+    CPixelConverter m_pixelConverter;
     std::map<AVPixelFormat, SwsContext*> m_scalers;
     std::vector<uint8_t> m_cachedFrame;
     unsigned int m_cachedWidth = 0;
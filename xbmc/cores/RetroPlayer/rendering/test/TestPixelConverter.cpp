@@ -0,0 +1,136 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/rendering/PixelConverter.h"
+#include "test/BenchmarkUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // Not a multiple of the vector width, to exercise the tail of each row
+  constexpr unsigned int WIDTH = 253;
+  constexpr unsigned int HEIGHT = 224;
+
+  using INSTRUCTION_SET = CPixelConverter::INSTRUCTION_SET;
+
+  unsigned int BytesPerPixel(AVPixelFormat format)
+  {
+    return format == AV_PIX_FMT_0RGB32 ? 4 : 2;
+  }
+
+  std::vector<uint8_t> GenerateFrame(unsigned int stride)
+  {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<unsigned int> byteDist(0, 255);
+
+    std::vector<uint8_t> frame(stride * HEIGHT);
+    for (auto& byte : frame)
+      byte = static_cast<uint8_t>(byteDist(rng));
+
+    return frame;
+  }
+
+  std::vector<uint8_t> ConvertFrame(const CPixelConverter& converter, AVPixelFormat format, const std::vector<uint8_t>& source, unsigned int sourceStride)
+  {
+    const unsigned int targetStride = WIDTH * 4 + 12;
+
+    std::vector<uint8_t> target(targetStride * HEIGHT);
+    EXPECT_TRUE(converter.Convert(format, source.data(), sourceStride, AV_PIX_FMT_BGRA, target.data(), targetStride, WIDTH, HEIGHT));
+
+    // Ignore padding
+    for (unsigned int row = 0; row < HEIGHT; row++)
+      std::fill(target.begin() + row * targetStride + WIDTH * 4, target.begin() + (row + 1) * targetStride, 0);
+
+    return target;
+  }
+
+  uint32_t ConvertPixel(AVPixelFormat format, uint16_t pixel)
+  {
+    CPixelConverter converter(INSTRUCTION_SET::C);
+
+    uint32_t result = 0;
+    converter.Convert(format, reinterpret_cast<const uint8_t*>(&pixel), sizeof(pixel), AV_PIX_FMT_BGRA, reinterpret_cast<uint8_t*>(&result), sizeof(result), 1, 1);
+
+    return result;
+  }
+}
+
+TEST(TestPixelConverter, Supported)
+{
+  EXPECT_TRUE(CPixelConverter::IsSupported(AV_PIX_FMT_RGB565, AV_PIX_FMT_BGRA));
+  EXPECT_TRUE(CPixelConverter::IsSupported(AV_PIX_FMT_RGB555, AV_PIX_FMT_BGRA));
+  EXPECT_TRUE(CPixelConverter::IsSupported(AV_PIX_FMT_0RGB32, AV_PIX_FMT_BGRA));
+  EXPECT_FALSE(CPixelConverter::IsSupported(AV_PIX_FMT_BGRA, AV_PIX_FMT_RGB565));
+  EXPECT_FALSE(CPixelConverter::IsSupported(AV_PIX_FMT_YUV420P, AV_PIX_FMT_BGRA));
+}
+
+TEST(TestPixelConverter, ChannelExpansion)
+{
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB565, 0x0000), 0xFF000000u);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB565, 0xFFFF), 0xFFFFFFFFu);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB565, 0xF800), 0xFFFF0000u);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB565, 0x07E0), 0xFF00FF00u);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB565, 0x001F), 0xFF0000FFu);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB555, 0x7C00), 0xFFFF0000u);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB555, 0x03E0), 0xFF00FF00u);
+  EXPECT_EQ(ConvertPixel(AV_PIX_FMT_RGB555, 0x8010), 0xFF000084u);
+}
+
+TEST(TestPixelConverter, InstructionSetsMatch)
+{
+  const CPixelConverter reference(INSTRUCTION_SET::C);
+
+  for (AVPixelFormat format : { AV_PIX_FMT_RGB565, AV_PIX_FMT_RGB555, AV_PIX_FMT_0RGB32 })
+  {
+    const unsigned int sourceStride = WIDTH * BytesPerPixel(format) + 6;
+    const std::vector<uint8_t> source = GenerateFrame(sourceStride);
+    const std::vector<uint8_t> expected = ConvertFrame(reference, format, source, sourceStride);
+
+    for (INSTRUCTION_SET instructionSet : { INSTRUCTION_SET::SSE2, INSTRUCTION_SET::NEON })
+    {
+      if (!CPixelConverter::IsAvailable(instructionSet))
+        continue;
+
+      const CPixelConverter converter(instructionSet);
+      EXPECT_EQ(ConvertFrame(converter, format, source, sourceStride), expected)
+        << CPixelConverter::TranslateInstructionSet(instructionSet);
+    }
+  }
+}
+
+// Not a check, reports the per-frame cost of each conversion for comparison
+// with swscale on the target hardware. Run with --gtest_also_run_disabled_tests.
+TEST(TestPixelConverter, DISABLED_ConversionCost)
+{
+  constexpr unsigned int FRAME_COUNT = 200;
+
+  const CPixelConverter converter;
+
+  for (AVPixelFormat format : { AV_PIX_FMT_RGB565, AV_PIX_FMT_RGB555, AV_PIX_FMT_0RGB32 })
+  {
+    const unsigned int sourceStride = WIDTH * BytesPerPixel(format);
+    const std::vector<uint8_t> source = GenerateFrame(sourceStride);
+    std::vector<uint8_t> target(WIDTH * 4 * HEIGHT);
+
+    const double frameUs = CBenchmarkUtils::MeanUs(FRAME_COUNT, [&]()
+    {
+      converter.Convert(format, source.data(), sourceStride, AV_PIX_FMT_BGRA, target.data(), WIDTH * 4, WIDTH, HEIGHT);
+    });
+
+    CBenchmarkUtils::Report(std::string(CPixelConverter::TranslateInstructionSet(converter.GetInstructionSet())) +
+                            " format " + std::to_string(static_cast<int>(format)), frameUs, "us/frame");
+  }
+}
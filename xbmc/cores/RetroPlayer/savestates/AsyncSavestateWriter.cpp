@@ -0,0 +1,171 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "AsyncSavestateWriter.h"
+#include "ISavestate.h"
+#include "dialogs/GUIDialogKaiToast.h"
+#include "guilib/LocalizeStrings.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+#include "URL.h"
+
+#include <cstring>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // One request being written, and one being captured or waiting
+  constexpr size_t REQUEST_COUNT = 2;
+}
+
+CAsyncSavestateWriter::CAsyncSavestateWriter() :
+  CThread("SavestateWriter"),
+  m_idleEvent(true, true)
+{
+  // The emulator's memory is allocated by the first savestate using each
+  // request, so nothing is held for players that never save
+  for (size_t i = 0; i < REQUEST_COUNT; i++)
+    m_freeRequests.emplace_back(new Request);
+
+  Create(false);
+}
+
+CAsyncSavestateWriter::~CAsyncSavestateWriter()
+{
+  // The thread writes any pending request before exiting
+  StopThread();
+}
+
+std::unique_ptr<CAsyncSavestateWriter::Request> CAsyncSavestateWriter::GetRequest(size_t memorySize)
+{
+  std::unique_ptr<Request> request;
+
+  {
+    CSingleLock lock(m_requestMutex);
+
+    if (!m_freeRequests.empty())
+    {
+      request = std::move(m_freeRequests.back());
+      m_freeRequests.pop_back();
+    }
+  }
+
+  // Both requests are in use. Allocating another one here would stall the
+  // game thread, so the caller skips this savestate.
+  if (!request)
+    return request;
+
+  request->memoryData.resize(memorySize);
+
+  return request;
+}
+
+void CAsyncSavestateWriter::ReleaseRequest(std::unique_ptr<Request> request)
+{
+  CSingleLock lock(m_requestMutex);
+
+  if (request && m_freeRequests.size() < REQUEST_COUNT)
+    m_freeRequests.emplace_back(std::move(request));
+}
+
+void CAsyncSavestateWriter::SubmitRequest(std::unique_ptr<Request> request)
+{
+  {
+    CSingleLock lock(m_requestMutex);
+
+    if (m_pendingRequest)
+    {
+      CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Dropping savestate superseded by a newer one");
+      if (m_freeRequests.size() < REQUEST_COUNT)
+        m_freeRequests.emplace_back(std::move(m_pendingRequest));
+    }
+
+    m_pendingRequest = std::move(request);
+    m_idleEvent.Reset();
+  }
+
+  m_writeEvent.Set();
+}
+
+void CAsyncSavestateWriter::Flush()
+{
+  m_idleEvent.Wait();
+}
+
+void CAsyncSavestateWriter::Process()
+{
+  while (!m_bStop)
+  {
+    AbortableWait(m_writeEvent);
+
+    WritePendingRequests();
+  }
+
+  // Write a savestate submitted right before the thread was stopped
+  WritePendingRequests();
+}
+
+void CAsyncSavestateWriter::WritePendingRequests()
+{
+  while (true)
+  {
+    std::unique_ptr<Request> request;
+
+    {
+      CSingleLock lock(m_requestMutex);
+
+      request = std::move(m_pendingRequest);
+      if (!request)
+      {
+        m_idleEvent.Set();
+        break;
+      }
+    }
+
+    if (WriteSavestate(*request))
+    {
+      CLog::Log(LOGDEBUG, "RetroPlayer[SAVE]: Wrote savestate for %s", CURL::GetRedacted(request->gamePath).c_str());
+    }
+    else
+    {
+      CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Failed to write savestate for %s", CURL::GetRedacted(request->gamePath).c_str());
+      CGUIDialogKaiToast::QueueNotification(CGUIDialogKaiToast::Error, g_localizeStrings.Get(35268), request->gameFileName); // "Failed to save game"
+    }
+
+    {
+      CSingleLock lock(m_requestMutex);
+
+      if (m_freeRequests.size() < REQUEST_COUNT)
+        m_freeRequests.emplace_back(std::move(request));
+    }
+  }
+}
+
+bool CAsyncSavestateWriter::WriteSavestate(const Request& request)
+{
+  std::unique_ptr<ISavestate> savestate = m_savestateDatabase.CreateSavestate();
+
+  savestate->SetType(request.type);
+  savestate->SetLabel(request.label);
+  savestate->SetCreated(request.created);
+  savestate->SetGameFileName(request.gameFileName);
+  savestate->SetTimestampFrames(request.timestampFrames);
+  savestate->SetTimestampWallClock(request.timestampWallClock);
+  savestate->SetGameClientID(request.gameClientId);
+  savestate->SetGameClientVersion(request.gameClientVersion);
+  savestate->SetMemoryCompression(request.bCompressMemory);
+
+  uint8_t *memoryData = savestate->GetMemoryBuffer(request.memoryData.size());
+  std::memcpy(memoryData, request.memoryData.data(), request.memoryData.size());
+
+  savestate->Finalize();
+
+  return m_savestateDatabase.AddSavestate(request.gamePath, *savestate);
+}
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "SavestateDatabase.h"
+#include "SavestateTypes.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+#include "XBDateTime.h"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Writes savestates to disk on a background thread
+   *
+   * The caller fills a request with the savestate's properties and a copy of
+   * the emulator's memory, and submits it. Building the FlatBuffer,
+   * compression and file I/O happen on the writer thread.
+   *
+   * Two requests are kept, so that a new savestate can be captured while
+   * the previous one is being written. Their memory is allocated by the
+   * first savestates and reused afterwards. If a request is still waiting
+   * when a newer one is submitted, the older one is dropped, as it would be
+   * overwritten anyway.
+   *
+   * Failures to write are logged and shown to the user as a notification,
+   * as the caller has moved on by then.
+   */
+  class CAsyncSavestateWriter : protected CThread
+  {
+  public:
+    struct Request
+    {
+      std::string gamePath;
+      SAVE_TYPE type = SAVE_TYPE::UNKNOWN;
+      std::string label;
+      CDateTime created;
+      std::string gameFileName;
+      uint64_t timestampFrames = 0;
+      double timestampWallClock = 0.0;
+      std::string gameClientId;
+      std::string gameClientVersion;
+      bool bCompressMemory = false;
+      std::vector<uint8_t> memoryData;
+    };
+
+    /*!
+     * \brief Create a savestate writer
+     */
+    CAsyncSavestateWriter();
+
+    /*!
+     * \brief Destroy the writer, after writing any submitted savestate
+     */
+    ~CAsyncSavestateWriter() override;
+
+    /*!
+     * \brief Get a request to be filled in and submitted
+     *
+     * This never blocks on the writer thread. The emulator's memory is
+     * only allocated the first time a request is used, or when its size
+     * changed.
+     *
+     * \param memorySize The size of the emulator's memory
+     *
+     * \return A request with memoryData sized to memorySize, or empty if
+     *         both requests are in use
+     */
+    std::unique_ptr<Request> GetRequest(size_t memorySize);
+
+    /*!
+     * \brief Return a request that won't be submitted
+     */
+    void ReleaseRequest(std::unique_ptr<Request> request);
+
+    /*!
+     * \brief Queue a request to be written by the writer thread
+     */
+    void SubmitRequest(std::unique_ptr<Request> request);
+
+    /*!
+     * \brief Wait until all submitted savestates have been written
+     */
+    void Flush();
+
+  protected:
+    // implementation of CThread
+    void Process() override;
+
+  private:
+    /*!
+     * \brief Write submitted requests until none are left
+     */
+    void WritePendingRequests();
+
+    /*!
+     * \brief Serialize a request and write it to disk
+     */
+    bool WriteSavestate(const Request& request);
+
+    // Savestate functionality
+    CSavestateDatabase m_savestateDatabase;
+
+    // Requests, guarded by m_requestMutex
+    std::unique_ptr<Request> m_pendingRequest;
+    std::vector<std::unique_ptr<Request>> m_freeRequests;
+    CCriticalSection m_requestMutex;
+
+    // Synchronization
+    CEvent m_writeEvent;
+    CEvent m_idleEvent;
+  };
+}
+}
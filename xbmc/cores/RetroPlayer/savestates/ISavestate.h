@@ -117,6 +117,7 @@ namespace RETRO
     virtual void SetTimestampWallClock(double timestampWallClock) = 0;
     virtual void SetGameClientID(const std::string &gameClient) = 0;
     virtual void SetGameClientVersion(const std::string &gameClient) = 0;
+    virtual void SetMemoryCompression(bool bCompress) = 0; // Must be called before GetMemoryBuffer()
     virtual uint8_t *GetMemoryBuffer(size_t size) = 0;
     virtual void Finalize() = 0;
 
@@ -11,12 +11,34 @@
 
 #include "savestate_generated.h"
 
+#ifdef TARGET_WINDOWS_DESKTOP
+#ifdef NDEBUG
+#pragma comment(lib,"lzo2.lib")
+#elif defined _WIN64
+#pragma comment(lib, "lzo2d.lib")
+#else
+#pragma comment(lib, "lzo2-no_idb.lib")
+#endif
+#endif
+
+#include <lzo/lzo1x.h>
+
+#include <memory>
+
 using namespace KODI;
 using namespace RETRO;
 
 namespace
 {
-  const uint8_t SCHEMA_VERSION = 1;
+  const uint8_t SCHEMA_VERSION = 2;
+
+  /*!
+   * \brief The oldest schema version that can be deserialized
+   *
+   * Version 2 only added optional fields, so version 1 savestates are read as
+   * uncompressed.
+   */
+  const uint8_t MIN_SCHEMA_VERSION = 1;
 
   /*!
    * \brief The initial size of the FlatBuffer's memory buffer
@@ -61,6 +83,14 @@ namespace
 
     return SAVE_TYPE::UNKNOWN;
   }
+
+  /*!
+   * \brief Worst-case size of LZO1X output for the given input size
+   */
+  size_t MaxCompressedSize(size_t size)
+  {
+    return size + size / 16 + 64 + 3;
+  }
 }
 
 CSavestateFlatBuffer::CSavestateFlatBuffer()
@@ -74,7 +104,9 @@ void CSavestateFlatBuffer::Reset()
 {
   m_builder.reset(new flatbuffers::FlatBufferBuilder(INITIAL_FLATBUFFER_SIZE));
   m_data.clear();
+  m_memoryData.clear();
   m_savestate = nullptr;
+  m_bCompressMemory = false;
 }
 
 bool CSavestateFlatBuffer::Serialize(const uint8_t *&data, size_t &size) const
@@ -218,8 +250,16 @@ void CSavestateFlatBuffer::SetGameClientVersion(const std::string &gameClientVer
   m_emulatorVersionOffset.reset(new StringOffset{ m_builder->CreateString(gameClientVersion) });
 }
 
+void CSavestateFlatBuffer::SetMemoryCompression(bool bCompress)
+{
+  m_bCompressMemory = bCompress;
+}
+
 const uint8_t *CSavestateFlatBuffer::GetMemoryData() const
 {
+  if (!m_memoryData.empty())
+    return m_memoryData.data();
+
   if (m_savestate != nullptr && m_savestate->memory_data())
     return m_savestate->memory_data()->data();
 
@@ -228,6 +268,9 @@ const uint8_t *CSavestateFlatBuffer::GetMemoryData() const
 
 size_t CSavestateFlatBuffer::GetMemorySize() const
 {
+  if (!m_memoryData.empty())
+    return m_memoryData.size();
+
   if (m_savestate != nullptr && m_savestate->memory_data())
     return m_savestate->memory_data()->size();
 
@@ -236,6 +279,13 @@ size_t CSavestateFlatBuffer::GetMemorySize() const
 
 uint8_t *CSavestateFlatBuffer::GetMemoryBuffer(size_t size)
 {
+  // Stage the memory until Finalize() knows its compressed size
+  if (m_bCompressMemory)
+  {
+    m_memoryData.resize(size);
+    return m_memoryData.data();
+  }
+
   uint8_t *memoryBuffer = nullptr;
 
   m_memoryDataOffset.reset(new VectorOffset{ m_builder->CreateUninitializedVector(size, &memoryBuffer) });
@@ -245,6 +295,31 @@ uint8_t *CSavestateFlatBuffer::GetMemoryBuffer(size_t size)
 
 void CSavestateFlatBuffer::Finalize()
 {
+  MemoryCompression memoryCompression = MemoryCompression_None;
+
+  // Vectors must be created before the table is started
+  if (m_bCompressMemory && !m_memoryData.empty())
+  {
+    std::vector<uint8_t> compressedData(MaxCompressedSize(m_memoryData.size()));
+    std::unique_ptr<uint8_t[]> workMemory(new uint8_t[LZO1X_1_MEM_COMPRESS]);
+
+    lzo_uint compressedSize = 0;
+    if (lzo_init() == LZO_E_OK &&
+        lzo1x_1_compress(m_memoryData.data(), m_memoryData.size(),
+                         compressedData.data(), &compressedSize,
+                         workMemory.get()) == LZO_E_OK &&
+        compressedSize < m_memoryData.size())
+    {
+      m_memoryDataOffset.reset(new VectorOffset{ m_builder->CreateVector(compressedData.data(), compressedSize) });
+      memoryCompression = MemoryCompression_Lzo;
+    }
+    else
+    {
+      // Incompressible, store it as-is
+      m_memoryDataOffset.reset(new VectorOffset{ m_builder->CreateVector(m_memoryData) });
+    }
+  }
+
   // Helper class to build the nested Savestate table
   SavestateBuilder savestateBuilder(*m_builder);
 
@@ -295,6 +370,11 @@ void CSavestateFlatBuffer::Finalize()
     m_memoryDataOffset.reset();
   }
 
+  savestateBuilder.add_memory_compression(memoryCompression);
+
+  if (memoryCompression != MemoryCompression_None)
+    savestateBuilder.add_memory_size(m_memoryData.size());
+
   auto savestate = savestateBuilder.Finish();
   FinishSavestateBuffer(*m_builder, savestate);
 
@@ -308,19 +388,69 @@ bool CSavestateFlatBuffer::Deserialize(std::vector<uint8_t> data)
   {
     const Savestate *savestate = GetSavestate(data.data());
 
-    if (savestate->version() != SCHEMA_VERSION)
+    if (savestate->version() < MIN_SCHEMA_VERSION || savestate->version() > SCHEMA_VERSION)
     {
-      CLog::Log(LOGERROR, "RetroPlayer[SAVE): Schema version %u not supported, must be version %u",
+      CLog::Log(LOGERROR, "RetroPlayer[SAVE): Schema version %u not supported, must be version %u to %u",
         savestate->version(),
+        MIN_SCHEMA_VERSION,
         SCHEMA_VERSION);
     }
     else
     {
       m_data = std::move(data);
+      m_memoryData.clear();
       m_savestate = GetSavestate(m_data.data());
-      return true;
+
+      if (m_savestate->memory_compression() == MemoryCompression_None)
+        return true;
+
+      if (DecompressMemory())
+        return true;
+
+      m_data.clear();
+      m_savestate = nullptr;
     }
   }
 
   return false;
 }
+
+bool CSavestateFlatBuffer::DecompressMemory()
+{
+  if (m_savestate->memory_compression() != MemoryCompression_Lzo)
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Unknown memory compression %u",
+      m_savestate->memory_compression());
+    return false;
+  }
+
+  const auto memoryData = m_savestate->memory_data();
+  const uint64_t memorySize = m_savestate->memory_size();
+
+  if (memoryData == nullptr || memorySize == 0)
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Compressed savestate has no memory");
+    return false;
+  }
+
+  if (lzo_init() != LZO_E_OK)
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Failed to initialize LZO");
+    return false;
+  }
+
+  m_memoryData.resize(static_cast<size_t>(memorySize));
+
+  lzo_uint decompressedSize = m_memoryData.size();
+  const int result = lzo1x_decompress_safe(memoryData->data(), memoryData->size(),
+                                           m_memoryData.data(), &decompressedSize,
+                                           nullptr);
+  if (result != LZO_E_OK || decompressedSize != m_memoryData.size())
+  {
+    CLog::Log(LOGERROR, "RetroPlayer[SAVE]: Failed to decompress memory (error %d)", result);
+    m_memoryData.clear();
+    return false;
+  }
+
+  return true;
+}
@@ -55,11 +55,17 @@ namespace RETRO
     void SetTimestampWallClock(double timestampWallClock) override;
     void SetGameClientID(const std::string &gameClient) override;
     void SetGameClientVersion(const std::string &gameClient) override;
+    void SetMemoryCompression(bool bCompress) override;
     uint8_t *GetMemoryBuffer(size_t size) override;
     void Finalize() override;
     bool Deserialize(std::vector<uint8_t> data) override;
 
   private:
+    /*!
+     * \brief Decompress memory_data into m_memoryData
+     */
+    bool DecompressMemory();
+
     /*!
      * \brief Helper class to hold data needed in creation of a FlatBuffer
      *
@@ -74,6 +80,15 @@ namespace RETRO
      */
     std::vector<uint8_t> m_data;
 
+    /*!
+     * \brief Uncompressed memory
+     *
+     * When serializing with compression, the memory is staged here until
+     * Finalize() compresses it into the FlatBuffer. When deserializing a
+     * compressed savestate, the memory is decompressed here.
+     */
+    std::vector<uint8_t> m_memoryData;
+
     /*!
      * \brief FlatBuffer struct used for accessing data
      */
@@ -93,6 +108,7 @@ namespace RETRO
     std::unique_ptr<StringOffset> m_emulatorAddonIdOffset;
     std::unique_ptr<StringOffset> m_emulatorVersionOffset;
     std::unique_ptr<VectorOffset> m_memoryDataOffset;
+    bool m_bCompressMemory = false;
   };
 }
 }
@@ -12,6 +12,7 @@
 //#include "RetroPlayerHardwareBuffer.h" //! @todo
 //#include "RetroPlayerSoftwareBuffer.h" //! @todo
 #include "RetroPlayerVideo.h"
+#include "threads/SingleLock.h"
 
 using namespace KODI;
 using namespace RETRO;
@@ -24,8 +25,24 @@ CRPStreamManager::CRPStreamManager(CRPRenderManager& renderManager, CRPProcessIn
 
 void CRPStreamManager::EnableAudio(bool bEnable)
 {
-  if (m_audioStream != nullptr)
-    m_audioStream->Enable(bEnable);
+  CSingleLock lock(m_audioMutex);
+
+  m_bAudioEnabled = bEnable;
+  UpdateAudio();
+}
+
+void CRPStreamManager::SuppressOutput(bool bSuppressVideo, bool bSuppressAudio)
+{
+  CSingleLock lock(m_audioMutex);
+
+  if (m_videoStream != nullptr)
+    m_videoStream->Enable(!bSuppressVideo);
+
+  if (m_bAudioSuppressed != bSuppressAudio)
+  {
+    m_bAudioSuppressed = bSuppressAudio;
+    UpdateAudio();
+  }
 }
 
 StreamPtr CRPStreamManager::CreateStream(StreamType streamType)
@@ -34,15 +51,23 @@ StreamPtr CRPStreamManager::CreateStream(StreamType streamType)
   {
   case StreamType::AUDIO:
   {
+    CSingleLock lock(m_audioMutex);
+
     // Save pointer to audio stream
     m_audioStream = new CRetroPlayerAudio(m_processInfo);
+    UpdateAudio();
 
     return StreamPtr(m_audioStream);
   }
   case StreamType::VIDEO:
   case StreamType::SW_BUFFER:
   {
-    return StreamPtr(new CRetroPlayerVideo(m_renderManager, m_processInfo));
+    CSingleLock lock(m_audioMutex);
+
+    // Save pointer to video stream
+    m_videoStream = new CRetroPlayerVideo(m_renderManager, m_processInfo);
+
+    return StreamPtr(m_videoStream);
   }
   case StreamType::HW_BUFFER:
   {
@@ -59,9 +84,21 @@ void CRPStreamManager::CloseStream(StreamPtr stream)
 {
   if (stream)
   {
-    if (stream.get() == m_audioStream)
-      m_audioStream = nullptr;
+    {
+      CSingleLock lock(m_audioMutex);
+
+      if (stream.get() == m_audioStream)
+        m_audioStream = nullptr;
+      else if (stream.get() == m_videoStream)
+        m_videoStream = nullptr;
+    }
 
     stream->CloseStream();
   }
 }
+
+void CRPStreamManager::UpdateAudio()
+{
+  if (m_audioStream != nullptr)
+    m_audioStream->Enable(m_bAudioEnabled && !m_bAudioSuppressed);
+}
@@ -9,12 +9,14 @@
 #pragma once
 
 #include "IStreamManager.h"
+#include "threads/CriticalSection.h"
 
 namespace KODI
 {
 namespace RETRO
 {
   class CRetroPlayerAudio;
+  class CRetroPlayerVideo;
   class CRPProcessInfo;
   class CRPRenderManager;
 
@@ -26,17 +28,31 @@ namespace RETRO
 
     void EnableAudio(bool bEnable);
 
+    /*!
+     * \brief Discard the output of frames that are run but not presented
+     *
+     * This is used when running ahead, and is independent of EnableAudio().
+     */
+    void SuppressOutput(bool bSuppressVideo, bool bSuppressAudio);
+
     // Implementation of IStreamManager
     StreamPtr CreateStream(StreamType streamType) override;
     void CloseStream(StreamPtr stream) override;
 
   private:
+    // Must be called with m_audioMutex held
+    void UpdateAudio();
+
     // Construction parameters
     CRPRenderManager& m_renderManager;
     CRPProcessInfo& m_processInfo;
 
     // Stream parameters
     CRetroPlayerAudio* m_audioStream = nullptr;
+    CRetroPlayerVideo* m_videoStream = nullptr;
+    bool m_bAudioEnabled = true; // Set by the player thread
+    bool m_bAudioSuppressed = false; // Set by the game thread
+    CCriticalSection m_audioMutex; // Also guards m_videoStream
   };
 }
 }
@@ -10,18 +10,25 @@
 #include "cores/AudioEngine/Interfaces/AE.h"
 #include "cores/AudioEngine/Interfaces/AEStream.h"
 #include "cores/AudioEngine/Utils/AEChannelInfo.h"
+#include "cores/AudioEngine/Utils/AEStreamData.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/RetroPlayer/audio/AudioTranslator.h"
 #include "cores/RetroPlayer/process/RPProcessInfo.h"
+#include "games/GameServices.h"
+#include "games/GameSettings.h"
 #include "utils/log.h"
 #include "ServiceBroker.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace KODI;
 using namespace RETRO;
 
 const double MAX_DELAY = 0.3; // seconds
+const double TARGET_DELAY = 0.08; // seconds, used by rate control
+const double MAX_RATE_ADJUST = 0.01; // Maximum deviation of the resample ratio
+const double DELAY_SMOOTHING = 0.05; // Weight of a new delay measurement
 
 CRetroPlayerAudio::CRetroPlayerAudio(CRPProcessInfo& processInfo) :
   m_processInfo(processInfo),
@@ -89,7 +96,16 @@ bool CRetroPlayerAudio::OpenStream(const StreamProperties& properties)
   audioFormat.m_dataFormat = pcmFormat;
   audioFormat.m_sampleRate = iSampleRate;
   audioFormat.m_channelLayout = channelLayout;
-  m_pAudioStream = audioEngine->MakeStream(audioFormat);
+  // Rate control needs the resampler, even if the sample rates match
+  m_bRateControl = CServiceBroker::GetGameServices().GameSettings().SyncToDisplay();
+  m_averageDelaySecs = TARGET_DELAY;
+
+  // Games react to input, so keep the audio buffers short
+  unsigned int options = AESTREAM_LOW_LATENCY;
+  if (m_bRateControl)
+    options |= AESTREAM_FORCE_RESAMPLE;
+
+  m_pAudioStream = audioEngine->MakeStream(audioFormat, options);
 
   if (m_pAudioStream == nullptr)
   {
@@ -122,6 +138,11 @@ void CRetroPlayerAudio::AddStreamData(const StreamPacket &packet)
       {
         m_pAudioStream->Flush();
         CLog::Log(LOGDEBUG, "RetroPlayer[AUDIO]: Audio delay (%0.2f ms) is too high - flushing", delaySecs * 1000);
+        m_averageDelaySecs = TARGET_DELAY;
+      }
+      else if (m_bRateControl)
+      {
+        UpdateRateControl(delaySecs);
       }
 
       m_pAudioStream->AddData(&audioPacket.data, 0, frameCount, nullptr);
@@ -129,6 +150,18 @@ void CRetroPlayerAudio::AddStreamData(const StreamPacket &packet)
   }
 }
 
+void CRetroPlayerAudio::UpdateRateControl(double delaySecs)
+{
+  // The delay moves in steps as the sink consumes periods, so smooth it
+  m_averageDelaySecs += (delaySecs - m_averageDelaySecs) * DELAY_SMOOTHING;
+
+  // A ratio below 1.0 produces fewer samples, which drains the buffer
+  double error = (m_averageDelaySecs - TARGET_DELAY) / TARGET_DELAY;
+  error = std::max(-1.0, std::min(error, 1.0));
+
+  m_pAudioStream->SetResampleRatio(1.0 - MAX_RATE_ADJUST * error);
+}
+
 void CRetroPlayerAudio::CloseStream()
 {
   if (m_pAudioStream)
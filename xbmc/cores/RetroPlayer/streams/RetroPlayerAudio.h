@@ -10,6 +10,7 @@
 
 #include "IRetroPlayerStream.h"
 
+#include <atomic>
 #include <memory>
 
 class IAEStream;
@@ -61,9 +62,21 @@ namespace RETRO
     void CloseStream() override;
 
   private:
+    /*!
+     * \brief Adjust the resample ratio to keep the audio delay near its target
+     *
+     * This absorbs small differences between the game's audio clock and the
+     * rate at which frames are run, e.g. when frames are synced to the display.
+     */
+    void UpdateRateControl(double delaySecs);
+
     CRPProcessInfo& m_processInfo;
     IAEStream* m_pAudioStream;
-    bool m_bAudioEnabled;
+    std::atomic<bool> m_bAudioEnabled;
+
+    // Rate control
+    bool m_bRateControl = false;
+    double m_averageDelaySecs = 0.0;
   };
 }
 }
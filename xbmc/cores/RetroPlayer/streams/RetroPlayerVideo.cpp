@@ -69,7 +69,7 @@ bool CRetroPlayerVideo::GetStreamBuffer(unsigned int width, unsigned int height,
 {
   VideoStreamBuffer& videoBuffer = static_cast<VideoStreamBuffer&>(buffer);
 
-  if (m_bOpen)
+  if (m_bOpen && m_bVideoEnabled)
   {
     return m_renderManager.GetVideoBuffer(width,
                                           height,
@@ -85,7 +85,7 @@ void CRetroPlayerVideo::AddStreamData(const StreamPacket &packet)
 {
   const VideoStreamPacket& videoPacket = static_cast<const VideoStreamPacket&>(packet);
 
-  if (m_bOpen)
+  if (m_bOpen && m_bVideoEnabled)
   {
     unsigned int orientationDegCCW = 0;
     switch (videoPacket.rotation)
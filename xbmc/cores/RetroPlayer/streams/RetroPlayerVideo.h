@@ -77,6 +77,8 @@ namespace RETRO
     CRetroPlayerVideo(CRPRenderManager& m_renderManager, CRPProcessInfo& m_processInfo);
     ~CRetroPlayerVideo() override;
 
+    void Enable(bool bEnabled) { m_bVideoEnabled = bEnabled; }
+
     // implementation of IRetroPlayerStream
     bool OpenStream(const StreamProperties& properties) override;
     bool GetStreamBuffer(unsigned int width, unsigned int height, StreamBuffer& buffer) override;
@@ -90,6 +92,7 @@ namespace RETRO
 
     // Stream properties
     bool m_bOpen = false;
+    bool m_bVideoEnabled = true;
   };
 }
 }
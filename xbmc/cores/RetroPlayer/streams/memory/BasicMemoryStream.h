@@ -29,6 +29,7 @@ namespace RETRO
     virtual size_t FrameSize() const override { return m_frameSize; }
     virtual uint64_t MaxFrameCount() const override { return 1; }
     virtual void SetMaxFrameCount(uint64_t maxFrameCount) override { }
+    virtual void SetMaxMemorySize(size_t maxMemorySize) override { }
     virtual uint8_t* BeginFrame() override;
     virtual void SubmitFrame() override;
     virtual const uint8_t* CurrentFrame() const override;
@@ -36,6 +37,7 @@ namespace RETRO
     virtual uint64_t AdvanceFrames(uint64_t frameCount) override { return 0; }
     virtual uint64_t PastFramesAvailable() const override { return 0; }
     virtual uint64_t RewindFrames(uint64_t frameCount) override { return 0; }
+    virtual bool SeekToFrame(uint64_t frameHistoryCount) override { return false; }
     virtual uint64_t GetFrameCounter() const override { return 0; }
     virtual void SetFrameCounter(uint64_t frameCount) override { };
 
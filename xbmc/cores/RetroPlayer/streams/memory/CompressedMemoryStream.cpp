@@ -0,0 +1,557 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "CompressedMemoryStream.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#ifdef TARGET_WINDOWS_DESKTOP
+#ifdef NDEBUG
+#pragma comment(lib,"lzo2.lib")
+#elif defined _WIN64
+#pragma comment(lib, "lzo2d.lib")
+#else
+#pragma comment(lib, "lzo2-no_idb.lib")
+#endif
+#endif
+
+#include <lzo/lzo1x.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // Compressed frames are packed into slabs of this size
+  constexpr size_t SLAB_SIZE = 1024 * 1024;
+
+  // Keyframes may use up to 1/KEYFRAME_BUDGET_DIVISOR of the memory budget
+  constexpr size_t KEYFRAME_BUDGET_DIVISOR = 4;
+
+  // Restoring a keyframe costs about as much as applying this many deltas
+  constexpr uint64_t KEYFRAME_RESTORE_COST = 8;
+
+  // Keyframes are spaced at most this many frames apart, 10 seconds at 60 fps.
+  // Under a small budget the keyframes make the budget cull old frames sooner
+  // rather than making seeks apply more deltas
+  constexpr uint64_t MAX_KEYFRAME_INTERVAL = 600;
+
+  // Worst-case size of LZO1X output for the given input size
+  constexpr size_t MaxCompressedSize(size_t size)
+  {
+    return size + size / 16 + 64 + 3;
+  }
+}
+
+CCompressedMemoryStream::CCompressedMemoryStream(uint64_t uncompressedFrameCount, uint64_t keyframeInterval) :
+  CThread("RewindCompressor"),
+  m_uncompressedFrameCount(uncompressedFrameCount),
+  m_keyframeInterval(keyframeInterval),
+  m_arena(SLAB_SIZE),
+  m_compressWorkMemory(new uint8_t[LZO1X_1_MEM_COMPRESS])
+{
+  if (lzo_init() != LZO_E_OK)
+    CLog::Log(LOGERROR, "CCompressedMemoryStream: Failed to initialize LZO");
+
+  Create();
+}
+
+CCompressedMemoryStream::~CCompressedMemoryStream()
+{
+  StopThread();
+}
+
+void CCompressedMemoryStream::Reset()
+{
+  CSingleLock lock(m_streamMutex);
+
+  CDeltaRunMemoryStream::Reset();
+
+  m_compressedFrames.clear();
+  m_keyframes.clear();
+  m_spareKeyframe.reset();
+  m_arena.Clear();
+  m_generation++;
+}
+
+void CCompressedMemoryStream::SetMaxMemorySize(size_t maxMemorySize)
+{
+  CSingleLock lock(m_streamMutex);
+
+  m_maxMemorySize = maxMemorySize;
+
+  EnforceMemoryBudget();
+}
+
+uint64_t CCompressedMemoryStream::PastFramesAvailable() const
+{
+  CSingleLock lock(m_streamMutex);
+
+  return CDeltaRunMemoryStream::PastFramesAvailable() + static_cast<uint64_t>(m_compressedFrames.size());
+}
+
+uint64_t CCompressedMemoryStream::RewindFrames(uint64_t frameCount)
+{
+  CSingleLock lock(m_streamMutex);
+
+  uint64_t rewound;
+
+  for (rewound = 0; rewound < frameCount; rewound++)
+  {
+    if (!m_rewindBuffer.empty())
+    {
+      CDeltaRunMemoryStream::RewindFrames(1);
+
+      // The worker may be compressing the frame that was just rewound
+      if (m_rewindBuffer.empty())
+        m_generation++;
+    }
+    else if (!m_compressedFrames.empty())
+    {
+      RewindCompressedFrame();
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  // Keyframes ahead of the current frame are no longer reachable
+  m_keyframes.erase(m_keyframes.upper_bound(m_currentFrameHistory), m_keyframes.end());
+
+  return rewound;
+}
+
+bool CCompressedMemoryStream::SeekToFrame(uint64_t frameHistoryCount)
+{
+  CSingleLock lock(m_streamMutex);
+
+  if (frameHistoryCount >= m_currentFrameHistory)
+    return frameHistoryCount == m_currentFrameHistory;
+
+  // Use the oldest keyframe at or after the target, if it saves enough work.
+  // Keyframes are cleared by SetFrameCounter(), so the history between a
+  // keyframe and the current frame is contiguous.
+  auto it = m_keyframes.lower_bound(frameHistoryCount);
+  if (it != m_keyframes.end() && m_currentFrameHistory - it->first > KEYFRAME_RESTORE_COST)
+  {
+    const uint64_t keyframeHistory = it->first;
+
+    if (RestoreKeyframe(it->second))
+    {
+      DiscardFrames(m_currentFrameHistory - keyframeHistory);
+      m_currentFrameHistory = keyframeHistory;
+      m_keyframes.erase(m_keyframes.upper_bound(keyframeHistory), m_keyframes.end());
+    }
+  }
+
+  return CDeltaRunMemoryStream::SeekToFrame(frameHistoryCount);
+}
+
+void CCompressedMemoryStream::SetFrameCounter(uint64_t frameCount)
+{
+  CSingleLock lock(m_streamMutex);
+
+  // Keyframes are located by history, which is no longer contiguous
+  m_keyframes.clear();
+
+  CDeltaRunMemoryStream::SetFrameCounter(frameCount);
+}
+
+size_t CCompressedMemoryStream::MemoryUsage() const
+{
+  CSingleLock lock(m_streamMutex);
+
+  size_t usage = UncompressedMemoryUsage() + m_arena.Capacity();
+
+  for (const auto& keyframe : m_keyframes)
+    usage += keyframe.second.data->capacity();
+
+  if (m_spareKeyframe)
+    usage += m_spareKeyframe->capacity();
+
+  return usage;
+}
+
+uint64_t CCompressedMemoryStream::CompressedFramesAvailable() const
+{
+  CSingleLock lock(m_streamMutex);
+
+  return static_cast<uint64_t>(m_compressedFrames.size());
+}
+
+void CCompressedMemoryStream::Flush()
+{
+  while (CompressNext())
+  {
+  }
+}
+
+void CCompressedMemoryStream::SubmitFrameInternal()
+{
+  {
+    CSingleLock lock(m_streamMutex);
+
+    CDeltaRunMemoryStream::SubmitFrameInternal();
+
+    bool bAddedKeyframe = false;
+
+    const uint64_t keyframeInterval = KeyframeInterval();
+    if (keyframeInterval > 0 && m_currentFrameHistory % keyframeInterval == 0)
+    {
+      AddKeyframe();
+      bAddedKeyframe = true;
+    }
+
+    EnforceMemoryBudget();
+
+    if (m_rewindBuffer.size() <= m_uncompressedFrameCount && !bAddedKeyframe)
+      return;
+  }
+
+  m_compressEvent.Set();
+}
+
+void CCompressedMemoryStream::CullPastFrames(uint64_t frameCount)
+{
+  CSingleLock lock(m_streamMutex);
+
+  uint64_t removedCount;
+
+  // Compressed frames are the oldest, so cull them first
+  for (removedCount = 0; removedCount < frameCount; removedCount++)
+  {
+    if (m_compressedFrames.empty())
+      break;
+
+    if (m_compressedFrames.front().dataSize > 0)
+      m_arena.PopFront();
+
+    m_compressedFrames.pop_front();
+  }
+
+  if (removedCount < frameCount)
+  {
+    CDeltaRunMemoryStream::CullPastFrames(frameCount - removedCount);
+    m_generation++;
+  }
+
+  CullKeyframes();
+}
+
+void CCompressedMemoryStream::Process()
+{
+  SetPriority(GetMinPriority());
+
+  while (!m_bStop)
+  {
+    AbortableWait(m_compressEvent);
+
+    while (!m_bStop && CompressNext())
+    {
+    }
+  }
+}
+
+bool CCompressedMemoryStream::CompressNext()
+{
+  CSingleLock lock(m_compressMutex);
+
+  return CompressFrame() || CompressKeyframe();
+}
+
+bool CCompressedMemoryStream::CompressFrame()
+{
+  unsigned int generation;
+  uint64_t frameHistoryCount;
+
+  // Copy the oldest uncompressed frame so that the game thread isn't blocked
+  // while it's being compressed
+  {
+    CSingleLock lock(m_streamMutex);
+
+    if (m_rewindBuffer.size() <= m_uncompressedFrameCount)
+      return false;
+
+    const MemoryFrame& frame = m_rewindBuffer.front();
+
+    m_workBuffer.assign(frame.buffer.begin(), frame.buffer.end());
+    frameHistoryCount = frame.frameHistoryCount;
+    generation = m_generation;
+  }
+
+  const size_t deltaBytes = m_workBuffer.size() * sizeof(uint32_t);
+
+  m_compressBuffer.resize(MaxCompressedSize(deltaBytes));
+
+  lzo_uint compressedSize = 0;
+  bool bCompressed = false;
+
+  if (deltaBytes > 0)
+  {
+    const int result = lzo1x_1_compress(reinterpret_cast<lzo_bytep>(m_workBuffer.data()), deltaBytes,
+                                        m_compressBuffer.data(), &compressedSize,
+                                        m_compressWorkMemory.get());
+    bCompressed = (result == LZO_E_OK && compressedSize < deltaBytes);
+  }
+
+  const uint8_t* data = bCompressed ? m_compressBuffer.data() : reinterpret_cast<const uint8_t*>(m_workBuffer.data());
+  const size_t dataSize = bCompressed ? static_cast<size_t>(compressedSize) : deltaBytes;
+
+  CSingleLock lock(m_streamMutex);
+
+  // Discard the result if the frame was rewound or culled in the meantime
+  if (generation != m_generation || m_rewindBuffer.size() <= m_uncompressedFrameCount)
+    return true;
+
+  CompressedFrame compressedFrame{ nullptr, dataSize, m_workBuffer.size(), bCompressed, frameHistoryCount };
+
+  if (dataSize > 0)
+  {
+    uint8_t* block = m_arena.PushBack(dataSize);
+    std::memcpy(block, data, dataSize);
+    compressedFrame.data = block;
+  }
+
+  m_compressedFrames.emplace_back(compressedFrame);
+
+  RecycleBuffer(std::move(m_rewindBuffer.front().buffer));
+  m_rewindBuffer.pop_front();
+
+  return true;
+}
+
+bool CCompressedMemoryStream::CompressKeyframe()
+{
+  uint64_t keyframeHistory;
+  std::shared_ptr<std::vector<uint8_t>> keyframeData;
+
+  {
+    CSingleLock lock(m_streamMutex);
+
+    auto it = std::find_if(m_keyframes.begin(), m_keyframes.end(),
+      [](const std::pair<const uint64_t, Keyframe>& keyframe)
+      {
+        return keyframe.second.state == KeyframeState::UNCOMPRESSED;
+      });
+
+    if (it == m_keyframes.end())
+      return false;
+
+    keyframeHistory = it->first;
+    keyframeData = it->second.data;
+  }
+
+  // Keyframe data is immutable, so it can be read without holding the lock
+  m_compressBuffer.resize(MaxCompressedSize(keyframeData->size()));
+
+  lzo_uint compressedSize = 0;
+  const int result = lzo1x_1_compress(keyframeData->data(), keyframeData->size(),
+                                      m_compressBuffer.data(), &compressedSize,
+                                      m_compressWorkMemory.get());
+  const bool bCompressed = (result == LZO_E_OK && compressedSize < keyframeData->size());
+
+  std::shared_ptr<std::vector<uint8_t>> compressedData;
+  if (bCompressed)
+    compressedData = std::make_shared<std::vector<uint8_t>>(m_compressBuffer.begin(), m_compressBuffer.begin() + compressedSize);
+
+  CSingleLock lock(m_streamMutex);
+
+  // Discard the result if the keyframe was removed in the meantime
+  auto it = m_keyframes.find(keyframeHistory);
+  if (it == m_keyframes.end() || it->second.data != keyframeData)
+    return true;
+
+  if (bCompressed)
+  {
+    it->second.data = std::move(compressedData);
+    it->second.state = KeyframeState::COMPRESSED;
+
+    if (keyframeData.use_count() == 1)
+      m_spareKeyframe = std::move(keyframeData);
+  }
+  else
+  {
+    it->second.state = KeyframeState::INCOMPRESSIBLE;
+  }
+
+  return true;
+}
+
+void CCompressedMemoryStream::RewindCompressedFrame()
+{
+  const CompressedFrame& frame = m_compressedFrames.back();
+
+  m_decompressBuffer.resize(frame.deltaSize);
+
+  bool bSuccess = true;
+
+  if (frame.bCompressed)
+  {
+    lzo_uint deltaBytes = frame.deltaSize * sizeof(uint32_t);
+    const int result = lzo1x_decompress_safe(frame.data, frame.dataSize,
+                                             reinterpret_cast<lzo_bytep>(m_decompressBuffer.data()), &deltaBytes,
+                                             nullptr);
+    if (result != LZO_E_OK || deltaBytes != frame.deltaSize * sizeof(uint32_t))
+    {
+      CLog::Log(LOGERROR, "CCompressedMemoryStream: Failed to decompress frame (error %d)", result);
+      bSuccess = false;
+    }
+  }
+  else if (frame.dataSize > 0)
+  {
+    std::memcpy(m_decompressBuffer.data(), frame.data, frame.dataSize);
+  }
+
+  if (bSuccess)
+    ApplyDelta(m_decompressBuffer, m_currentFrame.get());
+
+  // Restore frame history
+  m_currentFrameHistory = frame.frameHistoryCount;
+
+  if (frame.dataSize > 0)
+    m_arena.PopBack(frame.dataSize);
+
+  m_compressedFrames.pop_back();
+}
+
+void CCompressedMemoryStream::DiscardFrames(uint64_t frameCount)
+{
+  for (uint64_t discarded = 0; discarded < frameCount; discarded++)
+  {
+    if (!m_rewindBuffer.empty())
+    {
+      RecycleBuffer(std::move(m_rewindBuffer.back().buffer));
+      m_rewindBuffer.pop_back();
+
+      if (m_rewindBuffer.empty())
+        m_generation++;
+    }
+    else if (!m_compressedFrames.empty())
+    {
+      if (m_compressedFrames.back().dataSize > 0)
+        m_arena.PopBack(m_compressedFrames.back().dataSize);
+
+      m_compressedFrames.pop_back();
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+void CCompressedMemoryStream::AddKeyframe()
+{
+  std::shared_ptr<std::vector<uint8_t>> data = std::move(m_spareKeyframe);
+
+  if (data)
+    data->resize(FrameSize());
+  else
+    data = std::make_shared<std::vector<uint8_t>>(FrameSize());
+
+  std::memcpy(data->data(), CurrentFrame(), FrameSize());
+
+  m_keyframes[m_currentFrameHistory] = Keyframe{ std::move(data), KeyframeState::UNCOMPRESSED };
+}
+
+bool CCompressedMemoryStream::RestoreKeyframe(const Keyframe& keyframe)
+{
+  uint8_t* currentFrame = reinterpret_cast<uint8_t*>(m_currentFrame.get());
+
+  if (keyframe.state == KeyframeState::COMPRESSED)
+  {
+    lzo_uint frameSize = FrameSize();
+    const int result = lzo1x_decompress_safe(keyframe.data->data(), keyframe.data->size(),
+                                             currentFrame, &frameSize,
+                                             nullptr);
+    if (result != LZO_E_OK || frameSize != FrameSize())
+    {
+      CLog::Log(LOGERROR, "CCompressedMemoryStream: Failed to decompress keyframe (error %d)", result);
+      return false;
+    }
+  }
+  else
+  {
+    std::memcpy(currentFrame, keyframe.data->data(), FrameSize());
+  }
+
+  return true;
+}
+
+void CCompressedMemoryStream::CullKeyframes()
+{
+  m_keyframes.erase(m_keyframes.begin(), m_keyframes.lower_bound(OldestFrameHistory()));
+}
+
+uint64_t CCompressedMemoryStream::KeyframeInterval() const
+{
+  uint64_t keyframeInterval = m_keyframeInterval;
+
+  // Assume the worst case of incompressible keyframes
+  if (keyframeInterval > 0 && m_maxMemorySize > 0 && FrameSize() > 0)
+  {
+    const uint64_t maxKeyframes = std::max<uint64_t>(m_maxMemorySize / KEYFRAME_BUDGET_DIVISOR / FrameSize(), 1);
+    keyframeInterval = std::max(keyframeInterval, std::min(MaxFrameCount() / maxKeyframes, MAX_KEYFRAME_INTERVAL));
+  }
+
+  return keyframeInterval;
+}
+
+uint64_t CCompressedMemoryStream::OldestFrameHistory() const
+{
+  if (!m_compressedFrames.empty())
+    return m_compressedFrames.front().frameHistoryCount;
+
+  if (!m_rewindBuffer.empty())
+    return m_rewindBuffer.front().frameHistoryCount;
+
+  return m_currentFrameHistory;
+}
+
+void CCompressedMemoryStream::EnforceMemoryBudget()
+{
+  if (m_maxMemorySize == 0)
+    return;
+
+  // Buffers kept for reuse are dropped before any frames. Culled frames
+  // return their buffer, so it is dropped in the next iteration.
+  while (MemoryUsage() > m_maxMemorySize)
+  {
+    if (!m_freeBuffers.empty())
+      m_freeBuffers.pop_back();
+    else if (m_spareKeyframe)
+      m_spareKeyframe.reset();
+    else if (PastFramesAvailable() > 0)
+      CullPastFrames(1);
+    else
+      break;
+  }
+}
+
+size_t CCompressedMemoryStream::UncompressedMemoryUsage() const
+{
+  size_t usage = 0;
+
+  for (const MemoryFrame& frame : m_rewindBuffer)
+    usage += frame.buffer.capacity() * sizeof(uint32_t);
+
+  for (const DeltaRunBuffer& buffer : m_freeBuffers)
+    usage += buffer.capacity() * sizeof(uint32_t);
+
+  // Current and next frame
+  if (m_currentFrame)
+    usage += m_paddedFrameSize;
+  if (m_nextFrame)
+    usage += m_paddedFrameSize;
+
+  return usage;
+}
@@ -0,0 +1,189 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "DeltaRunMemoryStream.h"
+#include "SlabArena.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/Thread.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Linear memory stream that compresses old deltas in the background
+   *
+   * The most recent frames are kept as plain run-length deltas (see
+   * CDeltaRunMemoryStream) so that short rewinds and seek-bar scrubbing stay
+   * instant. Older frames are LZO-compressed by a low-priority worker thread
+   * and stored in a slab arena.
+   *
+   * In addition to the max frame count, the stream can be bounded by a memory
+   * budget. When the budget is exceeded, the oldest frames are culled.
+   *
+   * Periodic full snapshots (keyframes) are stored alongside the deltas, so
+   * that SeekToFrame() costs at most one keyframe restore plus a keyframe
+   * interval's worth of deltas, regardless of how far back it seeks.
+   */
+  class CCompressedMemoryStream : public CDeltaRunMemoryStream,
+                                  protected CThread
+  {
+  public:
+    /*!
+     * \brief Create a compressed memory stream
+     *
+     * \param uncompressedFrameCount The number of recent frames that are
+     *        never compressed
+     * \param keyframeInterval The minimum number of frames between keyframes,
+     *        or 0 to disable keyframes. The interval is increased if needed
+     *        to keep keyframes within a fraction of the memory budget.
+     */
+    CCompressedMemoryStream(uint64_t uncompressedFrameCount, uint64_t keyframeInterval);
+
+    virtual ~CCompressedMemoryStream();
+
+    // implementation of IMemoryStream via CDeltaRunMemoryStream
+    virtual void Reset() override;
+    virtual void SetMaxMemorySize(size_t maxMemorySize) override;
+    virtual uint64_t PastFramesAvailable() const override;
+    virtual uint64_t RewindFrames(uint64_t frameCount) override;
+    virtual bool SeekToFrame(uint64_t frameHistoryCount) override;
+    virtual void SetFrameCounter(uint64_t frameCount) override;
+
+    /*!
+     * \brief Return the number of bytes used by the stream
+     *
+     * This includes the current and next frame, and buffers kept for reuse.
+     */
+    size_t MemoryUsage() const;
+
+    /*!
+     * \brief Return the number of past frames that have been compressed
+     */
+    uint64_t CompressedFramesAvailable() const;
+
+    /*!
+     * \brief Compress all frames and keyframes outside of the uncompressed
+     *        window on the calling thread
+     *
+     * The worker thread does this in the background. This is for callers
+     * that need the result without waiting for the worker, e.g. tests.
+     */
+    void Flush();
+
+  protected:
+    // implementation of CLinearMemoryStream via CDeltaRunMemoryStream
+    virtual void SubmitFrameInternal() override;
+    virtual void CullPastFrames(uint64_t frameCount) override;
+
+    // implementation of CThread
+    virtual void Process() override;
+
+  private:
+    struct CompressedFrame
+    {
+      uint8_t* data;
+      size_t dataSize; // Size in the arena, in bytes
+      size_t deltaSize; // Size of the uncompressed delta, in words
+      bool bCompressed; // False if compression didn't reduce the size
+      uint64_t frameHistoryCount;
+    };
+
+    enum class KeyframeState
+    {
+      UNCOMPRESSED,
+      COMPRESSED,
+      INCOMPRESSIBLE,
+    };
+
+    struct Keyframe
+    {
+      std::shared_ptr<std::vector<uint8_t>> data; // Shared with the worker while it compresses
+      KeyframeState state;
+    };
+
+    /*!
+     * \brief Compress the oldest uncompressed frame, if it is outside of the
+     *        uncompressed window
+     *
+     * Called with m_compressMutex held.
+     *
+     * \return True if a frame was compressed, false if there was no work
+     */
+    bool CompressFrame();
+
+    /*!
+     * \brief Compress the oldest uncompressed keyframe
+     *
+     * Called with m_compressMutex held.
+     *
+     * \return True if a keyframe was processed, false if there was no work
+     */
+    bool CompressKeyframe();
+
+    /*!
+     * \brief Rewind the most recent compressed frame
+     */
+    void RewindCompressedFrame();
+
+    /*!
+     * \brief Remove the most recent frames without applying their deltas
+     */
+    void DiscardFrames(uint64_t frameCount);
+
+    void AddKeyframe();
+    bool RestoreKeyframe(const Keyframe& keyframe);
+    void CullKeyframes();
+    uint64_t KeyframeInterval() const;
+    uint64_t OldestFrameHistory() const;
+
+    /*!
+     * \brief Compress one frame or keyframe
+     *
+     * \return True if there was work, false otherwise
+     */
+    bool CompressNext();
+
+    void EnforceMemoryBudget();
+    size_t UncompressedMemoryUsage() const;
+
+    // Construction parameter
+    const uint64_t m_uncompressedFrameCount;
+    const uint64_t m_keyframeInterval;
+
+    // Stream state, shared with the worker thread
+    std::deque<CompressedFrame> m_compressedFrames;
+    std::map<uint64_t, Keyframe> m_keyframes; // Keyed by frame history
+    std::shared_ptr<std::vector<uint8_t>> m_spareKeyframe; // Reused for the next keyframe
+    CSlabArena m_arena;
+    size_t m_maxMemorySize = 0;
+    unsigned int m_generation = 0; // Incremented when the oldest uncompressed frame is removed
+    mutable CCriticalSection m_streamMutex;
+
+    // Worker thread, or Flush()
+    CEvent m_compressEvent;
+    CCriticalSection m_compressMutex; // Guards the buffers below, taken before m_streamMutex
+    DeltaRunBuffer m_workBuffer;
+    std::vector<uint8_t> m_compressBuffer;
+    std::unique_ptr<uint8_t[]> m_compressWorkMemory;
+
+    // Rewind buffer
+    DeltaRunBuffer m_decompressBuffer;
+  };
+}
+}
@@ -30,7 +30,9 @@ void CDeltaPairMemoryStream::SubmitFrameInternal()
   uint32_t* currentFrame = m_currentFrame.get();
   uint32_t* nextFrame = m_nextFrame.get();
 
-  for (size_t i = 0; i < m_paddedFrameSize; i++)
+  const size_t frameWords = PaddedFrameWords();
+
+  for (size_t i = 0; i < frameWords; i++)
   {
     uint32_t xor_val = currentFrame[i] ^ nextFrame[i];
     if (xor_val)
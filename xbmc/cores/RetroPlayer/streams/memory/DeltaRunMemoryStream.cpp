@@ -0,0 +1,296 @@
+/*
+ *  Copyright (C) 2016-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DeltaRunMemoryStream.h"
+#include "utils/log.h"
+
+#if defined(HAVE_AVX2) && defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(HAVE_SSE2) && defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(HAS_NEON) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <inttypes.h>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // Size of a run header, in words
+  constexpr size_t RUN_HEADER_SIZE = 2;
+
+  // Runs separated by this many unchanged words or fewer are merged
+  constexpr size_t MAX_RUN_GAP = RUN_HEADER_SIZE;
+
+  // Number of culled buffers kept around for reuse
+  constexpr size_t MAX_FREE_BUFFERS = 4;
+
+  /*!
+   * \brief Find the first word in [begin, end) that differs between a and b
+   *
+   * \return The index of the word, or end if all words are equal
+   */
+  size_t FindFirstDifference(const uint32_t* a, const uint32_t* b, size_t begin, size_t end)
+  {
+    size_t i = begin;
+
+#if defined(HAVE_AVX2) && defined(__AVX2__)
+    for (; i + 8 <= end; i += 8)
+    {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+      const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(va, vb)) != -1)
+        break;
+    }
+#elif defined(HAVE_SSE2) && defined(__SSE2__)
+    for (; i + 4 <= end; i += 4)
+    {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0xFFFF)
+        break;
+    }
+#elif defined(HAS_NEON) && defined(__ARM_NEON)
+    for (; i + 4 <= end; i += 4)
+    {
+      const uint32x4_t eq = vceqq_u32(vld1q_u32(a + i), vld1q_u32(b + i));
+      const uint32x2_t all = vand_u32(vget_low_u32(eq), vget_high_u32(eq));
+      if ((vget_lane_u32(all, 0) & vget_lane_u32(all, 1)) != 0xFFFFFFFF)
+        break;
+    }
+#endif
+
+    // Locate the word inside the last block, or handle the tail
+    for (; i < end; i++)
+    {
+      if (a[i] != b[i])
+        break;
+    }
+
+    return i;
+  }
+
+  /*!
+   * \brief Find the first word in [begin, end) that is equal in a and b
+   *
+   * \return The index of the word, or end if all words differ
+   */
+  size_t FindFirstMatch(const uint32_t* a, const uint32_t* b, size_t begin, size_t end)
+  {
+    size_t i = begin;
+
+#if defined(HAVE_AVX2) && defined(__AVX2__)
+    for (; i + 8 <= end; i += 8)
+    {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+      const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(va, vb)) != 0)
+        break;
+    }
+#elif defined(HAVE_SSE2) && defined(__SSE2__)
+    for (; i + 4 <= end; i += 4)
+    {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(va, vb)) != 0)
+        break;
+    }
+#elif defined(HAS_NEON) && defined(__ARM_NEON)
+    for (; i + 4 <= end; i += 4)
+    {
+      const uint32x4_t eq = vceqq_u32(vld1q_u32(a + i), vld1q_u32(b + i));
+      const uint32x2_t any = vorr_u32(vget_low_u32(eq), vget_high_u32(eq));
+      if ((vget_lane_u32(any, 0) | vget_lane_u32(any, 1)) != 0)
+        break;
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+      if (a[i] == b[i])
+        break;
+    }
+
+    return i;
+  }
+
+  /*!
+   * \brief Compute dst = a ^ b for count words
+   *
+   * dst may alias a or b.
+   */
+  void XorWords(uint32_t* dst, const uint32_t* a, const uint32_t* b, size_t count)
+  {
+    size_t i = 0;
+
+#if defined(HAVE_AVX2) && defined(__AVX2__)
+    for (; i + 8 <= count; i += 8)
+    {
+      const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+      const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(va, vb));
+    }
+#elif defined(HAVE_SSE2) && defined(__SSE2__)
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(va, vb));
+    }
+#elif defined(HAS_NEON) && defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4)
+      vst1q_u32(dst + i, veorq_u32(vld1q_u32(a + i), vld1q_u32(b + i)));
+#endif
+
+    for (; i < count; i++)
+      dst[i] = a[i] ^ b[i];
+  }
+}
+
+void CDeltaRunMemoryStream::Reset()
+{
+  CLinearMemoryStream::Reset();
+
+  m_rewindBuffer.clear();
+  m_freeBuffers.clear();
+}
+
+void CDeltaRunMemoryStream::SubmitFrameInternal()
+{
+  m_rewindBuffer.push_back(MemoryFrame());
+  MemoryFrame& frame = m_rewindBuffer.back();
+
+  // Record frame history
+  frame.frameHistoryCount = m_currentFrameHistory++;
+
+  frame.buffer = GetBuffer();
+  EncodeDelta(m_currentFrame.get(), m_nextFrame.get(), PaddedFrameWords(), frame.buffer);
+
+  // Delta is generated, bring the new frame forward (m_nextFrame is now disposable)
+  std::swap(m_currentFrame, m_nextFrame);
+
+  m_bHasNextFrame = false;
+
+  if (PastFramesAvailable() + 1 > MaxFrameCount())
+    CullPastFrames(1);
+}
+
+uint64_t CDeltaRunMemoryStream::PastFramesAvailable() const
+{
+  return static_cast<uint64_t>(m_rewindBuffer.size());
+}
+
+uint64_t CDeltaRunMemoryStream::RewindFrames(uint64_t frameCount)
+{
+  uint64_t rewound;
+
+  for (rewound = 0; rewound < frameCount; rewound++)
+  {
+    if (m_rewindBuffer.empty())
+      break;
+
+    MemoryFrame& frame = m_rewindBuffer.back();
+
+    ApplyDelta(frame.buffer, m_currentFrame.get());
+
+    // Restore frame history
+    m_currentFrameHistory = frame.frameHistoryCount;
+
+    RecycleBuffer(std::move(frame.buffer));
+    m_rewindBuffer.pop_back();
+  }
+
+  return rewound;
+}
+
+void CDeltaRunMemoryStream::CullPastFrames(uint64_t frameCount)
+{
+  for (uint64_t removedCount = 0; removedCount < frameCount; removedCount++)
+  {
+    if (m_rewindBuffer.empty())
+    {
+      CLog::Log(LOGDEBUG, "CDeltaRunMemoryStream: Tried to cull %" PRIu64 " frames too many. Check your math!", frameCount - removedCount);
+      break;
+    }
+    RecycleBuffer(std::move(m_rewindBuffer.front().buffer));
+    m_rewindBuffer.pop_front();
+  }
+}
+
+void CDeltaRunMemoryStream::EncodeDelta(const uint32_t* currentFrame, const uint32_t* nextFrame, size_t frameWords, DeltaRunBuffer& buffer)
+{
+  buffer.clear();
+
+  size_t runBegin = FindFirstDifference(currentFrame, nextFrame, 0, frameWords);
+
+  while (runBegin < frameWords)
+  {
+    // Extend the run over any gaps that are cheaper to store than a header
+    size_t runEnd = FindFirstMatch(currentFrame, nextFrame, runBegin, frameWords);
+    while (runEnd < frameWords)
+    {
+      const size_t gapEnd = std::min(runEnd + MAX_RUN_GAP + 1, frameWords);
+      const size_t nextChange = FindFirstDifference(currentFrame, nextFrame, runEnd, gapEnd);
+      if (nextChange == gapEnd)
+        break;
+
+      runEnd = FindFirstMatch(currentFrame, nextFrame, nextChange, frameWords);
+    }
+
+    const size_t runLength = runEnd - runBegin;
+    const size_t headerPos = buffer.size();
+
+    buffer.resize(headerPos + RUN_HEADER_SIZE + runLength);
+    buffer[headerPos] = static_cast<uint32_t>(runBegin);
+    buffer[headerPos + 1] = static_cast<uint32_t>(runLength);
+
+    XorWords(buffer.data() + headerPos + RUN_HEADER_SIZE, currentFrame + runBegin, nextFrame + runBegin, runLength);
+
+    runBegin = FindFirstDifference(currentFrame, nextFrame, runEnd, frameWords);
+  }
+}
+
+void CDeltaRunMemoryStream::ApplyDelta(const DeltaRunBuffer& buffer, uint32_t* frame)
+{
+  const uint32_t* run = buffer.data();
+  const uint32_t* const end = run + buffer.size();
+
+  while (run < end)
+  {
+    const uint32_t runBegin = run[0];
+    const uint32_t runLength = run[1];
+    run += RUN_HEADER_SIZE;
+
+    XorWords(frame + runBegin, frame + runBegin, run, runLength);
+    run += runLength;
+  }
+}
+
+CDeltaRunMemoryStream::DeltaRunBuffer CDeltaRunMemoryStream::GetBuffer()
+{
+  DeltaRunBuffer buffer;
+
+  if (!m_freeBuffers.empty())
+  {
+    buffer = std::move(m_freeBuffers.back());
+    m_freeBuffers.pop_back();
+    buffer.clear();
+  }
+
+  return buffer;
+}
+
+void CDeltaRunMemoryStream::RecycleBuffer(DeltaRunBuffer buffer)
+{
+  if (m_freeBuffers.size() < MAX_FREE_BUFFERS)
+    m_freeBuffers.emplace_back(std::move(buffer));
+}
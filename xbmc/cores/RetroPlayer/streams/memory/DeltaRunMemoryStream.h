@@ -0,0 +1,92 @@
+/*
+ *  Copyright (C) 2016-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "LinearMemoryStream.h"
+
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Implementation of a linear memory stream using run-length encoded
+   *        XOR deltas
+   *
+   * Unlike CDeltaPairMemoryStream, which stores a {position, delta} pair for
+   * every changed word, this stream stores contiguous runs of changed words
+   * as a single header followed by the XOR payload. Searching for changes and
+   * applying a run are both vectorized (SSE2/AVX2/NEON) where available.
+   */
+  class CDeltaRunMemoryStream : public CLinearMemoryStream
+  {
+  public:
+    CDeltaRunMemoryStream() = default;
+
+    virtual ~CDeltaRunMemoryStream() = default;
+
+    // implementation of IMemoryStream via CLinearMemoryStream
+    virtual void Reset() override;
+    virtual uint64_t PastFramesAvailable() const override;
+    virtual uint64_t RewindFrames(uint64_t frameCount) override;
+
+  protected:
+    // implementation of CLinearMemoryStream
+    virtual void SubmitFrameInternal() override;
+    virtual void CullPastFrames(uint64_t frameCount) override;
+
+    /*!
+     * A delta is a sequence of runs. Each run is encoded in the buffer as:
+     *
+     *   [ offset ] [ length ] [ payload (length words) ]
+     *
+     * where offset and length are measured in 32-bit words, and the payload
+     * is the XOR of the old and new contents of the run. Runs separated by
+     * only a few unchanged words are merged, because a header costs more
+     * than the zero words it would skip.
+     */
+    using DeltaRunBuffer = std::vector<uint32_t>;
+
+    struct MemoryFrame
+    {
+      DeltaRunBuffer buffer;
+      uint64_t frameHistoryCount;
+    };
+
+    /*!
+     * \brief Encode the XOR delta between two frames into a run buffer
+     */
+    static void EncodeDelta(const uint32_t* currentFrame, const uint32_t* nextFrame, size_t frameWords, DeltaRunBuffer& buffer);
+
+    /*!
+     * \brief Apply a run buffer created by EncodeDelta() to a frame
+     */
+    static void ApplyDelta(const DeltaRunBuffer& buffer, uint32_t* frame);
+
+    /*!
+     * \brief Get a cleared buffer, reusing the storage of culled frames
+     */
+    DeltaRunBuffer GetBuffer();
+
+    /*!
+     * \brief Return a buffer's storage to be reused by later frames
+     */
+    void RecycleBuffer(DeltaRunBuffer buffer);
+
+    std::deque<MemoryFrame> m_rewindBuffer;
+
+    // Storage of culled frames, to avoid an allocation per frame
+    std::vector<DeltaRunBuffer> m_freeBuffers;
+  };
+}
+}
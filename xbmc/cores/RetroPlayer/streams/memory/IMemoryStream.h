@@ -32,7 +32,8 @@ namespace RETRO
    *   - Linear memory stream: can grow in one direction. It is possible to
    *         rewind, but not fast-forward.
    *
-   *         \sa CLinearMemoryStream
+   *         \sa CLinearMemoryStream, CDeltaPairMemoryStream,
+   *             CDeltaRunMemoryStream
    *
    *   - Nonlinear memory stream: can have frames both ahead of and behind
    *         the current frame. If a stream is rewound, it is possible to
@@ -75,6 +76,15 @@ namespace RETRO
      */
     virtual void SetMaxFrameCount(uint64_t maxFrameCount) = 0;
 
+    /*!
+     * \brief Update the max number of bytes used to store past frames
+     *
+     * Old frames may be deleted if the memory budget is exceeded. A size of 0
+     * means that the stream is only bounded by MaxFrameCount(). Streams that
+     * don't track their memory usage ignore this.
+     */
+    virtual void SetMaxMemorySize(size_t maxMemorySize) = 0;
+
     /*!
      * \ brief Get a pointer to which FrameSize() bytes can be written
      *
@@ -126,6 +136,20 @@ namespace RETRO
      */
     virtual uint64_t RewindFrames(uint64_t frameCount) = 0;
 
+    /*!
+     * \brief Seek backwards to the past frame with the given history
+     *
+     * Unlike RewindFrames(), streams may implement this without visiting
+     * every frame in between, e.g. by restoring a keyframe.
+     *
+     * \param frameHistoryCount The history of the frame, as returned by
+     *        GetFrameCounter()
+     *
+     * \return True if the current frame has the requested history, false if
+     *         the seek stopped at the oldest available frame
+     */
+    virtual bool SeekToFrame(uint64_t frameHistoryCount) = 0;
+
     /*!
      * \brief Get the total number of frames played until the current frame
      *
@@ -64,12 +64,12 @@ uint8_t* CLinearMemoryStream::BeginFrame()
   if (!m_bHasCurrentFrame)
   {
     if (!m_currentFrame)
-      m_currentFrame.reset(new uint32_t[m_paddedFrameSize]);
+      m_currentFrame.reset(new uint32_t[PaddedFrameWords()]);
     return reinterpret_cast<uint8_t*>(m_currentFrame.get());
   }
 
   if (!m_nextFrame)
-    m_nextFrame.reset(new uint32_t[m_paddedFrameSize]);
+    m_nextFrame.reset(new uint32_t[PaddedFrameWords()]);
   return reinterpret_cast<uint8_t*>(m_nextFrame.get());
 }
 
@@ -98,6 +98,23 @@ void CLinearMemoryStream::SubmitFrame()
   }
 }
 
+bool CLinearMemoryStream::SeekToFrame(uint64_t frameHistoryCount)
+{
+  while (m_currentFrameHistory > frameHistoryCount)
+  {
+    const uint64_t previousFrameHistory = m_currentFrameHistory;
+
+    if (RewindFrames(1) == 0)
+      break;
+
+    // Stop at discontinuities caused by SetFrameCounter()
+    if (m_currentFrameHistory >= previousFrameHistory)
+      break;
+  }
+
+  return m_currentFrameHistory == frameHistoryCount;
+}
+
 uint64_t CLinearMemoryStream::BufferSize() const
 {
   return PastFramesAvailable() + (m_bHasCurrentFrame ? 1 : 0);
@@ -30,6 +30,7 @@ namespace RETRO
     virtual size_t FrameSize() const override { return m_frameSize; }
     virtual uint64_t MaxFrameCount() const override { return m_maxFrames; }
     virtual void SetMaxFrameCount(uint64_t maxFrameCount) override;
+    virtual void SetMaxMemorySize(size_t maxMemorySize) override { }
     virtual uint8_t* BeginFrame() override;
     virtual void SubmitFrame() override;
     virtual const uint8_t* CurrentFrame() const override;
@@ -37,6 +38,7 @@ namespace RETRO
     virtual uint64_t AdvanceFrames(uint64_t frameCount) override { return 0; }
     virtual uint64_t PastFramesAvailable() const override = 0;
     virtual uint64_t RewindFrames(uint64_t frameCount) override = 0;
+    virtual bool SeekToFrame(uint64_t frameHistoryCount) override;
     virtual uint64_t GetFrameCounter() const override { return m_currentFrameHistory; }
     virtual void SetFrameCounter(uint64_t frameCount) override { m_currentFrameHistory = frameCount; }
 
@@ -44,8 +46,9 @@ namespace RETRO
     virtual void SubmitFrameInternal() = 0;
     virtual void CullPastFrames(uint64_t frameCount) = 0;
 
-    // Helper function
+    // Helper functions
     uint64_t BufferSize() const;
+    size_t PaddedFrameWords() const { return m_paddedFrameSize / sizeof(uint32_t); }
 
     size_t m_paddedFrameSize;
     uint64_t m_maxFrames;
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "SlabArena.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace KODI;
+using namespace RETRO;
+
+CSlabArena::CSlabArena(size_t slabSize) :
+  m_slabSize(slabSize),
+  m_spareSlab{ nullptr, 0, 0, 0 },
+  m_capacity(0)
+{
+}
+
+uint8_t* CSlabArena::PushBack(size_t size)
+{
+  if (m_slabs.empty() || m_slabs.back().size - m_slabs.back().used < size)
+    m_slabs.emplace_back(CreateSlab(size));
+
+  Slab& slab = m_slabs.back();
+
+  uint8_t* block = slab.data.get() + slab.used;
+
+  slab.used += size;
+  slab.allocations++;
+
+  return block;
+}
+
+void CSlabArena::PopBack(size_t size)
+{
+  if (m_slabs.empty())
+    return;
+
+  Slab& slab = m_slabs.back();
+
+  slab.used -= size;
+  if (--slab.allocations == 0)
+  {
+    FreeSlab(std::move(slab));
+    m_slabs.pop_back();
+  }
+}
+
+void CSlabArena::PopFront()
+{
+  if (m_slabs.empty())
+    return;
+
+  Slab& slab = m_slabs.front();
+
+  // Space at the front of a slab can't be reused until the slab is empty
+  if (--slab.allocations == 0)
+  {
+    FreeSlab(std::move(slab));
+    m_slabs.pop_front();
+  }
+}
+
+void CSlabArena::Clear()
+{
+  m_slabs.clear();
+  m_spareSlab = Slab{ nullptr, 0, 0, 0 };
+  m_capacity = 0;
+}
+
+CSlabArena::Slab CSlabArena::CreateSlab(size_t minSize)
+{
+  if (m_spareSlab.data && m_spareSlab.size >= minSize)
+  {
+    Slab slab = std::move(m_spareSlab);
+    m_spareSlab = Slab{ nullptr, 0, 0, 0 };
+    m_capacity += slab.size;
+    return slab;
+  }
+
+  // Oversized blocks get a slab of their own
+  const size_t size = std::max(minSize, m_slabSize);
+
+  m_capacity += size;
+
+  return Slab{ std::unique_ptr<uint8_t[]>(new uint8_t[size]), size, 0, 0 };
+}
+
+void CSlabArena::FreeSlab(Slab slab)
+{
+  m_capacity -= slab.size;
+
+  if (slab.size == m_slabSize && !m_spareSlab.data)
+  {
+    slab.used = 0;
+    slab.allocations = 0;
+    m_spareSlab = std::move(slab);
+  }
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace KODI
+{
+namespace RETRO
+{
+  /*!
+   * \brief Arena of fixed-size memory slabs used as a double-ended stack
+   *
+   * Allocations are always made at the back. They can be freed either from
+   * the back (most recent allocation first) or from the front (oldest
+   * allocation first), which matches the access pattern of a rewind buffer:
+   * old frames are culled from the front, and rewinding consumes frames
+   * from the back.
+   *
+   * Memory is only returned when every allocation in a slab has been freed.
+   * One empty slab is kept around to avoid reallocating when the arena
+   * oscillates around a slab boundary.
+   */
+  class CSlabArena
+  {
+  public:
+    explicit CSlabArena(size_t slabSize);
+
+    /*!
+     * \brief Allocate a block at the back of the arena
+     *
+     * \param size The size of the block, must be non-zero
+     *
+     * \return The block, valid until it is freed or the arena is cleared
+     */
+    uint8_t* PushBack(size_t size);
+
+    /*!
+     * \brief Free the most recent allocation
+     *
+     * \param size The size that was passed to PushBack()
+     */
+    void PopBack(size_t size);
+
+    /*!
+     * \brief Free the oldest allocation
+     */
+    void PopFront();
+
+    /*!
+     * \brief Free all allocations and slabs
+     */
+    void Clear();
+
+    /*!
+     * \brief Return the number of bytes held by slabs in use
+     *
+     * The spare slab is not included.
+     */
+    size_t Capacity() const { return m_capacity; }
+
+  private:
+    struct Slab
+    {
+      std::unique_ptr<uint8_t[]> data;
+      size_t size;
+      size_t used;
+      unsigned int allocations;
+    };
+
+    Slab CreateSlab(size_t minSize);
+    void FreeSlab(Slab slab);
+
+    // Construction parameter
+    const size_t m_slabSize;
+
+    std::deque<Slab> m_slabs;
+    Slab m_spareSlab;
+    size_t m_capacity;
+  };
+}
+}
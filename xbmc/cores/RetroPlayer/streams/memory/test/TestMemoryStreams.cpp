@@ -0,0 +1,330 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/streams/memory/CompressedMemoryStream.h"
+#include "cores/RetroPlayer/streams/memory/DeltaPairMemoryStream.h"
+#include "cores/RetroPlayer/streams/memory/DeltaRunMemoryStream.h"
+#include "test/BenchmarkUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace KODI;
+using namespace RETRO;
+
+namespace
+{
+  // Not a multiple of 4 bytes, to exercise the padding of the last word
+  constexpr size_t FRAME_SIZE = 64 * 1024 + 3;
+
+  using Savestate = std::vector<uint8_t>;
+
+  /*!
+   * \brief Generate a sequence of savestates resembling emulated RAM
+   *
+   * Each frame touches a few contiguous blocks (e.g. a DMA'd sprite table)
+   * plus a handful of scattered bytes (e.g. counters and registers).
+   */
+  std::vector<Savestate> GenerateSavestates(unsigned int frameCount, unsigned int blockCount = 4)
+  {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> offsetDist(0, FRAME_SIZE - 1);
+    std::uniform_int_distribution<size_t> lengthDist(1, 512);
+    std::uniform_int_distribution<unsigned int> byteDist(0, 255);
+
+    std::vector<Savestate> savestates;
+
+    Savestate state(FRAME_SIZE);
+    for (auto& byte : state)
+      byte = static_cast<uint8_t>(byteDist(rng));
+
+    for (unsigned int i = 0; i < frameCount; i++)
+    {
+      for (unsigned int block = 0; block < blockCount; block++)
+      {
+        const size_t offset = offsetDist(rng);
+        const size_t length = std::min(lengthDist(rng), FRAME_SIZE - offset);
+        for (size_t j = offset; j < offset + length; j++)
+          state[j] = static_cast<uint8_t>(byteDist(rng));
+      }
+
+      for (unsigned int scattered = 0; scattered < 16; scattered++)
+        state[offsetDist(rng)]++;
+
+      savestates.push_back(state);
+    }
+
+    return savestates;
+  }
+
+  void SubmitSavestates(IMemoryStream& stream, const std::vector<Savestate>& savestates)
+  {
+    for (const Savestate& savestate : savestates)
+    {
+      uint8_t* frame = stream.BeginFrame();
+      ASSERT_NE(frame, nullptr);
+      std::memcpy(frame, savestate.data(), savestate.size());
+      stream.SubmitFrame();
+    }
+  }
+
+  void TestRewind(IMemoryStream& stream)
+  {
+    const std::vector<Savestate> savestates = GenerateSavestates(60);
+
+    stream.Init(FRAME_SIZE, savestates.size());
+    SubmitSavestates(stream, savestates);
+
+    ASSERT_EQ(stream.PastFramesAvailable(), savestates.size() - 1);
+    ASSERT_EQ(stream.GetFrameCounter(), savestates.size() - 1);
+
+    for (size_t i = savestates.size(); i-- > 0; )
+    {
+      ASSERT_NE(stream.CurrentFrame(), nullptr);
+      EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[i].data(), FRAME_SIZE), 0) << "Frame " << i;
+      EXPECT_EQ(stream.GetFrameCounter(), i);
+
+      if (i > 0)
+        EXPECT_EQ(stream.RewindFrames(1), 1u);
+    }
+
+    EXPECT_EQ(stream.RewindFrames(1), 0u);
+  }
+
+  void TestSeek(IMemoryStream& stream)
+  {
+    const std::vector<Savestate> savestates = GenerateSavestates(120);
+
+    stream.Init(FRAME_SIZE, savestates.size());
+    SubmitSavestates(stream, savestates);
+
+    for (uint64_t frameHistory : { 118, 100, 57, 50, 49, 3 })
+    {
+      EXPECT_TRUE(stream.SeekToFrame(frameHistory));
+      EXPECT_EQ(stream.GetFrameCounter(), frameHistory);
+      EXPECT_EQ(stream.PastFramesAvailable(), frameHistory);
+      EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[frameHistory].data(), FRAME_SIZE), 0) << "Frame " << frameHistory;
+    }
+
+    // Seeking forward isn't possible in a linear stream
+    EXPECT_FALSE(stream.SeekToFrame(10));
+    EXPECT_EQ(stream.GetFrameCounter(), 3u);
+  }
+
+  void TestCull(IMemoryStream& stream)
+  {
+    const std::vector<Savestate> savestates = GenerateSavestates(30);
+
+    stream.Init(FRAME_SIZE, 10);
+    SubmitSavestates(stream, savestates);
+
+    EXPECT_EQ(stream.PastFramesAvailable(), 9u);
+    EXPECT_EQ(stream.RewindFrames(100), 9u);
+    ASSERT_NE(stream.CurrentFrame(), nullptr);
+    EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[20].data(), FRAME_SIZE), 0);
+
+    // Keep playing after a rewind
+    SubmitSavestates(stream, savestates);
+    EXPECT_EQ(stream.RewindFrames(5), 5u);
+    EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[24].data(), FRAME_SIZE), 0);
+  }
+
+  /*!
+   * \brief Submit savestates, compressing on the test thread after each one
+   *        as if the worker kept up
+   */
+  void SubmitAndCompress(CCompressedMemoryStream& stream, const std::vector<Savestate>& savestates)
+  {
+    for (const Savestate& savestate : savestates)
+    {
+      uint8_t* frame = stream.BeginFrame();
+      ASSERT_NE(frame, nullptr);
+      std::memcpy(frame, savestate.data(), savestate.size());
+      stream.SubmitFrame();
+      stream.Flush();
+    }
+  }
+
+  /*!
+   * \brief Rewind all past frames one at a time, comparing each to the
+   *        savestate it was created from
+   */
+  void ExpectRewindMatches(IMemoryStream& stream, const std::vector<Savestate>& savestates)
+  {
+    const uint64_t pastFrames = stream.PastFramesAvailable();
+
+    for (uint64_t i = 0; i < pastFrames; i++)
+    {
+      ASSERT_EQ(stream.RewindFrames(1), 1u);
+
+      const uint64_t frameHistory = stream.GetFrameCounter();
+      ASSERT_LT(frameHistory, savestates.size());
+      EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[frameHistory].data(), FRAME_SIZE), 0) << "Frame " << frameHistory;
+    }
+
+    EXPECT_EQ(stream.RewindFrames(1), 0u);
+  }
+}
+
+TEST(TestMemoryStreams, DeltaPairRewind)
+{
+  CDeltaPairMemoryStream stream;
+  TestRewind(stream);
+}
+
+TEST(TestMemoryStreams, DeltaPairCull)
+{
+  CDeltaPairMemoryStream stream;
+  TestCull(stream);
+}
+
+TEST(TestMemoryStreams, DeltaRunRewind)
+{
+  CDeltaRunMemoryStream stream;
+  TestRewind(stream);
+}
+
+TEST(TestMemoryStreams, DeltaRunCull)
+{
+  CDeltaRunMemoryStream stream;
+  TestCull(stream);
+}
+
+TEST(TestMemoryStreams, DeltaRunSeek)
+{
+  CDeltaRunMemoryStream stream;
+  TestSeek(stream);
+}
+
+TEST(TestMemoryStreams, DeltaRunMatchesDeltaPair)
+{
+  const std::vector<Savestate> savestates = GenerateSavestates(120);
+
+  CDeltaPairMemoryStream pairStream;
+  CDeltaRunMemoryStream runStream;
+
+  pairStream.Init(FRAME_SIZE, savestates.size());
+  runStream.Init(FRAME_SIZE, savestates.size());
+
+  SubmitSavestates(pairStream, savestates);
+  SubmitSavestates(runStream, savestates);
+
+  for (unsigned int rewind : { 1, 7, 30, 2 })
+  {
+    EXPECT_EQ(pairStream.RewindFrames(rewind), runStream.RewindFrames(rewind));
+    EXPECT_EQ(pairStream.GetFrameCounter(), runStream.GetFrameCounter());
+    EXPECT_EQ(std::memcmp(pairStream.CurrentFrame(), runStream.CurrentFrame(), FRAME_SIZE), 0);
+  }
+}
+
+TEST(TestMemoryStreams, CompressedRewind)
+{
+  const std::vector<Savestate> savestates = GenerateSavestates(60);
+
+  CCompressedMemoryStream stream(5, 0);
+  stream.Init(FRAME_SIZE, savestates.size());
+  SubmitAndCompress(stream, savestates);
+
+  // All but the uncompressed window
+  ASSERT_EQ(stream.PastFramesAvailable(), savestates.size() - 1);
+  EXPECT_EQ(stream.CompressedFramesAvailable(), savestates.size() - 1 - 5);
+
+  ExpectRewindMatches(stream, savestates);
+  EXPECT_EQ(stream.GetFrameCounter(), 0u);
+}
+
+TEST(TestMemoryStreams, CompressedCull)
+{
+  const std::vector<Savestate> savestates = GenerateSavestates(30);
+
+  CCompressedMemoryStream stream(5, 0);
+  stream.Init(FRAME_SIZE, 10);
+  SubmitAndCompress(stream, savestates);
+
+  EXPECT_EQ(stream.PastFramesAvailable(), 9u);
+  EXPECT_EQ(stream.CompressedFramesAvailable(), 4u);
+  EXPECT_EQ(stream.RewindFrames(100), 9u);
+  EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[20].data(), FRAME_SIZE), 0);
+
+  // Keep playing after a rewind
+  SubmitAndCompress(stream, savestates);
+  EXPECT_EQ(stream.CompressedFramesAvailable(), 4u);
+  EXPECT_EQ(stream.RewindFrames(5), 5u);
+  EXPECT_EQ(std::memcmp(stream.CurrentFrame(), savestates[24].data(), FRAME_SIZE), 0);
+}
+
+TEST(TestMemoryStreams, CompressedKeyframeSeek)
+{
+  CCompressedMemoryStream stream(5, 10);
+  TestSeek(stream);
+}
+
+TEST(TestMemoryStreams, CompressedKeyframeRewind)
+{
+  CCompressedMemoryStream stream(5, 10);
+  TestRewind(stream);
+}
+
+TEST(TestMemoryStreams, CompressedMemoryBudget)
+{
+  // About 16 KB per delta, so the history spans several 1 MB arena slabs
+  const std::vector<Savestate> savestates = GenerateSavestates(120, 64);
+
+  // Room for the current and next frame, plus part of the history
+  const size_t paddedFrameSize = (FRAME_SIZE + 3) / 4 * 4;
+  const size_t maxMemorySize = 2 * paddedFrameSize + 3 * 1024 * 1024 / 2;
+
+  CCompressedMemoryStream stream(5, 0);
+  stream.Init(FRAME_SIZE, savestates.size());
+  stream.SetMaxMemorySize(maxMemorySize);
+
+  SubmitAndCompress(stream, savestates);
+
+  EXPECT_LE(stream.MemoryUsage(), maxMemorySize);
+  EXPECT_GT(stream.CompressedFramesAvailable(), 0u);
+  EXPECT_LT(stream.PastFramesAvailable(), savestates.size() - 1);
+
+  ExpectRewindMatches(stream, savestates);
+}
+
+TEST(TestMemoryStreams, DISABLED_DeltaCost)
+{
+  constexpr unsigned int FRAME_COUNT = 600;
+
+  const std::vector<Savestate> savestates = GenerateSavestates(FRAME_COUNT);
+
+  CDeltaPairMemoryStream pairStream;
+  CDeltaRunMemoryStream runStream;
+  const std::pair<std::string, IMemoryStream*> streams[] = { { "DeltaPair", &pairStream }, { "DeltaRun", &runStream } };
+
+  for (const auto& it : streams)
+  {
+    IMemoryStream& stream = *it.second;
+    stream.Init(FRAME_SIZE, FRAME_COUNT);
+
+    unsigned int frame = 0;
+    const double submitUs = CBenchmarkUtils::MeanUs(FRAME_COUNT, [&stream, &savestates, &frame]()
+    {
+      std::memcpy(stream.BeginFrame(), savestates[frame++].data(), FRAME_SIZE);
+      stream.SubmitFrame();
+    });
+
+    const double rewindUs = CBenchmarkUtils::MeanUs(FRAME_COUNT - 1, [&stream]()
+    {
+      stream.RewindFrames(1);
+    });
+
+    CBenchmarkUtils::Report(it.first + " submit", submitUs, "us/frame");
+    CBenchmarkUtils::Report(it.first + " rewind", rewindUs, "us/frame");
+  }
+}
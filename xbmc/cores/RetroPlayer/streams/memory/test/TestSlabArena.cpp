@@ -0,0 +1,64 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/RetroPlayer/streams/memory/SlabArena.h"
+
+#include "gtest/gtest.h"
+
+using namespace KODI;
+using namespace RETRO;
+
+TEST(TestSlabArena, PushPopBack)
+{
+  CSlabArena arena(1024);
+
+  uint8_t* first = arena.PushBack(600);
+  uint8_t* second = arena.PushBack(600);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(arena.Capacity(), 2048u);
+
+  // Freeing the back makes its space available again
+  arena.PopBack(600);
+  EXPECT_EQ(arena.Capacity(), 1024u);
+  EXPECT_EQ(arena.PushBack(600), second);
+}
+
+TEST(TestSlabArena, PopFront)
+{
+  CSlabArena arena(1024);
+
+  for (unsigned int i = 0; i < 4; i++)
+    arena.PushBack(512);
+  EXPECT_EQ(arena.Capacity(), 2048u);
+
+  // A slab is only released when all of its blocks are freed
+  arena.PopFront();
+  EXPECT_EQ(arena.Capacity(), 2048u);
+  arena.PopFront();
+  EXPECT_EQ(arena.Capacity(), 1024u);
+
+  // The released slab is reused
+  arena.PushBack(512);
+  EXPECT_EQ(arena.Capacity(), 2048u);
+}
+
+TEST(TestSlabArena, Oversized)
+{
+  CSlabArena arena(1024);
+
+  arena.PushBack(100);
+  arena.PushBack(4096);
+  EXPECT_EQ(arena.Capacity(), 1024u + 4096u);
+
+  arena.PopBack(4096);
+  EXPECT_EQ(arena.Capacity(), 1024u);
+
+  arena.Clear();
+  EXPECT_EQ(arena.Capacity(), 0u);
+}
@@ -0,0 +1,209 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "SteamLinkLatencyTrace.h"
+#include "filesystem/File.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <inttypes.h>
+
+using namespace KODI;
+using namespace STEAMLINK;
+
+namespace
+{
+  size_t RoundUpToPowerOfTwo(size_t value)
+  {
+    size_t result = 1;
+    while (result < value)
+      result <<= 1;
+    return result;
+  }
+
+  LatencyPercentiles GetPercentiles(std::vector<double> &samplesMs)
+  {
+    LatencyPercentiles percentiles;
+
+    if (!samplesMs.empty())
+    {
+      std::sort(samplesMs.begin(), samplesMs.end());
+
+      auto percentile = [&samplesMs](double fraction)
+      {
+        size_t rank = static_cast<size_t>(std::ceil(fraction * samplesMs.size()));
+        return samplesMs[std::max(rank, static_cast<size_t>(1)) - 1];
+      };
+
+      percentiles.p50Ms = percentile(0.50);
+      percentiles.p95Ms = percentile(0.95);
+      percentiles.p99Ms = percentile(0.99);
+      percentiles.maxMs = samplesMs.back();
+    }
+
+    return percentiles;
+  }
+}
+
+constexpr size_t CSteamLinkLatencyTrace::DEFAULT_CAPACITY;
+constexpr size_t CSteamLinkLatencyTrace::RECORD_WORDS;
+
+CSteamLinkLatencyTrace::CSteamLinkLatencyTrace(size_t capacity /* = DEFAULT_CAPACITY */) :
+  m_mask(RoundUpToPowerOfTwo(std::max(capacity, static_cast<size_t>(1))) - 1),
+  m_slots(new Slot[m_mask + 1]),
+  m_writePosition(0)
+{
+  for (size_t i = 0; i <= m_mask; i++)
+  {
+    m_slots[i].sequence.store(0, std::memory_order_relaxed);
+    for (auto &word : m_slots[i].words)
+      word.store(0, std::memory_order_relaxed);
+  }
+}
+
+int64_t CSteamLinkLatencyTrace::NowUs()
+{
+  const int64_t counter = CurrentHostCounter();
+  const int64_t frequency = CurrentHostFrequency();
+
+  // Split to avoid overflowing nanosecond counters
+  return (counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency;
+}
+
+void CSteamLinkLatencyTrace::AddRecord(const SteamLinkLatencyRecord &record)
+{
+  const uint64_t position = m_writePosition.load(std::memory_order_relaxed);
+  const uint64_t lap = position / (m_mask + 1);
+
+  Slot &slot = m_slots[position & m_mask];
+
+  // Mark the slot as being written
+  slot.sequence.store(2 * lap + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint64_t words[RECORD_WORDS] = { };
+  std::memcpy(words, &record, sizeof(record));
+
+  for (size_t i = 0; i < RECORD_WORDS; i++)
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+
+  // Publish the record
+  slot.sequence.store(2 * lap + 2, std::memory_order_release);
+  m_writePosition.store(position + 1, std::memory_order_release);
+}
+
+std::vector<SteamLinkLatencyRecord> CSteamLinkLatencyTrace::GetRecords() const
+{
+  std::vector<SteamLinkLatencyRecord> records;
+
+  const uint64_t capacity = m_mask + 1;
+  const uint64_t end = m_writePosition.load(std::memory_order_acquire);
+  const uint64_t begin = end > capacity ? end - capacity : 0;
+
+  records.reserve(static_cast<size_t>(end - begin));
+
+  for (uint64_t position = begin; position < end; position++)
+  {
+    const Slot &slot = m_slots[position & m_mask];
+    const uint64_t expectedSequence = 2 * (position / capacity) + 2;
+
+    if (slot.sequence.load(std::memory_order_acquire) != expectedSequence)
+      continue;
+
+    uint64_t words[RECORD_WORDS];
+    for (size_t i = 0; i < RECORD_WORDS; i++)
+      words[i] = slot.words[i].load(std::memory_order_relaxed);
+
+    // Discard the copy if the writer started overwriting the slot
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != expectedSequence)
+      continue;
+
+    SteamLinkLatencyRecord record;
+    std::memcpy(&record, words, sizeof(record));
+
+    records.push_back(record);
+  }
+
+  return records;
+}
+
+VideoLatencyInfo CSteamLinkLatencyTrace::GetLatency(const std::vector<SteamLinkLatencyRecord> &records)
+{
+  VideoLatencyInfo latency;
+
+  std::vector<double> demuxToDecoderMs;
+  std::vector<double> decoderWriteMs;
+  std::vector<double> decoderQueueMs;
+
+  demuxToDecoderMs.reserve(records.size());
+  decoderWriteMs.reserve(records.size());
+  decoderQueueMs.reserve(records.size());
+
+  for (const auto &record : records)
+  {
+    // Packets that never reached the decoder are only counted for starvation
+    if (record.writeEndUs != 0)
+    {
+      if (record.demuxUs != 0)
+        demuxToDecoderMs.push_back((record.writeEndUs - record.demuxUs) / 1000.0);
+      decoderWriteMs.push_back((record.writeEndUs - record.writeBeginUs) / 1000.0);
+      decoderQueueMs.push_back(record.queuedMs);
+    }
+
+    if (record.bBufferStarved)
+      latency.starvedBuffers++;
+  }
+
+  latency.sampleCount = static_cast<unsigned int>(records.size());
+  latency.demuxToDecoder = GetPercentiles(demuxToDecoderMs);
+  latency.decoderWrite = GetPercentiles(decoderWriteMs);
+  latency.decoderQueue = GetPercentiles(decoderQueueMs);
+
+  return latency;
+}
+
+bool CSteamLinkLatencyTrace::Dump(const std::string &path) const
+{
+  const std::vector<SteamLinkLatencyRecord> records = GetRecords();
+
+  XFILE::CFile file;
+  if (!file.OpenForWrite(path, true))
+  {
+    CLog::Log(LOGERROR, "SteamLinkVideo: Failed to open latency trace \"%s\"", path.c_str());
+    return false;
+  }
+
+  std::string trace = "demux_us,write_begin_us,write_end_us,dts,size,queued_ms,buffer_starved\n";
+
+  for (const auto &record : records)
+  {
+    trace += StringUtils::Format("%" PRId64 ",%" PRId64 ",%" PRId64 ",%f,%u,%u,%d\n",
+                                 record.demuxUs,
+                                 record.writeBeginUs,
+                                 record.writeEndUs,
+                                 record.dts,
+                                 record.size,
+                                 record.queuedMs,
+                                 record.bBufferStarved ? 1 : 0);
+  }
+
+  if (file.Write(trace.c_str(), trace.size()) != static_cast<ssize_t>(trace.size()))
+  {
+    CLog::Log(LOGERROR, "SteamLinkVideo: Failed to write latency trace \"%s\"", path.c_str());
+    return false;
+  }
+
+  CLog::Log(LOGDEBUG, "SteamLinkVideo: Wrote %u packets to latency trace \"%s\"", static_cast<unsigned int>(records.size()), path.c_str());
+
+  return true;
+}
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "cores/DataCacheCore.h"
+
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace KODI
+{
+namespace STEAMLINK
+{
+
+/*!
+ * \brief Timestamps of a single packet on its way to the decoder
+ *
+ * Timestamps are in microseconds of the host clock, and are 0 if the packet
+ * didn't reach the stage.
+ */
+struct SteamLinkLatencyRecord
+{
+  int64_t demuxUs = 0; // AddData() received the packet from the demuxer
+  int64_t writeBeginUs = 0; // WriteData() started writing the packet to the decoder
+  int64_t writeEndUs = 0; // The packet was submitted to the decoder
+  double dts = 0.0;
+  uint32_t size = 0;
+  uint32_t queuedMs = 0; // Video queued in the decoder after submitting the packet
+  bool bBufferStarved = false; // No free video buffer was available for the packet
+};
+
+/*!
+ * \brief Ring of the most recent packet timestamps
+ *
+ * Records are added by a single thread (the render thread, which writes
+ * packets to the decoder) and can be read from any thread without blocking
+ * the writer. A reader skips records that are overwritten while it copies
+ * them.
+ */
+class CSteamLinkLatencyTrace
+{
+public:
+  /*!
+   * \brief Create a trace
+   *
+   * \param capacity The number of records kept, rounded up to a power of two
+   */
+  explicit CSteamLinkLatencyTrace(size_t capacity = DEFAULT_CAPACITY);
+
+  /*!
+   * \brief Get the current time, in the units of the trace
+   */
+  static int64_t NowUs();
+
+  /*!
+   * \brief Add a record, overwriting the oldest record if the ring is full
+   *
+   * Must only be called from one thread at a time.
+   */
+  void AddRecord(const SteamLinkLatencyRecord &record);
+
+  /*!
+   * \brief Get a copy of the records in the ring, oldest first
+   */
+  std::vector<SteamLinkLatencyRecord> GetRecords() const;
+
+  /*!
+   * \brief Summarize records as percentiles
+   */
+  static VideoLatencyInfo GetLatency(const std::vector<SteamLinkLatencyRecord> &records);
+
+  /*!
+   * \brief Write the records to a CSV file that can be replayed offline
+   *
+   * \param path The path of the file, overwritten if it exists
+   *
+   * \return True if the file was written, false otherwise
+   */
+  bool Dump(const std::string &path) const;
+
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+private:
+  // The record is copied in words through atomics, so a reader racing with
+  // the writer gets a torn copy that it discards instead of a data race
+  static_assert(std::is_trivially_copyable<SteamLinkLatencyRecord>::value, "Records are copied as words");
+  static constexpr size_t RECORD_WORDS = (sizeof(SteamLinkLatencyRecord) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  struct Slot
+  {
+    // Odd while the record is being written
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> words[RECORD_WORDS];
+  };
+
+  // Construction parameters
+  const size_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+
+  // Ring parameters
+  std::atomic<uint64_t> m_writePosition;
+};
+
+}
+}
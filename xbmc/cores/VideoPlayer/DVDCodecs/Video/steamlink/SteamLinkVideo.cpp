@@ -27,6 +27,8 @@
 #include <utility>
 
 static constexpr const char *STEAMLINK_VIDEO_CODEC_NAME = "SteamLinkVideo";
+static constexpr unsigned int LATENCY_UPDATE_INTERVAL_MS = 1000;
+static constexpr const char *LATENCY_TRACE_PATH = "special://temp/steamlink_video_latency.csv";
 
 using namespace KODI;
 using namespace STEAMLINK;
@@ -195,6 +197,10 @@ void CSteamLinkVideo::Dispose()
 {
   if (m_stream)
   {
+    // Keep a trace of the session for offline analysis
+    if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(LOGVIDEO))
+      m_stream->GetLatencyTrace().Dump(LATENCY_TRACE_PATH);
+
     m_stream->Close();
     {
       CSingleLock lock(m_streamLock);
@@ -230,6 +236,7 @@ bool CSteamLinkVideo::AddData(const DemuxPacket& packet)
   m_buffer.reset();
   m_bufferSize = 0;
   m_dts = packet.dts;
+  m_demuxUs = CSteamLinkLatencyTrace::NowUs();
 
   if (m_convert_bitstream)
   {
@@ -289,11 +296,28 @@ CDVDVideoCodec::VCReturn CSteamLinkVideo::GetPicture(VideoPicture* pVideoPicture
 
   CSteamLinkVideoBuffer* buffer = static_cast<CSteamLinkVideoBuffer*>(m_videoBufferPool->Get());
   buffer->SetBuffer(std::move(m_buffer), m_bufferSize, m_stream);
+  buffer->latencyRecord.demuxUs = m_demuxUs;
+  buffer->latencyRecord.dts = m_dts;
   pVideoPicture->videoBuffer = buffer;
 
+  UpdateLatency();
+
   return VC_PICTURE;
 }
 
+void CSteamLinkVideo::UpdateLatency()
+{
+  if (!m_latencyTimer.IsTimePast())
+    return;
+
+  m_latencyTimer.Set(LATENCY_UPDATE_INTERVAL_MS);
+
+  VideoLatencyInfo latency = CSteamLinkLatencyTrace::GetLatency(m_stream->GetLatencyTrace().GetRecords());
+  latency.decoderDelayMs = m_stream->GetDelayMs();
+
+  m_processInfo.SetVideoLatency(latency);
+}
+
 const char* CSteamLinkVideo::GetName()
 {
   return STEAMLINK_VIDEO_CODEC_NAME;
@@ -12,6 +12,7 @@
 #include "SteamLinkUniqueBuffer.h"
 #include "cores/VideoPlayer/DVDCodecs/Video/DVDVideoCodec.h"
 #include "threads/CriticalSection.h"
+#include "threads/SystemClock.h"
 
 #include <memory>
 #include <stdint.h>
@@ -52,6 +53,11 @@ public:
 private:
   void Dispose();
 
+  /*!
+   * \brief Publish the latency percentiles of the stream once per interval
+   */
+  void UpdateLatency();
+
   std::shared_ptr<CSteamLinkVideoStream> GetStream();
 
   // Steam Link data
@@ -66,6 +72,10 @@ private:
   size_t m_bufferSize = 0;
   double m_dts = 0.0;
 
+  // Latency telemetry
+  int64_t m_demuxUs = 0;
+  XbmcThreads::EndTime m_latencyTimer;
+
   // Bitstream to bytestream (Annex B) conversion support
   bool bitstream_convert_init(void *in_extradata, int in_extrasize);
   bool bitstream_convert(uint8_t* pData, int iSize, uint8_t **poutbuf, int *poutbuf_size);
@@ -31,4 +31,5 @@ void CSteamLinkVideoBuffer::ClearBuffer()
   buffer.reset();
   size = 0;
   stream.reset();
+  latencyRecord = SteamLinkLatencyRecord();
 }
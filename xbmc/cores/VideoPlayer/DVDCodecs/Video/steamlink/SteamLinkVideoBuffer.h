@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "SteamLinkLatencyTrace.h"
 #include "SteamLinkUniqueBuffer.h"
 #include "cores/VideoPlayer/Process/VideoBuffer.h"
 
@@ -34,6 +35,7 @@ public:
   SteamLinkUniqueBuffer buffer;
   size_t size = 0;
   std::shared_ptr<CSteamLinkVideoStream> stream;
+  SteamLinkLatencyRecord latencyRecord;
 };
 
 }
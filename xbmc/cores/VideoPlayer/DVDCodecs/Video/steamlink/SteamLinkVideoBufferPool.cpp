@@ -38,6 +38,10 @@ CVideoBuffer* CSteamLinkVideoBufferPool::Get()
     buf = new CSteamLinkVideoBuffer(*this, id);
     m_all.push_back(buf);
     m_used.push_back(id);
+
+    // Buffers allocated before any was returned only fill the pool. After
+    // that, allocating means the renderer is holding all buffers
+    buf->latencyRecord.bBufferStarved = m_bWarm;
   }
 
   buf->Acquire(GetPtr());
@@ -61,4 +65,5 @@ void CSteamLinkVideoBufferPool::Return(int id)
       ++it;
   }
   m_free.push_back(id);
+  m_bWarm = true;
 }
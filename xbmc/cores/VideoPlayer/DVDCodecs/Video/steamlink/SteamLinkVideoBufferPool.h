@@ -36,6 +36,7 @@ protected:
   std::vector<CSteamLinkVideoBuffer*> m_all;
   std::deque<int> m_used;
   std::deque<int> m_free;
+  bool m_bWarm = false; // A buffer has been returned to the pool
 };
 
 }
@@ -65,34 +65,46 @@ bool CSteamLinkVideoStream::Flush()
   return Open();
 }
 
-bool CSteamLinkVideoStream::WriteData(const uint8_t* data, size_t size)
+bool CSteamLinkVideoStream::WriteData(const uint8_t* data, size_t size, SteamLinkLatencyRecord record /* = SteamLinkLatencyRecord() */)
 {
   uint32_t delayMs = 0;
 
+  record.size = static_cast<uint32_t>(size);
+
   {
     CSingleLock lock(m_streamMutex);
 
     if (m_stream)
     {
+      record.writeBeginUs = CSteamLinkLatencyTrace::NowUs();
+
       if (SLVideo_BeginFrame(m_stream, size) != 0)
       {
         CLog::Log(LOGERROR, "SteamLinkVideo: Failed to begin frame of size %u", size);
+        m_latencyTrace.AddRecord(record);
         return false;
       }
 
       if (SLVideo_WriteFrameData(m_stream, const_cast<uint8_t*>(data), size) != 0)
       {
         CLog::Log(LOGERROR, "SteamLinkVideo: Error writing data of size %u", size);
+        m_latencyTrace.AddRecord(record);
         return false;
       }
 
       if (SLVideo_SubmitFrame(m_stream) != 0)
       {
         CLog::Log(LOGERROR, "SteamLinkVideo: Error submitting frame of size %u", size);
+        m_latencyTrace.AddRecord(record);
         return false;
       }
 
+      record.writeEndUs = CSteamLinkLatencyTrace::NowUs();
+
       delayMs = SLVideo_GetQueuedVideoMS(m_stream);
+      record.queuedMs = delayMs;
+
+      m_latencyTrace.AddRecord(record);
     }
   }
 
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "SteamLinkLatencyTrace.h"
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
 
@@ -37,12 +38,20 @@ public:
 
   bool Flush();
 
-  bool WriteData(const uint8_t* data, size_t size);
+  /*!
+   * \brief Submit a packet to the decoder
+   *
+   * \param record The earlier timestamps of the packet, completed and added
+   *        to the latency trace
+   */
+  bool WriteData(const uint8_t* data, size_t size, SteamLinkLatencyRecord record = SteamLinkLatencyRecord());
 
   void SetSpeed(float speed);
 
   unsigned int GetDelayMs();
 
+  const CSteamLinkLatencyTrace& GetLatencyTrace() const { return m_latencyTrace; }
+
 private:
   // Construction parameters
   CSLVideoContext * const m_pContext;
@@ -55,6 +64,9 @@ private:
   CCriticalSection m_streamMutex;
   XbmcThreads::EndTime m_delay;;
   CCriticalSection m_delayMutex;
+
+  // Latency telemetry
+  CSteamLinkLatencyTrace m_latencyTrace;
 };
 
 }
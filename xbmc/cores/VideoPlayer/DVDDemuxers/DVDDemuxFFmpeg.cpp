@@ -27,9 +27,12 @@
 #include "threads/SystemClock.h"
 #include "threads/SingleLock.h"
 #include "URL.h"
+#include "utils/Crc32.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
+#include "utils/StreamDetails.h"
 #include "utils/URIUtils.h"
+#include "video/VideoInfoTag.h"
 
 #ifdef HAVE_LIBBLURAY
 #include "DVDInputStreams/DVDInputStreamBluray.h"
@@ -49,6 +52,9 @@ extern "C" {
 #include "libavutil/opt.h"
 }
 
+// Keyframe indexes of files without one, kept across sessions
+#define SEEK_INDEX_PATH "special://temp/seekindex/"
+
 
 struct StereoModeConversionMap
 {
@@ -56,6 +62,23 @@ struct StereoModeConversionMap
   const char*          mode;
 };
 
+struct ProbeLimits
+{
+  const char* format;
+  int64_t analyzeDuration; // in AV_TIME_BASE units
+  int64_t probeSize; // in bytes
+};
+
+// Containers that declare their streams in the header only need a short
+// probe to fill in the details, mostly for sparse subtitle streams
+static const struct ProbeLimits FastOpenProbeLimits[] =
+{
+  { "matroska,webm",            1000000, 2 * 1024 * 1024 },
+  { "mov,mp4,m4a,3gp,3g2,mj2",  1000000, 2 * 1024 * 1024 },
+  { "avi",                      2000000, 4 * 1024 * 1024 },
+  {}
+};
+
 // we internally use the matroska string representation of stereoscopic modes.
 // This struct is a conversion map to convert stereoscopic mode values
 // from asf/wmv to the internally used matroska ones
@@ -459,7 +482,28 @@ bool CDVDDemuxFFmpeg::Open(std::shared_ptr<CDVDInputStream> pInput, bool streami
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
   m_bSup = strcmp(m_pFormatContext->iformat->name, "sup") == 0;
 
-  if (m_streaminfo)
+  bool fastOpen = false;
+  if (m_streaminfo && !fileinfo &&
+      !m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD) &&
+      !m_pInput->IsStreamType(DVDSTREAM_TYPE_BLURAY) &&
+      CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_videoFastOpen)
+  {
+    if (IsStreamInfoKnown())
+      fastOpen = true;
+    else
+      SetFastOpenProbeLimits();
+  }
+
+  if (fastOpen)
+  {
+    CLog::Log(LOGDEBUG, "%s - streams match the stored stream details, skipping avformat_find_stream_info", __FUNCTION__);
+
+    // timestamps are made relative to the start time, which is otherwise
+    // estimated by avformat_find_stream_info
+    if (m_pFormatContext->start_time == static_cast<int64_t>(AV_NOPTS_VALUE))
+      m_pFormatContext->start_time = GetStartTimeFromStreams(m_pFormatContext);
+  }
+  else if (m_streaminfo)
   {
     /* to speed up dvd switches, only analyse very short */
     if(m_pInput->IsStreamType(DVDSTREAM_TYPE_DVD))
@@ -569,6 +613,8 @@ bool CDVDDemuxFFmpeg::Open(std::shared_ptr<CDVDInputStream> pInput, bool streami
   m_dtsAtDisplayTime = DVD_NOPTS_VALUE;
   m_startTime = 0;
 
+  LoadSeekIndex();
+
   // seems to be a bug in ffmpeg, hls jumps back to start after a couple of seconds
   // this cures the issue
   if (m_pFormatContext->iformat && strcmp(m_pFormatContext->iformat->name, "hls,applehttp") == 0)
@@ -584,6 +630,8 @@ void CDVDDemuxFFmpeg::Dispose()
   m_pkt.result = -1;
   av_packet_unref(&m_pkt.pkt);
 
+  SaveSeekIndex();
+
   if (m_pFormatContext)
   {
     if (m_ioContext && m_pFormatContext->pb && m_pFormatContext->pb != m_ioContext)
@@ -943,6 +991,18 @@ DemuxPacket* CDVDDemuxFFmpeg::Read()
     {
       ParsePacket(&m_pkt.pkt);
 
+      if (m_seekIndex &&
+          m_pkt.pkt.stream_index == m_seekIndexKey.stream &&
+          (m_pkt.pkt.flags & AV_PKT_FLAG_KEY))
+      {
+        // dts, like the index FFmpeg builds itself
+        int64_t timestamp = m_pkt.pkt.dts;
+        if (timestamp == AV_NOPTS_VALUE)
+          timestamp = m_pkt.pkt.pts;
+        if (timestamp != AV_NOPTS_VALUE)
+          m_seekIndex->Add(timestamp, m_pkt.pkt.pos);
+      }
+
       if (IsProgramChange())
       {
         // update streams
@@ -1938,6 +1998,216 @@ unsigned int CDVDDemuxFFmpeg::HLSSelectProgram()
   return prog;
 }
 
+bool CDVDDemuxFFmpeg::IsStreamInfoKnown()
+{
+  // the stream details of a file that was played or scanned before
+  const CFileItem& item = m_pInput->GetFileItem();
+  if (!item.HasVideoInfoTag())
+    return false;
+
+  return IsStreamInfoKnown(m_pFormatContext, item.GetVideoInfoTag()->m_streamDetails);
+}
+
+bool CDVDDemuxFFmpeg::IsStreamInfoKnown(AVFormatContext* context, const CStreamDetails& details)
+{
+  if (details.GetVideoStreamCount() == 0)
+    return false;
+
+  // without stream info the demuxer relies on the header
+  bool declaresStreams = false;
+  for (const ProbeLimits* limits = FastOpenProbeLimits; limits->format; limits++)
+  {
+    if (strcmp(context->iformat->name, limits->format) == 0)
+      declaresStreams = true;
+  }
+
+  if (!declaresStreams || context->duration <= 0)
+    return false;
+
+  if (context->start_time == static_cast<int64_t>(AV_NOPTS_VALUE) &&
+      GetStartTimeFromStreams(context) == static_cast<int64_t>(AV_NOPTS_VALUE))
+    return false;
+
+  const bool matroska = strncmp(context->iformat->name, "matroska", 8) == 0;
+
+  bool hasVideo = false;
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    AVStream* st = context->streams[i];
+    AVCodecParameters* par = st->codecpar;
+
+    switch (par->codec_type)
+    {
+    case AVMEDIA_TYPE_VIDEO:
+      if (st->disposition & AV_DISPOSITION_ATTACHED_PIC)
+        break;
+
+      SetProfileFromExtradata(par);
+
+      if (par->codec_id == AV_CODEC_ID_NONE || par->width <= 0 || par->height <= 0 ||
+          par->profile == FF_PROFILE_UNKNOWN)
+        return false;
+
+      // the frame rate AddStream picks must be known for refresh rate switching
+      if (!(matroska && st->avg_frame_rate.num > 0 && st->avg_frame_rate.den > 0) &&
+          !(st->r_frame_rate.num > 0 && st->r_frame_rate.den > 0))
+        return false;
+
+      if (par->width == details.GetVideoWidth() && par->height == details.GetVideoHeight())
+        hasVideo = true;
+      break;
+
+    case AVMEDIA_TYPE_AUDIO:
+      if (par->codec_id == AV_CODEC_ID_NONE || par->sample_rate <= 0 || par->channels <= 0)
+        return false;
+      break;
+
+    case AVMEDIA_TYPE_SUBTITLE:
+      if (par->codec_id == AV_CODEC_ID_NONE)
+        return false;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  return hasVideo;
+}
+
+// Hardware decoders select on the profile, which is otherwise only known
+// after avformat_find_stream_info decoded a frame
+void CDVDDemuxFFmpeg::SetProfileFromExtradata(AVCodecParameters* par)
+{
+  if (par->profile != FF_PROFILE_UNKNOWN || par->extradata_size < 4 || par->extradata[0] != 1)
+    return;
+
+  if (par->codec_id == AV_CODEC_ID_H264)
+  {
+    // avcC: version, profile_idc, constraint flags, level_idc
+    const uint8_t* avcc = par->extradata;
+    int profile = avcc[1];
+    if (profile == 66 && (avcc[2] & 0x40))
+      profile |= FF_PROFILE_H264_CONSTRAINED;
+    else if ((profile == 110 || profile == 122 || profile == 244) && (avcc[2] & 0x10))
+      profile |= FF_PROFILE_H264_INTRA;
+    par->profile = profile;
+    par->level = avcc[3];
+  }
+  else if (par->codec_id == AV_CODEC_ID_HEVC && par->extradata_size >= 23)
+  {
+    // hvcC: version, profile space/tier/profile_idc, ..., level_idc at 12
+    par->profile = par->extradata[1] & 0x1f;
+    par->level = par->extradata[12];
+  }
+}
+
+int64_t CDVDDemuxFFmpeg::GetStartTimeFromStreams(const AVFormatContext* context)
+{
+  int64_t startTime = AV_NOPTS_VALUE;
+
+  for (unsigned int i = 0; i < context->nb_streams; i++)
+  {
+    const AVStream* st = context->streams[i];
+    if (st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO && st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
+      continue;
+    if (st->disposition & AV_DISPOSITION_ATTACHED_PIC)
+      continue;
+
+    // an unknown start could be the earliest
+    if (st->start_time == static_cast<int64_t>(AV_NOPTS_VALUE))
+      return AV_NOPTS_VALUE;
+
+    const int64_t streamStart = av_rescale_q(st->start_time, st->time_base, AV_TIME_BASE_Q);
+    if (startTime == static_cast<int64_t>(AV_NOPTS_VALUE) || streamStart < startTime)
+      startTime = streamStart;
+  }
+
+  return startTime;
+}
+
+void CDVDDemuxFFmpeg::SetFastOpenProbeLimits()
+{
+  for (const ProbeLimits* limits = FastOpenProbeLimits; limits->format; limits++)
+  {
+    if (strcmp(m_pFormatContext->iformat->name, limits->format) == 0)
+    {
+      av_opt_set_int(m_pFormatContext, "analyzeduration", limits->analyzeDuration, 0);
+      av_opt_set_int(m_pFormatContext, "probesize", limits->probeSize, 0);
+      return;
+    }
+  }
+}
+
+void CDVDDemuxFFmpeg::LoadSeekIndex()
+{
+  m_seekIndex.reset();
+
+  // live streams grow, and inputs seeking by time don't use the index
+  if (m_pInput->IsRealtime() || m_pInput->GetIPosTime() ||
+      !m_pInput->Seek(0, SEEK_POSSIBLE))
+    return;
+
+  const int64_t size = m_pInput->GetLength();
+  if (size <= 0)
+    return;
+
+  // the stream av_seek_frame seeks in
+  const int streamIdx = av_find_default_stream_index(m_pFormatContext);
+  if (streamIdx < 0)
+    return;
+
+  AVStream* st = m_pFormatContext->streams[streamIdx];
+  if (st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO ||
+      st->time_base.num <= 0 || st->time_base.den <= 0)
+    return;
+
+  // containers with an index of their own don't need ours
+  if (av_index_search_timestamp(st, INT64_MAX, AVSEEK_FLAG_BACKWARD | AVSEEK_FLAG_ANY) >= 0)
+    return;
+
+  const std::string fileName = m_pInput->GetFileName();
+
+  // not every protocol can stat, e.g. pvr recordings, so the size must do
+  struct __stat64 buffer = {};
+  const int64_t mtime = XFILE::CFile::Stat(fileName, &buffer) == 0 ? static_cast<int64_t>(buffer.st_mtime) : 0;
+
+  m_seekIndexKey.path = CURL(fileName).GetWithoutUserDetails();
+  m_seekIndexKey.size = size;
+  m_seekIndexKey.mtime = mtime;
+  m_seekIndexKey.stream = streamIdx;
+  m_seekIndexKey.timeBaseNum = st->time_base.num;
+  m_seekIndexKey.timeBaseDen = st->time_base.den;
+
+  // one entry per second is enough to start a seek close to the target
+  m_seekIndex.reset(new CDemuxSeekIndex(av_rescale(1, st->time_base.den, st->time_base.num)));
+
+  const std::string indexFile = StringUtils::Format(SEEK_INDEX_PATH "%08x.idx", Crc32::Compute(m_seekIndexKey.path));
+  if (!m_seekIndex->Load(indexFile, m_seekIndexKey))
+    return;
+
+  for (const CDemuxSeekIndex::Entry& entry : m_seekIndex->GetEntries())
+    av_add_index_entry(st, entry.pos, entry.timestamp, 0, 0, AVINDEX_KEYFRAME);
+
+  CLog::Log(LOGDEBUG, "%s - loaded %d keyframes of %s", __FUNCTION__,
+            static_cast<int>(m_seekIndex->GetEntries().size()), CURL::GetRedacted(fileName).c_str());
+}
+
+void CDVDDemuxFFmpeg::SaveSeekIndex()
+{
+  if (!m_seekIndex)
+    return;
+
+  if (m_seekIndex->IsModified())
+  {
+    const std::string indexFile = StringUtils::Format(SEEK_INDEX_PATH "%08x.idx", Crc32::Compute(m_seekIndexKey.path));
+    if (!m_seekIndex->Save(indexFile, m_seekIndexKey))
+      CLog::Log(LOGWARNING, "%s - failed to store the keyframes of %s", __FUNCTION__, CURL::GetRedacted(m_seekIndexKey.path).c_str());
+  }
+
+  m_seekIndex.reset();
+}
+
 std::string CDVDDemuxFFmpeg::GetStereoModeFromMetadata(AVDictionary *pMetadata)
 {
   std::string stereoMode;
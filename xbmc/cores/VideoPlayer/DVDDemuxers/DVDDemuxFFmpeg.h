@@ -9,6 +9,7 @@
 #pragma once
 
 #include "DVDDemux.h"
+#include "DemuxSeekIndex.h"
 #include "threads/CriticalSection.h"
 #include "threads/SystemClock.h"
 #include <map>
@@ -20,6 +21,7 @@ extern "C" {
 }
 
 class CDVDDemuxFFmpeg;
+class CStreamDetails;
 class CURL;
 
 class CDemuxStreamVideoFFmpeg : public CDemuxStreamVideo
@@ -104,6 +106,29 @@ public:
 
   bool Aborted();
 
+  /*!
+   * \brief Check if the header of a file declares everything playback needs
+   *
+   * \param context The format context, opened without avformat_find_stream_info()
+   * \param details The stream details stored for the file
+   *
+   * \return True if avformat_find_stream_info() can be skipped, false otherwise
+   */
+  static bool IsStreamInfoKnown(AVFormatContext* context, const CStreamDetails& details);
+
+  /*!
+   * \brief Set the H.264/HEVC profile and level from the avcC/hvcC extradata
+   */
+  static void SetProfileFromExtradata(AVCodecParameters* par);
+
+  /*!
+   * \brief Get the start time of a file from the start times its streams declare
+   *
+   * \return The start time in AV_TIME_BASE units, or AV_NOPTS_VALUE if an
+   *         audio or video stream doesn't declare its start time
+   */
+  static int64_t GetStartTimeFromStreams(const AVFormatContext* context);
+
   AVFormatContext* m_pFormatContext;
   std::shared_ptr<CDVDInputStream> m_pInput;
 
@@ -124,6 +149,10 @@ protected:
   void UpdateCurrentPTS();
   bool IsProgramChange();
   unsigned int HLSSelectProgram();
+  bool IsStreamInfoKnown();
+  void SetFastOpenProbeLimits();
+  void LoadSeekIndex();
+  void SaveSeekIndex();
 
   std::string GetStereoModeFromMetadata(AVDictionary *pMetadata);
   std::string ConvertCodecToInternalStereoMode(const std::string &mode, const StereoModeConversionMap *conversionMap);
@@ -163,5 +192,9 @@ protected:
   double m_dtsAtDisplayTime;
   bool m_seekToKeyFrame = false;
   double m_startTime = 0;
+
+  // Keyframes of a container without an index, recorded while reading
+  std::unique_ptr<CDemuxSeekIndex> m_seekIndex;
+  CDemuxSeekIndex::Key m_seekIndexKey;
 };
 
@@ -0,0 +1,191 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DemuxPacketPool.h"
+#include "cores/VideoPlayer/Interface/Addon/DemuxPacket.h"
+#include "threads/SingleLock.h"
+
+#ifdef TARGET_POSIX
+#include "platform/linux/XMemUtils.h"
+#endif
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include <string.h>
+
+namespace
+{
+// Payloads smaller than this share the smallest size class
+constexpr size_t MIN_CLASS_SIZE = 256;
+
+// Larger payloads aren't pooled
+constexpr size_t MAX_CLASS_SIZE = 16 * 1024 * 1024;
+
+// Limits of the free lists
+constexpr size_t MAX_CACHED_BYTES = 32 * 1024 * 1024;
+constexpr size_t MAX_FREE_PACKETS = 2048;
+
+// The size class is stored in front of the payload, in a header that keeps
+// the payload aligned
+constexpr size_t PAYLOAD_ALIGNMENT = 16;
+constexpr size_t HEADER_SIZE = PAYLOAD_ALIGNMENT;
+}
+
+CDemuxPacketPool::CDemuxPacketPool() :
+  m_freePayloads(MIN_CLASS_SIZE, MAX_CLASS_SIZE)
+{
+}
+
+CDemuxPacketPool::~CDemuxPacketPool()
+{
+  Clear();
+}
+
+CDemuxPacketPool& CDemuxPacketPool::GetInstance()
+{
+  static CDemuxPacketPool pool;
+  return pool;
+}
+
+DemuxPacket* CDemuxPacketPool::Allocate(int dataSize)
+{
+  DemuxPacket* packet = nullptr;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    if (!m_freePackets.empty())
+    {
+      packet = m_freePackets.back();
+      m_freePackets.pop_back();
+    }
+    m_stats.outstanding++;
+  }
+
+  if (!packet)
+    packet = new DemuxPacket();
+
+  if (dataSize > 0)
+  {
+    // FFmpeg's bitstream readers may read past the end of the data, so
+    // the padding needs to be zeroed
+    packet->pData = AllocatePayload(dataSize + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!packet->pData)
+    {
+      Free(packet);
+      return nullptr;
+    }
+
+    memset(packet->pData + dataSize, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+  }
+
+  return packet;
+}
+
+void CDemuxPacketPool::Free(DemuxPacket* packet)
+{
+  if (packet->pData)
+    FreePayload(packet->pData);
+
+  *packet = DemuxPacket();
+
+  {
+    CSingleLock lock(m_critSection);
+
+    m_stats.outstanding--;
+
+    if (m_freePackets.size() < MAX_FREE_PACKETS)
+    {
+      m_freePackets.push_back(packet);
+      return;
+    }
+  }
+
+  delete packet;
+}
+
+void CDemuxPacketPool::Clear()
+{
+  std::vector<uint8_t*> freePayloads;
+  std::vector<DemuxPacket*> freePackets;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    freePayloads = m_freePayloads.PopAll();
+    freePackets.swap(m_freePackets);
+    m_stats.cachedBytes = 0;
+  }
+
+  for (uint8_t* data : freePayloads)
+    _aligned_free(data - HEADER_SIZE);
+
+  for (DemuxPacket* packet : freePackets)
+    delete packet;
+}
+
+CDemuxPacketPool::Stats CDemuxPacketPool::GetStats()
+{
+  CSingleLock lock(m_critSection);
+
+  return m_stats;
+}
+
+uint8_t* CDemuxPacketPool::AllocatePayload(size_t size)
+{
+  const int32_t sizeClass = m_freePayloads.GetSizeClass(size);
+  if (sizeClass >= 0)
+    size = m_freePayloads.GetClassSize(sizeClass);
+
+  {
+    CSingleLock lock(m_critSection);
+
+    m_stats.allocations++;
+
+    uint8_t* data = sizeClass >= 0 ? m_freePayloads.Pop(sizeClass) : nullptr;
+    if (data)
+    {
+      m_stats.cachedBytes -= size;
+      m_stats.reused++;
+      return data;
+    }
+  }
+
+  uint8_t* block = static_cast<uint8_t*>(_aligned_malloc(HEADER_SIZE + size, PAYLOAD_ALIGNMENT));
+  if (!block)
+    return nullptr;
+
+  memcpy(block, &sizeClass, sizeof(sizeClass));
+
+  return block + HEADER_SIZE;
+}
+
+void CDemuxPacketPool::FreePayload(uint8_t* data)
+{
+  uint8_t* block = data - HEADER_SIZE;
+
+  int32_t sizeClass;
+  memcpy(&sizeClass, block, sizeof(sizeClass));
+
+  if (sizeClass >= 0)
+  {
+    CSingleLock lock(m_critSection);
+
+    const size_t size = m_freePayloads.GetClassSize(sizeClass);
+    if (m_stats.cachedBytes + size <= MAX_CACHED_BYTES)
+    {
+      m_freePayloads.Push(sizeClass, data);
+      m_stats.cachedBytes += size;
+      return;
+    }
+  }
+
+  _aligned_free(block);
+}
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+#include "utils/SizeClassFreeList.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct DemuxPacket;
+
+/*!
+ * \brief Recycles demux packets and their payloads
+ *
+ * Every demuxed packet used to cost two heap allocations, which adds up to
+ * thousands per second for high bitrate streams. Freed packets are kept on
+ * free lists instead, payloads in size classes of a quarter power of two,
+ * so a packet of a similar size can reuse them.
+ *
+ * Packets are allocated on the demux thread and freed on the codec
+ * threads, so the pool is thread safe.
+ */
+class CDemuxPacketPool
+{
+public:
+  struct Stats
+  {
+    uint64_t allocations = 0; // Payloads handed out
+    uint64_t reused = 0; // Payloads taken from a free list
+    unsigned int outstanding = 0; // Packets not freed yet
+    size_t cachedBytes = 0; // Bytes held by the free lists
+  };
+
+  CDemuxPacketPool();
+  ~CDemuxPacketPool();
+
+  static CDemuxPacketPool& GetInstance();
+
+  /*!
+   * \brief Get a packet with a payload of at least dataSize bytes
+   *
+   * The payload is 16 byte aligned and followed by zeroed FFmpeg input
+   * padding.
+   *
+   * \return The packet, or nullptr if out of memory
+   */
+  DemuxPacket* Allocate(int dataSize);
+
+  /*!
+   * \brief Return a packet from Allocate() to the pool
+   *
+   * Side data must be freed by the caller.
+   */
+  void Free(DemuxPacket* packet);
+
+  /*!
+   * \brief Release all memory held by the free lists
+   */
+  void Clear();
+
+  Stats GetStats();
+
+private:
+  // No copying
+  CDemuxPacketPool(const CDemuxPacketPool&) = delete;
+  CDemuxPacketPool& operator=(const CDemuxPacketPool&) = delete;
+
+  uint8_t* AllocatePayload(size_t size);
+  void FreePayload(uint8_t* data);
+
+  // Free lists
+  CSizeClassFreeList m_freePayloads;
+  std::vector<DemuxPacket*> m_freePackets;
+
+  Stats m_stats;
+  CCriticalSection m_critSection;
+};
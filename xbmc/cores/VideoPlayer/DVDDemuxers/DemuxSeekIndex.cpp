@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "DemuxSeekIndex.h"
+#include "filesystem/File.h"
+#include "utils/Archive.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Bump when the stored format changes
+#define SEEK_INDEX_VERSION 2
+
+// Stored after the entries. CArchive reads zeros past the end of a file,
+// so a truncated index is only detected by a missing end marker
+#define SEEK_INDEX_END 0x58444e49
+
+// 18 hours at one entry per second
+#define SEEK_INDEX_MAX_ENTRIES 65536
+
+CDemuxSeekIndex::CDemuxSeekIndex(int64_t minDistance) :
+  m_minDistance(std::max(minDistance, static_cast<int64_t>(1)))
+{
+}
+
+bool CDemuxSeekIndex::Add(int64_t timestamp, int64_t pos)
+{
+  if (pos < 0 || m_entries.size() >= SEEK_INDEX_MAX_ENTRIES)
+    return false;
+
+  auto next = std::upper_bound(m_entries.begin(), m_entries.end(), timestamp,
+                               [](int64_t timestamp, const Entry& entry) { return timestamp < entry.timestamp; });
+
+  if (next != m_entries.begin())
+  {
+    const Entry& prev = *(next - 1);
+    if (timestamp - prev.timestamp < m_minDistance || pos <= prev.pos)
+      return false;
+  }
+
+  if (next != m_entries.end())
+  {
+    if (next->timestamp - timestamp < m_minDistance || pos >= next->pos)
+      return false;
+  }
+
+  m_entries.insert(next, Entry{timestamp, pos});
+  m_modified = true;
+  return true;
+}
+
+void CDemuxSeekIndex::Clear()
+{
+  m_entries.clear();
+  m_modified = false;
+}
+
+bool CDemuxSeekIndex::Load(const std::string& file, const Key& key)
+{
+  XFILE::CFile stored;
+  if (!stored.Open(file))
+    return false;
+
+  std::vector<Entry> entries;
+
+  try
+  {
+    CArchive ar(&stored, CArchive::load);
+
+    int version;
+    ar >> version;
+    if (version != SEEK_INDEX_VERSION)
+      return false;
+
+    Key storedKey;
+    ar >> storedKey.path;
+    ar >> storedKey.size;
+    ar >> storedKey.mtime;
+    ar >> storedKey.stream;
+    ar >> storedKey.timeBaseNum;
+    ar >> storedKey.timeBaseDen;
+    if (storedKey.path != key.path ||
+        storedKey.size != key.size ||
+        storedKey.mtime != key.mtime ||
+        storedKey.stream != key.stream ||
+        storedKey.timeBaseNum != key.timeBaseNum ||
+        storedKey.timeBaseDen != key.timeBaseDen)
+      return false;
+
+    unsigned int count;
+    ar >> count;
+    if (count > SEEK_INDEX_MAX_ENTRIES)
+      throw std::out_of_range("seek index size");
+
+    entries.resize(count);
+    for (Entry& entry : entries)
+    {
+      ar >> entry.timestamp;
+      ar >> entry.pos;
+    }
+
+    int end;
+    ar >> end;
+    if (end != SEEK_INDEX_END)
+      throw std::out_of_range("seek index end");
+  }
+  catch (const std::out_of_range&)
+  {
+    CLog::Log(LOGERROR, "CDemuxSeekIndex::%s - corrupt index %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  for (size_t i = 1; i < entries.size(); i++)
+  {
+    if (entries[i].timestamp <= entries[i - 1].timestamp ||
+        entries[i].pos <= entries[i - 1].pos)
+    {
+      CLog::Log(LOGERROR, "CDemuxSeekIndex::%s - unordered index %s", __FUNCTION__, file.c_str());
+      return false;
+    }
+  }
+
+  m_entries.swap(entries);
+  m_modified = false;
+  return true;
+}
+
+bool CDemuxSeekIndex::Save(const std::string& file, const Key& key)
+{
+  XFILE::CFile stored;
+  if (!stored.OpenForWrite(file, true))
+    return false;
+
+  CArchive ar(&stored, CArchive::store);
+  ar << SEEK_INDEX_VERSION;
+  ar << key.path;
+  ar << key.size;
+  ar << key.mtime;
+  ar << key.stream;
+  ar << key.timeBaseNum;
+  ar << key.timeBaseDen;
+  ar << static_cast<unsigned int>(m_entries.size());
+  for (const Entry& entry : m_entries)
+  {
+    ar << entry.timestamp;
+    ar << entry.pos;
+  }
+  ar << SEEK_INDEX_END;
+  ar.Close();
+  stored.Close();
+
+  m_modified = false;
+  return true;
+}
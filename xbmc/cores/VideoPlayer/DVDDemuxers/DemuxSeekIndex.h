@@ -0,0 +1,90 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Keyframe positions of a file, kept across sessions
+ *
+ * Containers without an index, like MPEG-TS recordings or AVI files
+ * without idx1, make FFmpeg search the file for every seek. The demuxer
+ * records the keyframes it reads in this index and stores it in a file,
+ * so the next time the file is played seeks can start from a known
+ * keyframe.
+ *
+ * Timestamps are in the time base of the indexed stream. Entries are
+ * ordered by both timestamp and position.
+ */
+class CDemuxSeekIndex
+{
+public:
+  struct Entry
+  {
+    int64_t timestamp;
+    int64_t pos;
+  };
+
+  /*!
+   * \brief Identifies the file and stream an index belongs to
+   *
+   * A stored index is only used if all fields match.
+   */
+  struct Key
+  {
+    std::string path;
+    int64_t size = 0;
+    int64_t mtime = 0;
+    int stream = -1;
+    int timeBaseNum = 0;
+    int timeBaseDen = 0;
+  };
+
+  /*!
+   * \param minDistance The min timestamp distance between two entries
+   */
+  explicit CDemuxSeekIndex(int64_t minDistance = 0);
+
+  /*!
+   * \brief Add the position of a keyframe
+   *
+   * Keyframes close to an entry, or out of order with the entries around
+   * them, e.g. after a timestamp wrap, are ignored.
+   *
+   * \return true if the entry was added
+   */
+  bool Add(int64_t timestamp, int64_t pos);
+
+  void Clear();
+
+  const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+  /*!
+   * \brief Check if entries were added since the index was loaded or saved
+   */
+  bool IsModified() const { return m_modified; }
+
+  /*!
+   * \brief Replace the entries with the ones stored in a file
+   *
+   * \return false if the file doesn't exist, is corrupt or belongs to
+   *         another key
+   */
+  bool Load(const std::string& file, const Key& key);
+
+  bool Save(const std::string& file, const Key& key);
+
+private:
+  int64_t m_minDistance;
+  std::vector<Entry> m_entries;
+  bool m_modified = false;
+};
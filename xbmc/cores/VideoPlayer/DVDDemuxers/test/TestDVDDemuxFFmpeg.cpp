@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "utils/StreamDetails.h"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+
+namespace
+{
+// avcC of a High profile, level 4.1 stream
+const uint8_t AVCC_HIGH[] = { 0x01, 0x64, 0x00, 0x29, 0xff, 0xe1 };
+
+void SetExtradata(AVCodecParameters* par, const uint8_t* data, int size)
+{
+  av_freep(&par->extradata);
+  par->extradata = static_cast<uint8_t*>(av_mallocz(size + AV_INPUT_BUFFER_PADDING_SIZE));
+  std::memcpy(par->extradata, data, size);
+  par->extradata_size = size;
+}
+
+class TestDVDDemuxFFmpegFastOpen : public testing::Test
+{
+protected:
+  TestDVDDemuxFFmpegFastOpen()
+  {
+    m_context = avformat_alloc_context();
+    m_context->iformat = av_find_input_format("matroska");
+    m_context->duration = 60 * AV_TIME_BASE;
+
+    m_video = avformat_new_stream(m_context, nullptr);
+    m_video->time_base = AVRational{ 1, 1000 };
+    m_video->start_time = 500;
+    m_video->avg_frame_rate = AVRational{ 24000, 1001 };
+    m_video->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    m_video->codecpar->codec_id = AV_CODEC_ID_H264;
+    m_video->codecpar->width = 1920;
+    m_video->codecpar->height = 1080;
+    SetExtradata(m_video->codecpar, AVCC_HIGH, sizeof(AVCC_HIGH));
+
+    m_audio = avformat_new_stream(m_context, nullptr);
+    m_audio->time_base = AVRational{ 1, 1000 };
+    m_audio->start_time = 480;
+    m_audio->codecpar->codec_type = AVMEDIA_TYPE_AUDIO;
+    m_audio->codecpar->codec_id = AV_CODEC_ID_AC3;
+    m_audio->codecpar->sample_rate = 48000;
+    m_audio->codecpar->channels = 6;
+
+    CStreamDetailVideo* video = new CStreamDetailVideo();
+    video->m_iWidth = 1920;
+    video->m_iHeight = 1080;
+    m_details.AddStream(video);
+    m_details.DetermineBestStreams();
+  }
+
+  ~TestDVDDemuxFFmpegFastOpen() override
+  {
+    avformat_free_context(m_context);
+  }
+
+  AVFormatContext* m_context;
+  AVStream* m_video;
+  AVStream* m_audio;
+  CStreamDetails m_details;
+};
+}
+
+TEST(TestDVDDemuxFFmpeg, SetProfileFromExtradata)
+{
+  AVCodecParameters* par = avcodec_parameters_alloc();
+
+  par->codec_id = AV_CODEC_ID_H264;
+  SetExtradata(par, AVCC_HIGH, sizeof(AVCC_HIGH));
+  CDVDDemuxFFmpeg::SetProfileFromExtradata(par);
+  EXPECT_EQ(par->profile, FF_PROFILE_H264_HIGH);
+  EXPECT_EQ(par->level, 41);
+
+  // Constrained baseline
+  const uint8_t baseline[] = { 0x01, 0x42, 0x40, 0x1e };
+  par->profile = FF_PROFILE_UNKNOWN;
+  SetExtradata(par, baseline, sizeof(baseline));
+  CDVDDemuxFFmpeg::SetProfileFromExtradata(par);
+  EXPECT_EQ(par->profile, FF_PROFILE_H264_CONSTRAINED_BASELINE);
+  EXPECT_EQ(par->level, 30);
+
+  // Annex B start code instead of avcC, and a truncated avcC
+  const uint8_t annexB[] = { 0x00, 0x00, 0x00, 0x01, 0x67, 0x64 };
+  par->profile = FF_PROFILE_UNKNOWN;
+  SetExtradata(par, annexB, sizeof(annexB));
+  CDVDDemuxFFmpeg::SetProfileFromExtradata(par);
+  EXPECT_EQ(par->profile, FF_PROFILE_UNKNOWN);
+
+  SetExtradata(par, AVCC_HIGH, 3);
+  CDVDDemuxFFmpeg::SetProfileFromExtradata(par);
+  EXPECT_EQ(par->profile, FF_PROFILE_UNKNOWN);
+
+  // hvcC of a Main 10 profile, level 5.1 stream
+  uint8_t hvcc[23] = { 0x01, 0x02 };
+  hvcc[12] = 153;
+  par->codec_id = AV_CODEC_ID_HEVC;
+  SetExtradata(par, hvcc, sizeof(hvcc));
+  CDVDDemuxFFmpeg::SetProfileFromExtradata(par);
+  EXPECT_EQ(par->profile, FF_PROFILE_HEVC_MAIN_10);
+  EXPECT_EQ(par->level, 153);
+
+  // A profile from the header is kept
+  par->profile = FF_PROFILE_HEVC_MAIN;
+  CDVDDemuxFFmpeg::SetProfileFromExtradata(par);
+  EXPECT_EQ(par->profile, FF_PROFILE_HEVC_MAIN);
+
+  avcodec_parameters_free(&par);
+}
+
+TEST_F(TestDVDDemuxFFmpegFastOpen, Known)
+{
+  EXPECT_TRUE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+  EXPECT_EQ(m_video->codecpar->profile, FF_PROFILE_H264_HIGH);
+
+  // The earliest stream
+  EXPECT_EQ(CDVDDemuxFFmpeg::GetStartTimeFromStreams(m_context), 480000);
+}
+
+TEST_F(TestDVDDemuxFFmpegFastOpen, Unknown)
+{
+  // Not played or scanned before, or played at another resolution
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, CStreamDetails()));
+
+  m_video->codecpar->width = 1280;
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+  m_video->codecpar->width = 1920;
+
+  // A container that doesn't declare its streams
+  m_context->iformat = av_find_input_format("mpegts");
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+  m_context->iformat = av_find_input_format("matroska");
+
+  // Stream parameters only avformat_find_stream_info would find
+  m_audio->codecpar->sample_rate = 0;
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+  m_audio->codecpar->sample_rate = 48000;
+
+  m_video->avg_frame_rate = AVRational{ 0, 1 };
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+  m_video->avg_frame_rate = AVRational{ 24000, 1001 };
+
+  m_video->codecpar->profile = FF_PROFILE_UNKNOWN;
+  SetExtradata(m_video->codecpar, AVCC_HIGH, 3);
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+  SetExtradata(m_video->codecpar, AVCC_HIGH, sizeof(AVCC_HIGH));
+
+  // Timestamps are made relative to the start time
+  m_audio->start_time = AV_NOPTS_VALUE;
+  EXPECT_EQ(CDVDDemuxFFmpeg::GetStartTimeFromStreams(m_context), static_cast<int64_t>(AV_NOPTS_VALUE));
+  EXPECT_FALSE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+
+  m_context->start_time = 0;
+  EXPECT_TRUE(CDVDDemuxFFmpeg::IsStreamInfoKnown(m_context, m_details));
+}
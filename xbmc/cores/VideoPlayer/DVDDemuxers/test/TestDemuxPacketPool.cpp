@@ -0,0 +1,163 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DemuxPacketPool.h"
+#include "cores/VideoPlayer/Interface/Addon/DemuxPacket.h"
+#include "test/BenchmarkUtils.h"
+
+#ifdef TARGET_POSIX
+#include "platform/linux/XMemUtils.h"
+#endif
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // The allocation before the pool, for comparison
+  DemuxPacket* AllocateUnpooled(int dataSize)
+  {
+    DemuxPacket* packet = new DemuxPacket();
+    packet->pData = static_cast<uint8_t*>(_aligned_malloc(dataSize + AV_INPUT_BUFFER_PADDING_SIZE, 16));
+    memset(packet->pData + dataSize, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    return packet;
+  }
+
+  void FreeUnpooled(DemuxPacket* packet)
+  {
+    _aligned_free(packet->pData);
+    delete packet;
+  }
+
+  /*!
+   * \brief Allocate packets on a demuxer thread and free them on a player
+   *        thread, as VideoPlayer does
+   *
+   * \return The mean time per packet, in microseconds
+   */
+  template<typename A, typename F>
+  double DemuxAndPlay(A allocate, F release)
+  {
+    constexpr unsigned int PACKET_COUNT = 200000;
+    constexpr unsigned int QUEUED_PACKETS = 256;
+
+    // Audio, transport stream and video packet sizes
+    const int sizes[] = { 1536, 188 * 7, 40000, 3000, 250000, 1536, 12000 };
+    const unsigned int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+
+    std::vector<std::atomic<DemuxPacket*>> queue(QUEUED_PACKETS);
+    for (auto& packet : queue)
+      packet = nullptr;
+
+    return CBenchmarkUtils::MeanUs(1, [&]()
+    {
+      std::thread player([&queue, &release]()
+      {
+        for (unsigned int j = 0; j < PACKET_COUNT; j++)
+        {
+          DemuxPacket* packet;
+          while ((packet = queue[j % QUEUED_PACKETS].exchange(nullptr)) == nullptr)
+            std::this_thread::yield();
+          release(packet);
+        }
+      });
+
+      for (unsigned int i = 0; i < PACKET_COUNT; i++)
+      {
+        DemuxPacket* packet = allocate(sizes[i % sizeCount]);
+        while (queue[i % QUEUED_PACKETS].load() != nullptr)
+          std::this_thread::yield();
+        queue[i % QUEUED_PACKETS] = packet;
+      }
+
+      player.join();
+    }) / PACKET_COUNT;
+  }
+}
+
+TEST(TestDemuxPacketPool, Allocate)
+{
+  CDemuxPacketPool pool;
+
+  DemuxPacket* packet = pool.Allocate(1000);
+  ASSERT_NE(packet, nullptr);
+  ASSERT_NE(packet->pData, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(packet->pData) % 16, 0u);
+  EXPECT_EQ(packet->iStreamId, -1);
+
+  for (int i = 0; i < AV_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(packet->pData[1000 + i], 0);
+
+  DemuxPacket* empty = pool.Allocate(0);
+  ASSERT_NE(empty, nullptr);
+  EXPECT_EQ(empty->pData, nullptr);
+
+  EXPECT_EQ(pool.GetStats().outstanding, 2u);
+
+  pool.Free(packet);
+  pool.Free(empty);
+  EXPECT_EQ(pool.GetStats().outstanding, 0u);
+}
+
+TEST(TestDemuxPacketPool, Reuse)
+{
+  CDemuxPacketPool pool;
+
+  DemuxPacket* packet = pool.Allocate(1000);
+  ASSERT_NE(packet, nullptr);
+  uint8_t* data = packet->pData;
+  memset(data, 0xff, 1000 + AV_INPUT_BUFFER_PADDING_SIZE);
+  packet->iStreamId = 1;
+  pool.Free(packet);
+  EXPECT_GT(pool.GetStats().cachedBytes, 0u);
+
+  // A similar size uses the same size class, and the packet is reset
+  packet = pool.Allocate(1010);
+  ASSERT_NE(packet, nullptr);
+  EXPECT_EQ(packet->pData, data);
+  EXPECT_EQ(packet->iStreamId, -1);
+  for (int i = 0; i < AV_INPUT_BUFFER_PADDING_SIZE; i++)
+    EXPECT_EQ(packet->pData[1010 + i], 0);
+
+  CDemuxPacketPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.allocations, 2u);
+  EXPECT_EQ(stats.reused, 1u);
+  EXPECT_EQ(stats.cachedBytes, 0u);
+
+  // A much larger one doesn't
+  DemuxPacket* large = pool.Allocate(100000);
+  ASSERT_NE(large, nullptr);
+  EXPECT_NE(large->pData, data);
+
+  pool.Free(packet);
+  pool.Free(large);
+
+  pool.Clear();
+  EXPECT_EQ(pool.GetStats().cachedBytes, 0u);
+}
+
+TEST(TestDemuxPacketPool, DISABLED_AllocationCost)
+{
+  CDemuxPacketPool pool;
+
+  const double pooledUs = DemuxAndPlay([&pool](int dataSize) { return pool.Allocate(dataSize); },
+                                       [&pool](DemuxPacket* packet) { pool.Free(packet); });
+  const double unpooledUs = DemuxAndPlay(AllocateUnpooled, FreeUnpooled);
+
+  CBenchmarkUtils::Report("pooled", pooledUs, "us/packet");
+  CBenchmarkUtils::Report("unpooled", unpooledUs, "us/packet");
+}
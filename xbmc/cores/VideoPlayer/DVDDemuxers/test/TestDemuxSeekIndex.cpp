@@ -0,0 +1,192 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DemuxSeekIndex.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+TEST(TestDemuxSeekIndex, Add)
+{
+  CDemuxSeekIndex index(10);
+
+  EXPECT_TRUE(index.Add(100, 1000));
+  EXPECT_TRUE(index.Add(300, 3000));
+  EXPECT_TRUE(index.Add(200, 2000));
+  EXPECT_TRUE(index.IsModified());
+
+  // Already known, or too close to an entry
+  EXPECT_FALSE(index.Add(200, 2000));
+  EXPECT_FALSE(index.Add(205, 2050));
+  EXPECT_FALSE(index.Add(295, 2950));
+
+  // Not a valid position
+  EXPECT_FALSE(index.Add(400, -1));
+
+  const std::vector<CDemuxSeekIndex::Entry>& entries = index.GetEntries();
+  ASSERT_EQ(entries.size(), 3u);
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    EXPECT_EQ(entries[i].timestamp, static_cast<int64_t>(i + 1) * 100);
+    EXPECT_EQ(entries[i].pos, static_cast<int64_t>(i + 1) * 1000);
+  }
+
+  index.Clear();
+  EXPECT_TRUE(index.GetEntries().empty());
+  EXPECT_FALSE(index.IsModified());
+}
+
+TEST(TestDemuxSeekIndex, Unordered)
+{
+  CDemuxSeekIndex index(10);
+
+  EXPECT_TRUE(index.Add(100, 1000));
+  EXPECT_TRUE(index.Add(300, 3000));
+
+  // Timestamps that went backwards, e.g. after a wrap
+  EXPECT_FALSE(index.Add(50, 5000));
+  EXPECT_FALSE(index.Add(200, 500));
+  EXPECT_FALSE(index.Add(200, 3500));
+  EXPECT_FALSE(index.Add(400, 2000));
+
+  EXPECT_EQ(index.GetEntries().size(), 2u);
+}
+
+namespace
+{
+CDemuxSeekIndex::Key GetKey()
+{
+  CDemuxSeekIndex::Key key;
+  key.path = "/path/to/recording.ts";
+  key.size = 1000000;
+  key.mtime = 1500000000;
+  key.stream = 0;
+  key.timeBaseNum = 1;
+  key.timeBaseDen = 90000;
+  return key;
+}
+}
+
+class TestDemuxSeekIndexFile : public testing::Test
+{
+protected:
+  TestDemuxSeekIndexFile()
+  {
+    m_file = XBMC_CREATETEMPFILE("");
+    if (m_file)
+    {
+      m_file->Close();
+      m_path = XBMC_TEMPFILEPATH(m_file);
+    }
+  }
+
+  ~TestDemuxSeekIndexFile() override
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  void SaveIndex()
+  {
+    CDemuxSeekIndex index(10);
+    for (int i = 1; i <= 100; i++)
+      index.Add(i * 100, i * 1000);
+    ASSERT_TRUE(index.Save(m_path, GetKey()));
+    EXPECT_FALSE(index.IsModified());
+  }
+
+  XFILE::CFile *m_file = nullptr;
+  std::string m_path;
+};
+
+TEST_F(TestDemuxSeekIndexFile, SaveLoad)
+{
+  ASSERT_NE(nullptr, m_file);
+  SaveIndex();
+
+  CDemuxSeekIndex index;
+  ASSERT_TRUE(index.Load(m_path, GetKey()));
+  EXPECT_FALSE(index.IsModified());
+
+  const std::vector<CDemuxSeekIndex::Entry>& entries = index.GetEntries();
+  ASSERT_EQ(entries.size(), 100u);
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    EXPECT_EQ(entries[i].timestamp, static_cast<int64_t>(i + 1) * 100);
+    EXPECT_EQ(entries[i].pos, static_cast<int64_t>(i + 1) * 1000);
+  }
+}
+
+TEST_F(TestDemuxSeekIndexFile, KeyMismatch)
+{
+  ASSERT_NE(nullptr, m_file);
+  SaveIndex();
+
+  CDemuxSeekIndex index;
+  CDemuxSeekIndex::Key key;
+
+  // The file was replaced or modified
+  key = GetKey();
+  key.size++;
+  EXPECT_FALSE(index.Load(m_path, key));
+
+  key = GetKey();
+  key.mtime++;
+  EXPECT_FALSE(index.Load(m_path, key));
+
+  // Another stream, or timestamps in another time base
+  key = GetKey();
+  key.stream = 1;
+  EXPECT_FALSE(index.Load(m_path, key));
+
+  key = GetKey();
+  key.timeBaseDen = 1000;
+  EXPECT_FALSE(index.Load(m_path, key));
+
+  EXPECT_TRUE(index.GetEntries().empty());
+}
+
+TEST_F(TestDemuxSeekIndexFile, Corrupt)
+{
+  ASSERT_NE(nullptr, m_file);
+  SaveIndex();
+
+  std::vector<uint8_t> data;
+  {
+    XFILE::CFile file;
+    ASSERT_TRUE(file.Open(m_path));
+    data.resize(static_cast<size_t>(file.GetLength()));
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), file.Read(data.data(), data.size()));
+  }
+  ASSERT_GT(data.size(), 100u);
+
+  CDemuxSeekIndex index;
+  XFILE::CFile file;
+
+  // Truncated in the entries, and right after the header
+  const size_t sizes[] = { data.size() - 4, data.size() / 2, 64 };
+  for (size_t size : sizes)
+  {
+    ASSERT_TRUE(file.OpenForWrite(m_path, true));
+    ASSERT_EQ(static_cast<ssize_t>(size), file.Write(data.data(), size));
+    file.Close();
+    EXPECT_FALSE(index.Load(m_path, GetKey())) << "truncated to " << size;
+  }
+
+  // Garbage
+  std::vector<uint8_t> garbage(data.size(), 0xa5);
+  ASSERT_TRUE(file.OpenForWrite(m_path, true));
+  file.Write(garbage.data(), garbage.size());
+  file.Close();
+  EXPECT_FALSE(index.Load(m_path, GetKey()));
+
+  EXPECT_TRUE(index.GetEntries().empty());
+}
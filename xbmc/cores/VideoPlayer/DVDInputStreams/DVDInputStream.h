@@ -186,6 +186,7 @@ public:
   virtual ITimes* GetITimes() { return nullptr; }
 
   const CVariant &GetProperty(const std::string key){ return m_item.GetProperty(key); }
+  const CFileItem& GetFileItem() const { return m_item; }
 
 protected:
   DVDStreamType m_streamType;
@@ -13,6 +13,42 @@
 #include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
 #include "math.h"
 
+void CDVDMessageRing::PushFront(CDVDMsg* msg)
+{
+  if (m_count == m_buffer.size())
+    Grow();
+
+  m_head = (m_head - 1) & (m_buffer.size() - 1);
+  m_buffer[m_head] = msg->Acquire();
+  m_count++;
+}
+
+void CDVDMessageRing::PushBack(CDVDMsg* msg)
+{
+  if (m_count == m_buffer.size())
+    Grow();
+
+  m_buffer[(m_head + m_count) & (m_buffer.size() - 1)] = msg->Acquire();
+  m_count++;
+}
+
+CDVDMsg* CDVDMessageRing::PopBack()
+{
+  CDVDMsg* msg = Back();
+  m_count--;
+  return msg;
+}
+
+void CDVDMessageRing::Grow()
+{
+  std::vector<CDVDMsg*> buffer(std::max<size_t>(64, m_buffer.size() * 2));
+  for (size_t i = 0; i < m_count; i++)
+    buffer[i] = At(i);
+
+  m_buffer.swap(buffer);
+  m_head = 0;
+}
+
 CDVDMessageQueue::CDVDMessageQueue(const std::string &owner) : m_hEvent(true), m_owner(owner)
 {
   m_iDataSize     = 0;
@@ -45,8 +81,8 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 {
   CSingleLock lock(m_section);
 
-  m_messages.remove_if([type](const DVDMessageListItem &item){
-    return type == CDVDMsg::NONE || item.message->IsType(type);
+  m_messages.RemoveIf([type](CDVDMsg* msg){
+    return type == CDVDMsg::NONE || msg->IsType(type);
   });
 
   m_prioMessages.remove_if([type](const DVDMessageListItem &item){
@@ -122,7 +158,7 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
   }
   else
   {
-    if (m_messages.empty())
+    if (m_messages.Empty())
     {
       m_iDataSize = 0;
       m_TimeBack = DVD_NOPTS_VALUE;
@@ -130,9 +166,9 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
     }
 
     if (front)
-      m_messages.emplace_front(pMsg, priority);
+      m_messages.PushFront(pMsg);
     else
-      m_messages.emplace_back(pMsg, priority);
+      m_messages.PushBack(pMsg);
   }
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
@@ -150,8 +186,10 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority, bool front
 
   pMsg->Release();
 
-  // inform waiter for new packet
-  m_hEvent.Set();
+  // inform waiter for new packet, setting the event is skipped when nobody
+  // waits as it's the larger part of the cost of a put
+  if (m_waiters > 0)
+    m_hEvent.Set();
 
   return MSGQ_OK;
 }
@@ -172,29 +210,41 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    std::list<DVDMessageListItem> &msgs = (priority > 0 || !m_prioMessages.empty()) ? m_prioMessages : m_messages;
+    if (priority > 0 || !m_prioMessages.empty())
+    {
+      if (!m_prioMessages.empty() && (m_prioMessages.back().priority >= priority || m_drain))
+      {
+        DVDMessageListItem& item(m_prioMessages.back());
+        priority = item.priority;
 
-    if (!msgs.empty() && (msgs.back().priority >= priority || m_drain))
+        *pMsg = item.message->Acquire();
+        m_prioMessages.pop_back();
+        ret = MSGQ_OK;
+        break;
+      }
+    }
+    else if (!m_messages.Empty())
     {
-      DVDMessageListItem& item(msgs.back());
-      priority = item.priority;
+      priority = 0;
 
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
+      // the queue's reference goes to the caller
+      *pMsg = m_messages.PopBack();
+
+      if ((*pMsg)->IsType(CDVDMsg::DEMUXER_PACKET))
       {
-        DemuxPacket* packet = static_cast<CDVDMsgDemuxerPacket*>(item.message)->GetPacket();
+        DemuxPacket* packet = static_cast<CDVDMsgDemuxerPacket*>(*pMsg)->GetPacket();
         if (packet)
         {
           m_iDataSize -= packet->iSize;
         }
       }
 
-      *pMsg = item.message->Acquire();
-      msgs.pop_back();
       UpdateTimeBack();
       ret = MSGQ_OK;
       break;
     }
-    else if (!iTimeoutInMilliSeconds)
+
+    if (!iTimeoutInMilliSeconds)
     {
       ret = MSGQ_TIMEOUT;
       break;
@@ -202,13 +252,17 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     else
     {
       m_hEvent.Reset();
+      m_waiters++;
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
 
       lock.Enter();
+      m_waiters--;
+
+      if (!signaled)
+        return MSGQ_TIMEOUT;
     }
   }
 
@@ -220,12 +274,12 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
 void CDVDMessageQueue::UpdateTimeFront()
 {
-  if (!m_messages.empty())
+  if (!m_messages.Empty())
   {
-    auto &item = m_messages.front();
-    if (item.message->IsType(CDVDMsg::DEMUXER_PACKET))
+    CDVDMsg* msg = m_messages.Front();
+    if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
     {
-      DemuxPacket* packet = static_cast<CDVDMsgDemuxerPacket*>(item.message)->GetPacket();
+      DemuxPacket* packet = static_cast<CDVDMsgDemuxerPacket*>(msg)->GetPacket();
       if (packet)
       {
         if (packet->dts != DVD_NOPTS_VALUE)
@@ -242,12 +296,12 @@ void CDVDMessageQueue::UpdateTimeFront()
 
 void CDVDMessageQueue::UpdateTimeBack()
 {
-  if (!m_messages.empty())
+  if (!m_messages.Empty())
   {
-    auto &item = m_messages.back();
-    if (item.message->IsType(CDVDMsg::DEMUXER_PACKET))
+    CDVDMsg* msg = m_messages.Back();
+    if (msg->IsType(CDVDMsg::DEMUXER_PACKET))
     {
-      DemuxPacket* packet = static_cast<CDVDMsgDemuxerPacket*>(item.message)->GetPacket();
+      DemuxPacket* packet = static_cast<CDVDMsgDemuxerPacket*>(msg)->GetPacket();
       if (packet)
       {
         if (packet->dts != DVD_NOPTS_VALUE)
@@ -270,9 +324,9 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
     return 0;
 
   unsigned count = 0;
-  for (const auto &item : m_messages)
+  for (size_t i = 0; i < m_messages.Size(); i++)
   {
-    if(item.message->IsType(type))
+    if(m_messages.At(i)->IsType(type))
       count++;
   }
   for (const auto &item : m_prioMessages)
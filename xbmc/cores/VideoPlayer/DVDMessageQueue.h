@@ -12,6 +12,7 @@
 #include <atomic>
 #include <string>
 #include <list>
+#include <vector>
 #include <algorithm>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
@@ -41,6 +42,59 @@ struct DVDMessageListItem
   int priority;
 };
 
+/**
+ * Ring buffer of messages, holding a reference to each.
+ * Front is the newest message and back the oldest, like the list it
+ * replaces. The buffer only grows, so steady streaming doesn't allocate.
+ */
+class CDVDMessageRing
+{
+public:
+  CDVDMessageRing() = default;
+  CDVDMessageRing(const CDVDMessageRing&) = delete;
+  CDVDMessageRing& operator=(const CDVDMessageRing&) = delete;
+  ~CDVDMessageRing() { Clear(); }
+
+  bool Empty() const { return m_count == 0; }
+  size_t Size() const { return m_count; }
+
+  void PushFront(CDVDMsg* msg);
+  void PushBack(CDVDMsg* msg);
+  CDVDMsg* Front() const { return m_buffer[m_head]; }
+  CDVDMsg* Back() const { return At(m_count - 1); }
+
+  /**
+   * Remove the oldest message, the reference goes to the caller
+   */
+  CDVDMsg* PopBack();
+
+  CDVDMsg* At(size_t index) const { return m_buffer[(m_head + index) & (m_buffer.size() - 1)]; }
+
+  template<typename Pred>
+  void RemoveIf(Pred pred)
+  {
+    size_t kept = 0;
+    for (size_t i = 0; i < m_count; i++)
+    {
+      CDVDMsg* msg = At(i);
+      if (pred(msg))
+        msg->Release();
+      else
+        m_buffer[(m_head + kept++) & (m_buffer.size() - 1)] = msg;
+    }
+    m_count = kept;
+  }
+
+  void Clear() { RemoveIf([](CDVDMsg*){ return true; }); }
+
+private:
+  void Grow();
+
+  std::vector<CDVDMsg*> m_buffer; // Size is a power of 2
+  size_t m_head = 0;
+  size_t m_count = 0;
+};
+
 enum MsgQueueReturnCode
 {
   MSGQ_OK = 1,
@@ -104,6 +158,7 @@ private:
 
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
+  int m_waiters = 0; // Get() calls waiting for a message
 
   std::atomic<bool> m_bAbortRequest;
   bool m_bInitialized;
@@ -117,7 +172,7 @@ private:
   int m_iMaxDataSize;
   std::string m_owner;
 
-  std::list<DVDMessageListItem> m_messages;
+  CDVDMessageRing m_messages;
   std::list<DVDMessageListItem> m_prioMessages;
 };
 
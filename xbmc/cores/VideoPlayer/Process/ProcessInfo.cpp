@@ -71,6 +71,7 @@ void CProcessInfo::ResetVideoCodecInfo()
   m_videoFPS = 0.0;
   m_videoDAR = 0.0;
   m_videoIsInterlaced = false;
+  m_videoLatency = VideoLatencyInfo();
   m_deintMethods.clear();
   m_deintMethods.push_back(EINTERLACEMETHOD::VS_INTERLACEMETHOD_NONE);
   m_deintMethodDefault = EINTERLACEMETHOD::VS_INTERLACEMETHOD_NONE;
@@ -84,6 +85,7 @@ void CProcessInfo::ResetVideoCodecInfo()
     m_dataCache->SetVideoDimensions(m_videoWidth, m_videoHeight);
     m_dataCache->SetVideoFps(m_videoFPS);
     m_dataCache->SetVideoDAR(m_videoDAR);
+    m_dataCache->SetVideoLatency(m_videoLatency);
     m_dataCache->SetStateSeeking(m_stateSeeking);
     m_dataCache->SetVideoStereoMode(m_videoStereoMode);
   }
@@ -232,6 +234,23 @@ bool CProcessInfo::GetVideoInterlaced()
   return m_videoIsInterlaced;
 }
 
+void CProcessInfo::SetVideoLatency(const VideoLatencyInfo &latency)
+{
+  CSingleLock lock(m_videoCodecSection);
+
+  m_videoLatency = latency;
+
+  if (m_dataCache)
+    m_dataCache->SetVideoLatency(m_videoLatency);
+}
+
+VideoLatencyInfo CProcessInfo::GetVideoLatency()
+{
+  CSingleLock lock(m_videoCodecSection);
+
+  return m_videoLatency;
+}
+
 EINTERLACEMETHOD CProcessInfo::GetFallbackDeintMethod()
 {
   return VS_INTERLACEMETHOD_DEINTERLACE;
@@ -655,6 +674,21 @@ int64_t CProcessInfo::GetMaxTime()
   return m_timeMax;
 }
 
+void CProcessInfo::SetTimeToFirstFrame(unsigned int ms)
+{
+  CSingleLock lock(m_stateSection);
+  m_timeToFirstFrame = ms;
+
+  if (m_dataCache)
+    m_dataCache->SetTimeToFirstFrame(ms);
+}
+
+unsigned int CProcessInfo::GetTimeToFirstFrame()
+{
+  CSingleLock lock(m_stateSection);
+  return m_timeToFirstFrame;
+}
+
 //******************************************************************************
 // settings
 //******************************************************************************
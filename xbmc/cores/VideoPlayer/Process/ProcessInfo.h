@@ -9,6 +9,7 @@
 #pragma once
 
 #include "VideoBuffer.h"
+#include "cores/DataCacheCore.h"
 #include "cores/VideoSettings.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderInfo.h"
 #include "threads/CriticalSection.h"
@@ -18,7 +19,6 @@
 #include <string>
 
 class CProcessInfo;
-class CDataCacheCore;
 
 using CreateProcessControl = CProcessInfo* (*)();
 
@@ -49,6 +49,8 @@ public:
   float GetVideoDAR();
   void SetVideoInterlaced(bool interlaced);
   bool GetVideoInterlaced();
+  void SetVideoLatency(const VideoLatencyInfo &latency);
+  VideoLatencyInfo GetVideoLatency();
   virtual EINTERLACEMETHOD GetFallbackDeintMethod();
   virtual void SetSwDeinterlacingMethods();
   void UpdateDeinterlacingMethods(std::list<EINTERLACEMETHOD> &methods);
@@ -104,6 +106,8 @@ public:
 
   void SetPlayTimes(time_t start, int64_t current, int64_t min, int64_t max);
   int64_t GetMaxTime();
+  void SetTimeToFirstFrame(unsigned int ms);
+  unsigned int GetTimeToFirstFrame();
 
   // settings
   CVideoSettings GetVideoSettings();
@@ -126,6 +130,7 @@ protected:
   float m_videoFPS;
   float m_videoDAR;
   bool m_videoIsInterlaced;
+  VideoLatencyInfo m_videoLatency;
   std::list<EINTERLACEMETHOD> m_deintMethods;
   EINTERLACEMETHOD m_deintMethodDefault;
   CCriticalSection m_videoCodecSection;
@@ -163,6 +168,7 @@ protected:
   int64_t m_timeMax;
   int64_t m_timeMin;
   bool m_realTimeStream;
+  unsigned int m_timeToFirstFrame = 0;
 
   // settings
   CCriticalSection m_settingsSection;
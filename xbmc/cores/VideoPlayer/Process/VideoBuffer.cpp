@@ -7,7 +7,9 @@
  */
 
 #include "VideoBuffer.h"
+#include "VideoBufferAllocator.h"
 #include "threads/SingleLock.h"
+#include "utils/log.h"
 #include <string.h>
 
 //-----------------------------------------------------------------------------
@@ -179,7 +181,7 @@ CVideoBufferSysMem::CVideoBufferSysMem(IVideoBufferPool &pool, int id, AVPixelFo
 
 CVideoBufferSysMem::~CVideoBufferSysMem()
 {
-  delete[] m_data;
+  CVideoBufferAllocator::GetInstance().Free(m_data, m_size);
 }
 
 uint8_t* CVideoBufferSysMem::GetMemPtr()
@@ -265,8 +267,8 @@ void CVideoBufferSysMem::SetDimensions(int width, int height, const int (&stride
 
 bool CVideoBufferSysMem::Alloc()
 {
-  m_data = new uint8_t[m_size];
-  return true;
+  m_data = CVideoBufferAllocator::GetInstance().Allocate(m_size);
+  return m_data != nullptr;
 }
 
 
@@ -300,7 +302,12 @@ CVideoBuffer* CVideoBufferPoolSysMem::Get()
   {
     int id = m_all.size();
     buf = new CVideoBufferSysMem(*this, id, m_pixFormat, m_size);
-    buf->Alloc();
+    if (!buf->Alloc())
+    {
+      CLog::Log(LOGERROR, "CVideoBufferPoolSysMem::Get - failed to allocate %d bytes", m_size);
+      delete buf;
+      return nullptr;
+    }
     m_all.push_back(buf);
     m_used.push_back(id);
   }
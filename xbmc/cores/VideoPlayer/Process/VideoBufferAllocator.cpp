@@ -0,0 +1,215 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "VideoBufferAllocator.h"
+#include "threads/SingleLock.h"
+
+#ifdef TARGET_POSIX
+#include "platform/linux/XMemUtils.h"
+#endif
+
+#include <algorithm>
+
+namespace
+{
+// Frames smaller than this share the smallest size class
+constexpr size_t MIN_CLASS_SIZE = 64 * 1024;
+
+// Larger frames aren't pooled, 8K YUV 4:2:0 is about 50 MB
+constexpr size_t MAX_CLASS_SIZE = 64 * 1024 * 1024;
+
+// Default limit of the free lists, about 20 1080p frames
+constexpr size_t DEFAULT_CACHE_LIMIT = 64 * 1024 * 1024;
+
+// Enough for the widest vector loads of the converters and renderers
+constexpr size_t FRAME_ALIGNMENT = 64;
+}
+
+CVideoBufferAllocator::CVideoBufferAllocator() :
+  m_freeBlocks(MIN_CLASS_SIZE, MAX_CLASS_SIZE),
+  m_cacheLimit(DEFAULT_CACHE_LIMIT)
+{
+}
+
+CVideoBufferAllocator::~CVideoBufferAllocator()
+{
+  Clear();
+}
+
+CVideoBufferAllocator& CVideoBufferAllocator::GetInstance()
+{
+  static CVideoBufferAllocator allocator;
+  return allocator;
+}
+
+uint8_t* CVideoBufferAllocator::Allocate(size_t size)
+{
+  const int sizeClass = m_freeBlocks.GetSizeClass(size);
+  if (sizeClass >= 0)
+    size = m_freeBlocks.GetClassSize(sizeClass);
+
+  {
+    CSingleLock lock(m_critSection);
+
+    m_stats.allocations++;
+    m_stats.usedBytes += size;
+
+    uint8_t* data = sizeClass >= 0 ? m_freeBlocks.Pop(sizeClass) : nullptr;
+    if (data)
+    {
+      m_stats.cachedBytes -= size;
+      m_stats.reused++;
+      return data;
+    }
+  }
+
+  uint8_t* data = static_cast<uint8_t*>(_aligned_malloc(size, FRAME_ALIGNMENT));
+  if (!data)
+  {
+    CSingleLock lock(m_critSection);
+    m_stats.usedBytes -= size;
+  }
+
+  return data;
+}
+
+void CVideoBufferAllocator::Free(uint8_t* data, size_t size)
+{
+  if (!data)
+    return;
+
+  const int sizeClass = m_freeBlocks.GetSizeClass(size);
+  if (sizeClass >= 0)
+    size = m_freeBlocks.GetClassSize(sizeClass);
+
+  std::vector<uint8_t*> evicted;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    m_stats.usedBytes -= size;
+
+    if (sizeClass >= 0)
+    {
+      Evict(sizeClass, size, evicted);
+
+      if (m_stats.cachedBytes + size <= m_cacheLimit)
+      {
+        m_freeBlocks.Push(sizeClass, data);
+        m_stats.cachedBytes += size;
+        data = nullptr;
+      }
+    }
+  }
+
+  for (uint8_t* block : evicted)
+    _aligned_free(block);
+
+  if (data)
+    _aligned_free(data);
+}
+
+unsigned int CVideoBufferAllocator::Prewarm(size_t size, unsigned int count)
+{
+  const int sizeClass = m_freeBlocks.GetSizeClass(size);
+  if (sizeClass < 0)
+    return 0;
+
+  size = m_freeBlocks.GetClassSize(sizeClass);
+
+  std::vector<uint8_t*> evicted;
+  unsigned int missing = 0;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    const size_t cached = m_freeBlocks.GetCount(sizeClass);
+    if (cached < count)
+    {
+      Evict(sizeClass, (count - cached) * size, evicted);
+
+      // reserve the room, so frames freed meanwhile don't take it
+      const size_t room = m_cacheLimit > m_stats.cachedBytes ? m_cacheLimit - m_stats.cachedBytes : 0;
+      missing = static_cast<unsigned int>(std::min(count - cached, room / size));
+      m_stats.cachedBytes += missing * size;
+    }
+  }
+
+  for (uint8_t* block : evicted)
+    _aligned_free(block);
+
+  std::vector<uint8_t*> blocks;
+  for (unsigned int i = 0; i < missing; i++)
+  {
+    uint8_t* data = static_cast<uint8_t*>(_aligned_malloc(size, FRAME_ALIGNMENT));
+    if (!data)
+      break;
+    blocks.push_back(data);
+  }
+
+  CSingleLock lock(m_critSection);
+
+  m_stats.cachedBytes -= (missing - blocks.size()) * size;
+  for (uint8_t* data : blocks)
+    m_freeBlocks.Push(sizeClass, data);
+
+  return static_cast<unsigned int>(m_freeBlocks.GetCount(sizeClass));
+}
+
+void CVideoBufferAllocator::SetCacheLimit(size_t bytes)
+{
+  std::vector<uint8_t*> evicted;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    m_cacheLimit = bytes;
+    Evict(-1, 0, evicted);
+  }
+
+  for (uint8_t* block : evicted)
+    _aligned_free(block);
+}
+
+void CVideoBufferAllocator::Clear()
+{
+  std::vector<uint8_t*> freeBlocks;
+
+  {
+    CSingleLock lock(m_critSection);
+
+    freeBlocks = m_freeBlocks.PopAll();
+    m_stats.cachedBytes = 0;
+  }
+
+  for (uint8_t* data : freeBlocks)
+    _aligned_free(data);
+}
+
+CVideoBufferAllocator::Stats CVideoBufferAllocator::GetStats()
+{
+  CSingleLock lock(m_critSection);
+
+  return m_stats;
+}
+
+void CVideoBufferAllocator::Evict(int keepClass, size_t size, std::vector<uint8_t*>& evicted)
+{
+  // release the frames of the size class holding the most memory, until
+  // size more bytes fit
+  while (m_stats.cachedBytes + size > m_cacheLimit)
+  {
+    int victim;
+    uint8_t* data = m_freeBlocks.PopLargest(keepClass, victim);
+    if (!data)
+      break;
+
+    evicted.push_back(data);
+    m_stats.cachedBytes -= m_freeBlocks.GetClassSize(victim);
+  }
+}
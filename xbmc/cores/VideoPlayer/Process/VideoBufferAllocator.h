@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+#include "utils/SizeClassFreeList.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*!
+ * \brief Recycles the memory of system memory video buffers across pools
+ *
+ * CVideoBufferManager discards its pools on every stream change, e.g. a
+ * channel switch, and the new pool allocated all frame memory again. Freed
+ * frames are kept on free lists instead, in size classes of a quarter power
+ * of two, so the next pool reuses them if the frame size is similar.
+ *
+ * The memory kept on the free lists is capped. When a frame is freed over
+ * the cap, frames of other sizes are released first, as the size freed
+ * last is the one most likely to be needed again.
+ */
+class CVideoBufferAllocator
+{
+public:
+  struct Stats
+  {
+    uint64_t allocations = 0; // Frames handed out
+    uint64_t reused = 0; // Frames taken from a free list
+    size_t usedBytes = 0; // Bytes of frames not freed yet
+    size_t cachedBytes = 0; // Bytes held by the free lists
+  };
+
+  CVideoBufferAllocator();
+  ~CVideoBufferAllocator();
+
+  static CVideoBufferAllocator& GetInstance();
+
+  /*!
+   * \brief Get a 64 byte aligned block of at least size bytes
+   *
+   * \return The block, or nullptr if out of memory
+   */
+  uint8_t* Allocate(size_t size);
+
+  /*!
+   * \brief Return a block from Allocate(), with the size it was requested with
+   */
+  void Free(uint8_t* data, size_t size);
+
+  /*!
+   * \brief Allocate frames ahead of time
+   *
+   * Fills the free list of the size class up to count frames, within the
+   * cap, so the next allocations of that size don't hit the heap.
+   *
+   * \return The number of frames of that size on the free list
+   */
+  unsigned int Prewarm(size_t size, unsigned int count);
+
+  /*!
+   * \brief Set the max number of bytes kept on the free lists
+   */
+  void SetCacheLimit(size_t bytes);
+
+  /*!
+   * \brief Release all memory held by the free lists
+   */
+  void Clear();
+
+  Stats GetStats();
+
+private:
+  // No copying
+  CVideoBufferAllocator(const CVideoBufferAllocator&) = delete;
+  CVideoBufferAllocator& operator=(const CVideoBufferAllocator&) = delete;
+
+  void Evict(int keepClass, size_t size, std::vector<uint8_t*>& evicted);
+
+  // Free lists
+  CSizeClassFreeList m_freeBlocks;
+
+  size_t m_cacheLimit;
+  Stats m_stats;
+  CCriticalSection m_critSection;
+};
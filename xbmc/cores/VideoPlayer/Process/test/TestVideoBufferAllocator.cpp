@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/Process/VideoBufferAllocator.h"
+
+#include "gtest/gtest.h"
+
+#include <stdint.h>
+
+namespace
+{
+// 1080p YUV 4:2:0 and a slightly larger stride
+constexpr size_t FRAME_SIZE = 1920 * 1080 * 3 / 2;
+constexpr size_t PADDED_FRAME_SIZE = 1920 * 1088 * 3 / 2;
+}
+
+TEST(TestVideoBufferAllocator, Reuse)
+{
+  CVideoBufferAllocator allocator;
+
+  uint8_t* frame = allocator.Allocate(FRAME_SIZE);
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(frame) % 64, 0u);
+  EXPECT_GE(allocator.GetStats().usedBytes, FRAME_SIZE);
+
+  allocator.Free(frame, FRAME_SIZE);
+  EXPECT_EQ(allocator.GetStats().usedBytes, 0u);
+  EXPECT_GE(allocator.GetStats().cachedBytes, FRAME_SIZE);
+
+  // A frame of a similar size reuses the memory
+  EXPECT_EQ(allocator.Allocate(PADDED_FRAME_SIZE), frame);
+  EXPECT_EQ(allocator.GetStats().reused, 1u);
+  EXPECT_EQ(allocator.GetStats().cachedBytes, 0u);
+
+  allocator.Free(frame, PADDED_FRAME_SIZE);
+}
+
+TEST(TestVideoBufferAllocator, CacheLimit)
+{
+  CVideoBufferAllocator allocator;
+  allocator.SetCacheLimit(4 * FRAME_SIZE);
+
+  uint8_t* frames[8];
+  for (auto& frame : frames)
+    frame = allocator.Allocate(FRAME_SIZE);
+  for (auto& frame : frames)
+    allocator.Free(frame, FRAME_SIZE);
+
+  CVideoBufferAllocator::Stats stats = allocator.GetStats();
+  EXPECT_LE(stats.cachedBytes, 4 * FRAME_SIZE);
+  EXPECT_GT(stats.cachedBytes, 0u);
+
+  // Frames of a new size push out the cached ones
+  uint8_t* small = allocator.Allocate(FRAME_SIZE / 4);
+  uint8_t* smallFrames[8];
+  for (auto& frame : smallFrames)
+    frame = allocator.Allocate(FRAME_SIZE / 4);
+  allocator.Free(small, FRAME_SIZE / 4);
+  for (auto& frame : smallFrames)
+    allocator.Free(frame, FRAME_SIZE / 4);
+
+  stats = allocator.GetStats();
+  EXPECT_LE(stats.cachedBytes, 4 * FRAME_SIZE);
+  EXPECT_GE(stats.cachedBytes, 9 * FRAME_SIZE / 4);
+
+  allocator.SetCacheLimit(0);
+  EXPECT_EQ(allocator.GetStats().cachedBytes, 0u);
+}
+
+TEST(TestVideoBufferAllocator, Prewarm)
+{
+  CVideoBufferAllocator allocator;
+  allocator.SetCacheLimit(5 * FRAME_SIZE);
+
+  EXPECT_EQ(allocator.Prewarm(FRAME_SIZE, 2), 2u);
+  EXPECT_EQ(allocator.Prewarm(FRAME_SIZE, 100), 4u);
+
+  uint8_t* frame = allocator.Allocate(FRAME_SIZE);
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(allocator.GetStats().reused, 1u);
+  allocator.Free(frame, FRAME_SIZE);
+
+  // Sizes that aren't pooled
+  EXPECT_EQ(allocator.Prewarm(128 * 1024 * 1024, 1), 0u);
+
+  allocator.Clear();
+  EXPECT_EQ(allocator.GetStats().cachedBytes, 0u);
+}
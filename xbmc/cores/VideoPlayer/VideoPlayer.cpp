@@ -23,6 +23,7 @@
 #include "DVDDemuxers/DVDDemuxVobsub.h"
 #include "DVDDemuxers/DVDFactoryDemuxer.h"
 #include "DVDDemuxers/DVDDemuxFFmpeg.h"
+#include "DVDDemuxers/DemuxPacketPool.h"
 
 #include "DVDFileInfo.h"
 
@@ -44,6 +45,7 @@
 #include "cores/FFmpeg.h"
 #include "cores/VideoPlayer/VideoRenderers/RenderManager.h"
 #include "cores/VideoPlayer/Process/ProcessInfo.h"
+#include "cores/VideoPlayer/Process/VideoBufferAllocator.h"
 #include "FileItem.h"
 #include "GUIUserMessages.h"
 #include "settings/AdvancedSettings.h"
@@ -74,6 +76,7 @@
 #include "windowing/WinSystem.h"
 #include "DVDCodecs/DVDCodecUtils.h"
 
+#include <inttypes.h>
 #include <iterator>
 
 using namespace KODI::MESSAGING;
@@ -759,6 +762,10 @@ bool CVideoPlayer::CloseFile(bool reopen)
 
   CLog::Log(LOGNOTICE, "VideoPlayer: finished waiting");
   m_renderManager.UnInit();
+
+  // the frames the renderer held go back to the allocator with their pools
+  m_processInfo->GetVideoBufferManager().ReleasePools();
+  CVideoBufferAllocator::GetInstance().Clear();
   return true;
 }
 
@@ -1229,6 +1236,8 @@ void CVideoPlayer::Prepare()
   m_processInfo->SetSpeed(1.0);
   m_processInfo->SetTempo(1.0);
   m_processInfo->SetFrameAdvance(false);
+  m_processInfo->SetTimeToFirstFrame(0);
+  m_prepareTime = XbmcThreads::SystemClockMillis();
   m_State.Clear();
   m_CurrentVideo.hint.Clear();
   m_CurrentAudio.hint.Clear();
@@ -2082,6 +2091,13 @@ void CVideoPlayer::HandlePlaySpeed()
           CApplicationMessenger::GetInstance().PostMsg(TMSG_SWITCHTOFULLSCREEN);
         }
 
+        if (m_CurrentVideo.id >= 0)
+        {
+          const unsigned int timeToFirstFrame = XbmcThreads::SystemClockMillis() - m_prepareTime;
+          CLog::Log(LOGDEBUG, "CVideoPlayer::%s - first video frame after %u ms", __FUNCTION__, timeToFirstFrame);
+          m_processInfo->SetTimeToFirstFrame(timeToFirstFrame);
+        }
+
         IPlayerCallback *cb = &m_callback;
         CFileItem fileItem = m_item;
         m_outboundEvents->Submit([=]() {
@@ -2534,6 +2550,18 @@ void CVideoPlayer::OnExit()
 
   m_messenger.End();
 
+  CDemuxPacketPool::Stats packetStats = CDemuxPacketPool::GetInstance().GetStats();
+  CLog::Log(LOGDEBUG, "CVideoPlayer::OnExit - demux packets: %" PRIu64 " allocated, %" PRIu64 " reused, %u outstanding, %zu bytes cached",
+            packetStats.allocations, packetStats.reused, packetStats.outstanding, packetStats.cachedBytes);
+
+  CVideoBufferAllocator::Stats frameStats = CVideoBufferAllocator::GetInstance().GetStats();
+  CLog::Log(LOGDEBUG, "CVideoPlayer::OnExit - video frames: %" PRIu64 " allocated, %" PRIu64 " reused, %zu bytes used, %zu bytes cached",
+            frameStats.allocations, frameStats.reused, frameStats.usedBytes, frameStats.cachedBytes);
+
+  // don't hold on to the recycled memory between files
+  CDemuxPacketPool::GetInstance().Clear();
+  CVideoBufferAllocator::GetInstance().Clear();
+
   if (m_omxplayer_mode)
   {
     m_OmxPlayerState.av_clock.OMXStop();
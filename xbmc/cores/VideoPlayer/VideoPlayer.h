@@ -573,6 +573,7 @@ protected:
   SPlayerState m_State;
   mutable CCriticalSection m_StateSection;
   XbmcThreads::EndTime m_syncTimer;
+  unsigned int m_prepareTime = 0; // when opening the current file started
 
   CEdl m_Edl;
   bool m_SkipCommercials;
@@ -195,6 +195,18 @@ int64_t CVideoReferenceClock::GetTime(bool interpolated /* = true*/)
   }
 }
 
+//get the host counter of the last vblank, to phase align to the display
+//returns -1 when vblank isn't used as clock source
+int64_t CVideoReferenceClock::GetVblankTime() const
+{
+  CSingleLock SingleLock(m_CritSection);
+
+  if (m_UseVblank)
+    return m_VblankTime;
+  else
+    return -1;
+}
+
 void CVideoReferenceClock::SetSpeed(double Speed)
 {
   CSingleLock SingleLock(m_CritSection);
@@ -22,6 +22,7 @@ class CVideoReferenceClock : CThread
     ~CVideoReferenceClock() override;
 
     int64_t GetTime(bool interpolated = true);
+    int64_t GetVblankTime() const;
     void    SetSpeed(double Speed);
     double  GetSpeed();
     double  GetRefreshRate(double* interval = nullptr);
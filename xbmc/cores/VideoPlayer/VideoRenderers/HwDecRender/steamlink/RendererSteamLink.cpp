@@ -127,7 +127,7 @@ void CRendererSteamLink::RenderUpdate(int index, int index2, bool clear, unsigne
   {
     CSteamLinkVideoBuffer* buffer = dynamic_cast<CSteamLinkVideoBuffer*>(buf.videoBuffer);
     if (buffer != nullptr && buffer->buffer)
-      buffer->stream->WriteData(buffer->buffer.get(), buffer->size);
+      buffer->stream->WriteData(buffer->buffer.get(), buffer->size, buffer->latencyRecord);
 
     ReleaseBuffer(index);
   }
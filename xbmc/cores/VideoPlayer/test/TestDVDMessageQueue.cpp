@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "cores/VideoPlayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "cores/VideoPlayer/DVDMessageQueue.h"
+#include "cores/VideoPlayer/Interface/Addon/TimingConstants.h"
+#include "test/BenchmarkUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+  constexpr int PACKET_COUNT = 100; // More than the initial ring size
+  constexpr int PACKET_SIZE = 10;
+
+  void PutPackets(CDVDMessageQueue &queue, int count)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(PACKET_SIZE);
+      packet->iSize = PACKET_SIZE;
+      packet->dts = i * DVD_TIME_BASE / 10;
+      queue.Put(new CDVDMsgDemuxerPacket(packet));
+    }
+  }
+}
+
+TEST(TestDVDMessageQueue, Order)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  PutPackets(queue, PACKET_COUNT);
+  EXPECT_EQ(queue.GetDataSize(), PACKET_COUNT * PACKET_SIZE);
+  EXPECT_EQ(queue.GetTimeSize(), (PACKET_COUNT - 1) / 10);
+
+  CDVDMsg* msg;
+  int priority = 0;
+
+  // Priority messages come first
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC), 1);
+  ASSERT_EQ(queue.Get(&msg, 0, priority), MSGQ_OK);
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  EXPECT_EQ(priority, 1);
+  msg->Release();
+
+  // Then a message that was put back
+  queue.PutBack(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+  ASSERT_EQ(queue.Get(&msg, 0), MSGQ_OK);
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_EOF));
+  msg->Release();
+
+  // Then the packets, oldest first
+  for (int i = 0; i < PACKET_COUNT; i++)
+  {
+    ASSERT_EQ(queue.Get(&msg, 0), MSGQ_OK);
+    ASSERT_TRUE(msg->IsType(CDVDMsg::DEMUXER_PACKET));
+    EXPECT_EQ(static_cast<CDVDMsgDemuxerPacket*>(msg)->GetPacket()->dts, i * DVD_TIME_BASE / 10);
+    msg->Release();
+  }
+
+  EXPECT_EQ(queue.GetDataSize(), 0);
+  EXPECT_EQ(queue.Get(&msg, 0), MSGQ_TIMEOUT);
+
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, Flush)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  PutPackets(queue, PACKET_COUNT);
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+  PutPackets(queue, PACKET_COUNT);
+
+  queue.Flush();
+  EXPECT_EQ(queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET), 0u);
+  EXPECT_EQ(queue.GetPacketCount(CDVDMsg::GENERAL_EOF), 1u);
+  EXPECT_EQ(queue.GetDataSize(), 0);
+  EXPECT_EQ(queue.GetLevel(), 0);
+
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, WakeWaiter)
+{
+  CDVDMessageQueue queue("test");
+  queue.Init();
+
+  CDVDMsg* msg = nullptr;
+  MsgQueueReturnCode ret = MSGQ_TIMEOUT;
+  std::thread consumer([&queue, &msg, &ret]() {
+    ret = queue.Get(&msg, 10000);
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  queue.Put(new CDVDMsg(CDVDMsg::GENERAL_EOF));
+  consumer.join();
+
+  ASSERT_EQ(ret, MSGQ_OK);
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_EOF));
+  msg->Release();
+
+  queue.End();
+}
+
+TEST(TestDVDMessageQueue, DISABLED_ThroughputCost)
+{
+  constexpr int MESSAGE_COUNT = 100000;
+
+  CDVDMessageQueue queue("test");
+  queue.Init();
+  queue.SetMaxDataSize(64 * PACKET_SIZE);
+
+  // A demuxer thread that waits while the queue is full, and a player thread
+  const double messageUs = CBenchmarkUtils::MeanUs(1, [&queue]()
+  {
+    std::thread player([&queue]()
+    {
+      for (int i = 0; i < MESSAGE_COUNT; i++)
+      {
+        CDVDMsg* msg;
+        if (queue.Get(&msg, 1000) != MSGQ_OK)
+          break;
+        msg->Release();
+      }
+    });
+
+    for (int i = 0; i < MESSAGE_COUNT; i++)
+    {
+      while (queue.IsFull())
+        std::this_thread::yield();
+      PutPackets(queue, 1);
+    }
+
+    player.join();
+  }) / MESSAGE_COUNT;
+
+  EXPECT_EQ(queue.GetDataSize(), 0);
+  CBenchmarkUtils::Report("put and get", messageUs, "us/message");
+
+  queue.End();
+}
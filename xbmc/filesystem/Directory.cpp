@@ -166,6 +166,13 @@ bool CDirectory::GetDirectory(const CURL& url, std::shared_ptr<IDirectory> pDire
     // check our cache for this path
     if (g_directoryCache.GetDirectory(realURL.Get(), items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE))
       items.SetURL(url);
+    else if (!(hints.flags & DIR_FLAG_BYPASS_CACHE) && pDirectory->GetCacheType(url) != DIR_CACHE_NEVER &&
+             g_directoryCache.GetPersistedDirectory(realURL.Get(), items, hints.flags))
+    {
+      // listing of an earlier fetch, and the directory is unchanged since
+      items.SetURL(url);
+      g_directoryCache.SetDirectory(realURL.Get(), items, pDirectory->GetCacheType(url));
+    }
     else
     {
       // need to clear the cache (in case the directory fetch fails)
@@ -247,7 +254,12 @@ bool CDirectory::GetDirectory(const CURL& url, std::shared_ptr<IDirectory> pDire
 
       // cache the directory, if necessary
       if (!(hints.flags & DIR_FLAG_BYPASS_CACHE))
-        g_directoryCache.SetDirectory(realURL.Get(), items, pDirectory->GetCacheType(url));
+      {
+        const DIR_CACHE_TYPE cacheType = pDirectory->GetCacheType(url);
+        g_directoryCache.SetDirectory(realURL.Get(), items, cacheType);
+        if (cacheType != DIR_CACHE_NEVER)
+          g_directoryCache.PersistDirectory(realURL.Get(), items, hints.flags);
+      }
     }
 
     // now filter for allowed files
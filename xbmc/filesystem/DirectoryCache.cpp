@@ -8,8 +8,13 @@
 
 #include "Directory.h"
 #include "DirectoryCache.h"
+#include "File.h"
 #include "FileItem.h"
 #include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/Job.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
@@ -17,12 +22,83 @@
 #include "climits"
 
 #include <algorithm>
+#include <stdexcept>
 
 // Maximum number of directories to keep in our cache
 #define MAX_CACHED_DIRS 50
 
+// Listings stored on disk, kept across sessions
+#define PERSISTED_DIRS_PATH "special://temp/directory_cache/"
+#define PERSISTED_DIRS_VERSION 2
+// Last value of a listing, CArchive reads zeros past the end of a short file
+#define PERSISTED_DIRS_END 0x5453494c
+
 using namespace XFILE;
 
+namespace
+{
+bool IsSameListing(const CFileItemList &left, const CFileItemList &right)
+{
+  if (left.Size() != right.Size())
+    return false;
+
+  for (int i = 0; i < left.Size(); i++)
+  {
+    const CFileItemPtr &leftItem = left[i];
+    const CFileItemPtr &rightItem = right[i];
+    if (leftItem->GetPath() != rightItem->GetPath() ||
+        leftItem->m_bIsFolder != rightItem->m_bIsFolder ||
+        leftItem->m_dwSize != rightItem->m_dwSize ||
+        leftItem->m_dateTime != rightItem->m_dateTime)
+      return false;
+  }
+  return true;
+}
+
+// Fetches a directory served from disk, and updates the stored listing
+// if anything changed
+class CRevalidateDirectoryJob : public CJob
+{
+public:
+  CRevalidateDirectoryJob(const std::string &path, const CFileItemList &items, int flags) :
+    m_path(path),
+    m_flags(flags)
+  {
+    m_items.Copy(items);
+  }
+
+  const char *GetType() const override { return "revalidatedirectory"; }
+
+  bool DoWork() override
+  {
+    // the listing as the directory implementation returns it
+    CFileItemList items;
+    const int flags = DIR_FLAG_BYPASS_CACHE | DIR_FLAG_GET_HIDDEN | DIR_FLAG_NO_FILE_DIRS | (m_flags & DIR_FLAG_NO_FILE_INFO);
+    if (!CDirectory::GetDirectory(m_path, items, "", flags))
+    {
+      g_directoryCache.ClearDirectory(m_path);
+      return false;
+    }
+
+    if (!IsSameListing(items, m_items))
+    {
+      CLog::Log(LOGDEBUG, "CDirectoryCache - stored listing of %s changed", CURL::GetRedacted(m_path).c_str());
+      g_directoryCache.ClearDirectory(m_path);
+    }
+
+    // unchanged listings are written again too, stored listings are pruned
+    // by their write time
+    g_directoryCache.PersistDirectory(m_path, items, m_flags);
+    return true;
+  }
+
+private:
+  std::string m_path;
+  CFileItemList m_items;
+  int m_flags;
+};
+}
+
 CDirectoryCache::CDir::CDir(DIR_CACHE_TYPE cacheType)
 {
   m_cacheType = cacheType;
@@ -101,7 +177,9 @@ void CDirectoryCache::SetDirectory(const std::string& strPath, const CFileItemLi
   std::string storedPath = CURL(strPath).GetWithoutOptions();
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  ClearDirectory(storedPath);
+  iCache i = m_cache.find(storedPath);
+  if (i != m_cache.end())
+    Delete(i);
 
   CheckIfFull();
 
@@ -121,15 +199,18 @@ void CDirectoryCache::ClearFile(const std::string& strFile)
 
 void CDirectoryCache::ClearDirectory(const std::string& strPath)
 {
-  CSingleLock lock (m_cs);
-
   // Get rid of any URL options, else the compare may be wrong
   std::string storedPath = CURL(strPath).GetWithoutOptions();
   URIUtils::RemoveSlashAtEnd(storedPath);
 
-  iCache i = m_cache.find(storedPath);
-  if (i != m_cache.end())
-    Delete(i);
+  {
+    CSingleLock lock (m_cs);
+    iCache i = m_cache.find(storedPath);
+    if (i != m_cache.end())
+      Delete(i);
+  }
+
+  ClearPersistedDirectory(storedPath);
 }
 
 void CDirectoryCache::ClearSubPaths(const std::string& strPath)
@@ -195,6 +276,192 @@ bool CDirectoryCache::FileExists(const std::string& strFile, bool& bInCache)
   return false;
 }
 
+bool CDirectoryCache::GetPersistedDirectory(const std::string& strPath, CFileItemList &items, int flags)
+{
+  // Get rid of any URL options, else the compare may be wrong
+  std::string storedPath = CURL(strPath).GetWithoutOptions();
+  URIUtils::RemoveSlashAtEnd(storedPath);
+
+  if (!CanPersist(storedPath))
+    return false;
+
+  long long mtime, inode;
+  if (!GetChangeToken(storedPath, mtime, inode))
+    return false;
+
+  CFileItemList persisted;
+  {
+    CSingleLock lock(m_persistSection);
+
+    if (!LoadListing(GetPersistedFile(storedPath), CURL(storedPath).GetWithoutUserDetails(),
+                     mtime, inode, !(flags & DIR_FLAG_NO_FILE_INFO), persisted))
+      return false;
+  }
+
+  items.Copy(persisted);
+
+  {
+    CSingleLock lock(m_cs);
+    if (!m_revalidated.insert(storedPath).second)
+      return true;
+  }
+  CJobManager::GetInstance().AddJob(new CRevalidateDirectoryJob(storedPath, persisted, flags), nullptr, CJob::PRIORITY_LOW_PAUSABLE);
+
+  return true;
+}
+
+void CDirectoryCache::PersistDirectory(const std::string& strPath, CFileItemList &items, int flags)
+{
+  // Get rid of any URL options, else the compare may be wrong
+  std::string storedPath = CURL(strPath).GetWithoutOptions();
+  URIUtils::RemoveSlashAtEnd(storedPath);
+
+  if (!CanPersist(storedPath))
+    return;
+
+  long long mtime, inode;
+  if (!GetChangeToken(storedPath, mtime, inode))
+    return;
+
+  CSingleLock lock(m_persistSection);
+
+  if (!SaveListing(GetPersistedFile(storedPath), CURL(storedPath).GetWithoutUserDetails(),
+                   mtime, inode, !(flags & DIR_FLAG_NO_FILE_INFO), items))
+    CLog::Log(LOGERROR, "%s - failed to store listing of %s", __FUNCTION__, CURL::GetRedacted(storedPath).c_str());
+}
+
+bool CDirectoryCache::LoadListing(const std::string& file, const std::string& path, long long mtime, long long inode, bool needFileInfo, CFileItemList &items)
+{
+  CFile stored;
+  if (!stored.Open(file))
+    return false;
+
+  CFileItemList listing;
+
+  try
+  {
+    CArchive ar(&stored, CArchive::load);
+
+    int version;
+    ar >> version;
+    if (version != PERSISTED_DIRS_VERSION)
+      return false;
+
+    std::string storedPath;
+    long long storedMtime, storedInode;
+    bool hasFileInfo;
+    ar >> storedPath >> storedMtime >> storedInode >> hasFileInfo;
+    if (storedPath != path || storedMtime != mtime || storedInode != inode ||
+        (!hasFileInfo && needFileInfo))
+      return false;
+
+    int count;
+    ar >> count;
+    ar >> listing;
+    if (listing.Size() != count)
+      throw std::out_of_range("listing size");
+
+    int end;
+    ar >> end;
+    if (end != PERSISTED_DIRS_END)
+      throw std::out_of_range("listing end");
+  }
+  catch (const std::out_of_range&)
+  {
+    CLog::Log(LOGERROR, "%s - corrupt listing %s", __FUNCTION__, file.c_str());
+    return false;
+  }
+
+  items.Copy(listing);
+  return true;
+}
+
+bool CDirectoryCache::SaveListing(const std::string& file, const std::string& path, long long mtime, long long inode, bool hasFileInfo, CFileItemList &items)
+{
+  // write a new file and swap it in, a crash or a full disk leaves the
+  // previous listing (or none) instead of a partial one
+  const std::string tempFile = file + ".tmp";
+
+  {
+    CFile stored;
+    if (!stored.OpenForWrite(tempFile, true))
+      return false;
+
+    CArchive ar(&stored, CArchive::store);
+    ar << PERSISTED_DIRS_VERSION;
+    ar << path;
+    ar << mtime;
+    ar << inode;
+    ar << hasFileInfo;
+    ar << items.Size();
+    ar << items;
+    ar << PERSISTED_DIRS_END;
+    ar.Close();
+    stored.Close();
+  }
+
+  // CArchive only logs failed writes, the end marker is in the last one
+  bool bComplete = false;
+  {
+    CFile stored;
+    int end = 0;
+    if (stored.Open(tempFile) &&
+        stored.Seek(-static_cast<int64_t>(sizeof(end)), SEEK_END) >= 0 &&
+        stored.Read(&end, sizeof(end)) == static_cast<ssize_t>(sizeof(end)))
+      bComplete = (end == PERSISTED_DIRS_END);
+  }
+
+  if (bComplete && !CFile::Rename(tempFile, file))
+  {
+    // renaming doesn't replace an existing file on all platforms
+    CFile::Delete(file);
+    bComplete = CFile::Rename(tempFile, file);
+  }
+
+  if (!bComplete)
+  {
+    CFile::Delete(tempFile);
+    return false;
+  }
+
+  return true;
+}
+
+bool CDirectoryCache::CanPersist(const std::string& storedPath)
+{
+  // listings that are slow to fetch, of directories with a reliable modification time
+  const CURL url(storedPath);
+  return url.IsProtocol("smb") || url.IsProtocol("nfs");
+}
+
+std::string CDirectoryCache::GetPersistedFile(const std::string& storedPath)
+{
+  return StringUtils::Format(PERSISTED_DIRS_PATH "%08x.fi", Crc32::Compute(storedPath));
+}
+
+bool CDirectoryCache::GetChangeToken(const std::string& storedPath, long long &mtime, long long &inode)
+{
+  struct __stat64 buffer = {};
+  if (CFile::Stat(storedPath, &buffer) != 0 || buffer.st_mtime == 0)
+    return false;
+
+  mtime = static_cast<long long>(buffer.st_mtime);
+  inode = static_cast<long long>(buffer.st_ino);
+  return true;
+}
+
+void CDirectoryCache::ClearPersistedDirectory(const std::string& storedPath)
+{
+  if (!CanPersist(storedPath))
+    return;
+
+  CSingleLock lock(m_persistSection);
+
+  const std::string persistedFile = GetPersistedFile(storedPath);
+  if (CFile::Exists(persistedFile))
+    CFile::Delete(persistedFile);
+}
+
 void CDirectoryCache::Clear()
 {
   // this routine clears everything
@@ -13,6 +13,7 @@
 
 #include <map>
 #include <set>
+#include <string>
 
 class CFileItem;
 
@@ -47,6 +48,49 @@ namespace XFILE
     void Clear();
     void AddFile(const std::string& strFile);
     bool FileExists(const std::string& strPath, bool& bInCache);
+
+    /*! \brief Get a listing stored on disk by an earlier fetch
+     Listings of network shares are kept across sessions, and are used as long as
+     the modification time and inode of the directory are unchanged. A listing
+     served from disk is fetched again in the background, once per session, to
+     pick up changes that don't touch the directory itself.
+     \param strPath the directory
+     \param items [out] the stored listing
+     \param flags the DIR_FLAG flags of the request
+     \return true if an unchanged listing was found, false otherwise
+     \sa PersistDirectory
+     */
+    bool GetPersistedDirectory(const std::string& strPath, CFileItemList &items, int flags);
+
+    /*! \brief Store a listing on disk, for GetPersistedDirectory
+     \param strPath the directory
+     \param items the listing, as returned by the directory implementation
+     \param flags the DIR_FLAG flags the listing was fetched with
+     \sa GetPersistedDirectory
+     */
+    void PersistDirectory(const std::string& strPath, CFileItemList &items, int flags);
+
+    /*! \brief Read a listing from a file written by SaveListing
+     \param file the file
+     \param path the directory, without user details
+     \param mtime the modification time of the directory
+     \param inode the inode of the directory
+     \param needFileInfo true if the listing must have been fetched with file info
+     \param items [out] the listing
+     \return true if the file holds a complete listing of the unchanged directory, false otherwise
+     */
+    static bool LoadListing(const std::string& file, const std::string& path, long long mtime, long long inode, bool needFileInfo, CFileItemList &items);
+
+    /*! \brief Write a listing to a file, replacing the file once it is complete
+     \param file the file
+     \param path the directory, without user details
+     \param mtime the modification time of the directory
+     \param inode the inode of the directory
+     \param hasFileInfo true if the listing was fetched with file info
+     \param items the listing
+     \return true if the listing was written, false otherwise
+     */
+    static bool SaveListing(const std::string& file, const std::string& path, long long mtime, long long inode, bool hasFileInfo, CFileItemList &items);
 #ifdef _DEBUG
     void PrintStats() const;
 #endif
@@ -55,6 +99,11 @@ namespace XFILE
     void ClearCache(std::set<std::string>& dirs);
     void CheckIfFull();
 
+    static bool CanPersist(const std::string& storedPath);
+    static std::string GetPersistedFile(const std::string& storedPath);
+    static bool GetChangeToken(const std::string& storedPath, long long &mtime, long long &inode);
+    void ClearPersistedDirectory(const std::string& storedPath);
+
     std::map<std::string, CDir*> m_cache;
     typedef std::map<std::string, CDir*>::iterator iCache;
     typedef std::map<std::string, CDir*>::const_iterator ciCache;
@@ -64,6 +113,9 @@ namespace XFILE
 
     unsigned int m_accessCounter;
 
+    std::set<std::string> m_revalidated; ///< stored listings already fetched again this session
+    CCriticalSection m_persistSection; ///< serializes access to the stored listings
+
 #ifdef _DEBUG
     unsigned int m_cacheHits;
     unsigned int m_cacheMisses;
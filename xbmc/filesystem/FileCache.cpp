@@ -14,6 +14,8 @@
 #include "ServiceBroker.h"
 
 #include "CircularCache.h"
+#include "RangePrefetcher.h"
+#include "SparseCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "settings/AdvancedSettings.h"
@@ -23,6 +25,10 @@
 #include "platform/linux/ConvUtils.h"
 #endif
 
+#if defined(TARGET_POSIX)
+#include "platform/posix/filesystem/PosixMappedFileCache.h"
+#endif
+
 #include <cassert>
 #include <algorithm>
 #include <memory>
@@ -34,6 +40,7 @@
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (128*1024)
+#define PREFETCH_SEGMENT_SIZE (1024*1024)
 
 class CWriteRate
 {
@@ -173,13 +180,42 @@ bool CFileCache::Open(const CURL& url)
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
   m_fileSize = m_source.GetLength();
 
+  // read high-latency sources with concurrent range requests
+  unsigned int parallelReads = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheParallelReads;
+  if (!(m_seekPossible > 0 && m_fileSize > 0 && CRangePrefetcher::IsSupported(url)))
+    parallelReads = 0;
+  const size_t segmentSize = std::max(static_cast<size_t>(m_chunkSize), static_cast<size_t>(PREFETCH_SEGMENT_SIZE));
+
+  bool bMappedCache = false;
+
   if (!m_pCache)
   {
     if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheMemSize == 0)
     {
       // Use cache on disk
-      m_pCache = new CSimpleFileCache();
-      m_forwardCacheSize = 0;
+#if defined(TARGET_POSIX)
+      const size_t diskSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheDiskSize;
+      if (diskSize > 0)
+      {
+        size_t back = diskSize / 4;
+        size_t front = diskSize - back;
+
+        if (m_flags & READ_MULTI_STREAM)
+        {
+          // READ_MULTI_STREAM requires double buffering, so use half the disk budget for each buffer
+          front /= 2;
+          back /= 2;
+        }
+        m_pCache = new CPosixMappedFileCache(front, back);
+        m_forwardCacheSize = front;
+        bMappedCache = true;
+      }
+      else
+#endif
+      {
+        m_pCache = new CSimpleFileCache();
+        m_forwardCacheSize = 0;
+      }
     }
     else
     {
@@ -194,6 +230,20 @@ bool CFileCache::Open(const CURL& url)
         cacheSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheMemSize;
       }
 
+      if (parallelReads > 1)
+      {
+        // the prefetcher buffers one segment per reader plus the one being
+        // consumed, take them out of the memory budget
+        const size_t prefetchSize = (parallelReads + 1) * segmentSize;
+        if (prefetchSize * 2 > CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheMemSize)
+        {
+          CLog::Log(LOGDEBUG, "CFileCache::Open - cache memory too small for %u parallel range requests", parallelReads);
+          parallelReads = 0;
+        }
+        else if (cacheSize + prefetchSize > CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheMemSize)
+          cacheSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheMemSize - prefetchSize;
+      }
+
       size_t back = cacheSize / 4;
       size_t front = cacheSize - back;
 
@@ -203,7 +253,14 @@ bool CFileCache::Open(const CURL& url)
         front /= 2;
         back /= 2;
       }
-      m_pCache = new CCircularCache(front, back);
+      if ((m_flags & READ_AUDIO_VIDEO) && m_seekPossible > 0)
+      {
+        // Keep the data around previous seek points, media files are often
+        // read at a few distant offsets (header, index, then the stream)
+        m_pCache = new CSparseCache(front, back);
+      }
+      else
+        m_pCache = new CCircularCache(front, back);
       m_forwardCacheSize = front;
     }
 
@@ -215,13 +272,34 @@ bool CFileCache::Open(const CURL& url)
   }
 
   // open cache strategy
-  if (!m_pCache || m_pCache->Open() != CACHE_RC_OK)
+  int cacheResult = m_pCache ? m_pCache->Open() : CACHE_RC_ERROR;
+  if (cacheResult != CACHE_RC_OK && bMappedCache)
+  {
+    // the disk budget couldn't be allocated or mapped (e.g. the temp folder
+    // is short on space), fall back to an unbounded temp file
+    CLog::Log(LOGWARNING, "CFileCache::Open - failed to open mapped cache, using a temp file");
+    delete m_pCache;
+    m_pCache = new CSimpleFileCache();
+    if (m_flags & READ_MULTI_STREAM)
+      m_pCache = new CDoubleCache(m_pCache);
+    m_forwardCacheSize = 0;
+    cacheResult = m_pCache->Open();
+  }
+
+  if (cacheResult != CACHE_RC_OK)
   {
     CLog::Log(LOGERROR,"CFileCache::Open - failed to open cache");
     Close();
     return false;
   }
 
+  if (parallelReads > 1)
+  {
+    CLog::Log(LOGDEBUG, "CFileCache::Open - reading with up to %u parallel range requests", parallelReads);
+    m_prefetcher.reset(new CRangePrefetcher(m_sourcePath, parallelReads, segmentSize));
+    m_prefetcher->Reset(0, m_fileSize);
+  }
+
   m_readPos = 0;
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
@@ -256,6 +334,7 @@ void CFileCache::Process()
   CWriteRate limiter;
   CWriteRate average;
   bool cacheReachEOF = false;
+  const unsigned int parallelReads = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheParallelReads;
 
   while (!m_bStop)
   {
@@ -271,7 +350,10 @@ void CFileCache::Process()
       bool sourceSeekFailed = false;
       if (!cacheReachEOF)
       {
-        m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
+        if (m_prefetcher)
+          m_nSeekResult = cacheMaxPos; // the prefetcher is repositioned below
+        else
+          m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
         {
           CLog::Log(LOGERROR,"CFileCache::Process - Error %d seeking. Seek returned %" PRId64, (int)GetLastError(), m_nSeekResult);
@@ -287,6 +369,8 @@ void CFileCache::Process()
         assert(m_writePos == cacheMaxPos);
         average.Reset(m_writePos, bCompleteReset); // Can only recalculate new average from scratch after a full reset (empty cache)
         limiter.Reset(m_writePos);
+        if (m_prefetcher)
+          m_prefetcher->Reset(m_writePos, m_fileSize);
         m_nSeekResult = m_seekPos;
         if (bCompleteReset)
         {
@@ -331,7 +415,24 @@ void CFileCache::Process()
 
     ssize_t iRead = 0;
     if (!cacheReachEOF)
-      iRead = m_source.Read(buffer.get(), maxWrite);
+    {
+      if (m_prefetcher)
+      {
+        iRead = m_prefetcher->Read(buffer.get(), maxWrite, 100);
+        if (iRead == CACHE_RC_WOULD_BLOCK)
+          continue;
+
+        if (iRead < 0)
+        {
+          CLog::Log(LOGWARNING, "CFileCache::Process - Parallel read failed, falling back to sequential reads");
+          m_prefetcher.reset();
+          if (m_source.Seek(m_writePos, SEEK_SET) == m_writePos)
+            continue;
+        }
+      }
+      else
+        iRead = m_source.Read(buffer.get(), maxWrite);
+    }
     if (iRead == 0)
     {
       // Check for actual EOF and retry as long as we still have data in our cache
@@ -438,6 +539,19 @@ void CFileCache::Process()
     {
       m_bFilling = true;
     }
+
+    if (m_prefetcher)
+    {
+      // Concurrent requests only help while the cache fills slower than the
+      // player reads, a single request keeps up with a full cache
+      if (m_bLowSpeedDetected || (m_bFilling && m_writeRateActual < m_writeRate * CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_cacheReadFactor))
+        m_prefetcher->SetReaders(parallelReads);
+      else if (!m_bFilling)
+        m_prefetcher->SetReaders(1);
+
+      // Don't fetch more than the cache can hold
+      m_prefetcher->SetLimit(m_forwardCacheSize > 0 ? m_readPos + m_forwardCacheSize : m_fileSize.load());
+    }
   }
 }
 
@@ -567,6 +681,7 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
 void CFileCache::Close()
 {
   StopThread();
+  m_prefetcher.reset();
 
   CSingleLock lock(m_sync);
   if (m_pCache)
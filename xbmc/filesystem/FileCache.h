@@ -14,9 +14,11 @@
 #include "File.h"
 #include "threads/Thread.h"
 #include <atomic>
+#include <memory>
 
 namespace XFILE
 {
+  class CRangePrefetcher;
 
   class CFileCache : public IFile, public CThread
   {
@@ -60,6 +62,7 @@ namespace XFILE
     bool m_bDeleteCache;
     int m_seekPossible;
     CFile m_source;
+    std::unique_ptr<CRangePrefetcher> m_prefetcher;
     std::string m_sourcePath;
     CEvent m_seekEvent;
     CEvent m_seekEnded;
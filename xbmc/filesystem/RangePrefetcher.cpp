@@ -0,0 +1,298 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "RangePrefetcher.h"
+#include "CacheStrategy.h"
+#include "File.h"
+#include "URL.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/log.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <string.h>
+
+using namespace XFILE;
+
+#define RANGE_READ_SIZE (64*1024)
+
+class CRangePrefetcher::CReader : public CThread
+{
+public:
+  explicit CReader(CRangePrefetcher &prefetcher) :
+    CThread("RangePrefetcher"),
+    m_prefetcher(prefetcher)
+  {
+  }
+
+protected:
+  // implementation of CThread
+  void Process() override
+  {
+    while (!m_bStop)
+    {
+      SegmentPtr segment = m_prefetcher.GetWork();
+      if (!segment)
+        break;
+
+      m_prefetcher.Complete(segment, Fetch(segment));
+    }
+
+    m_file.Close();
+  }
+
+private:
+  bool Fetch(const SegmentPtr &segment)
+  {
+    if (!m_bOpen)
+    {
+      if (!m_file.Open(m_prefetcher.m_path, READ_NO_CACHE | READ_TRUNCATED | READ_CHUNKED))
+      {
+        CLog::Log(LOGERROR, "CRangePrefetcher - failed to open source");
+        return false;
+      }
+      m_bOpen = true;
+    }
+
+    if (m_file.GetPosition() != segment->offset &&
+        m_file.Seek(segment->offset, SEEK_SET) != segment->offset)
+    {
+      CLog::Log(LOGERROR, "CRangePrefetcher - failed to seek to %" PRId64, segment->offset);
+      return false;
+    }
+
+    size_t filled = 0;
+    while (filled < segment->length && !m_bStop)
+    {
+      // Read in small steps, so data is available before the segment is complete
+      const size_t size = std::min(segment->length - filled, static_cast<size_t>(RANGE_READ_SIZE));
+
+      const ssize_t read = m_file.Read(segment->data.get() + filled, size);
+      if (read <= 0)
+      {
+        CLog::Log(LOGERROR, "CRangePrefetcher - read at %" PRId64 " returned %d", segment->offset + filled, static_cast<int>(read));
+        return false;
+      }
+
+      filled += read;
+
+      if (!m_prefetcher.AddData(segment, read))
+        break;
+    }
+
+    return true;
+  }
+
+  // Construction parameters
+  CRangePrefetcher &m_prefetcher;
+
+  // Source parameters
+  CFile m_file;
+  bool m_bOpen = false;
+};
+
+CRangePrefetcher::CRangePrefetcher(const std::string &path, unsigned int maxReaders, size_t segmentSize) :
+  m_path(path),
+  m_maxReaders(std::max(maxReaders, 1u)),
+  m_segmentSize(segmentSize)
+{
+  for (unsigned int i = 0; i < m_maxReaders; i++)
+  {
+    m_readerThreads.emplace_back(new CReader(*this));
+    m_readerThreads.back()->Create();
+  }
+}
+
+CRangePrefetcher::~CRangePrefetcher()
+{
+  Stop();
+}
+
+bool CRangePrefetcher::IsSupported(const CURL &url)
+{
+  return url.IsProtocol("http") ||
+         url.IsProtocol("https") ||
+         url.IsProtocol("dav") ||
+         url.IsProtocol("davs") ||
+         url.IsProtocol("nfs") ||
+         url.IsProtocol("smb");
+}
+
+void CRangePrefetcher::Reset(int64_t pos, int64_t fileSize)
+{
+  CSingleLock lock(m_sync);
+
+  // Requests in progress end at their next read
+  for (auto &segment : m_segments)
+    segment->bAborted = true;
+  m_segments.clear();
+
+  m_pos = pos;
+  m_fileSize = fileSize;
+  m_limit = pos;
+}
+
+void CRangePrefetcher::SetReaders(unsigned int readers)
+{
+  CSingleLock lock(m_sync);
+
+  readers = std::min(std::max(readers, 1u), m_maxReaders);
+  if (readers != m_readers)
+  {
+    m_readers = readers;
+    Schedule(false);
+  }
+}
+
+unsigned int CRangePrefetcher::GetReaders()
+{
+  CSingleLock lock(m_sync);
+
+  return m_readers;
+}
+
+void CRangePrefetcher::SetLimit(int64_t limit)
+{
+  CSingleLock lock(m_sync);
+
+  m_limit = limit;
+  Schedule(false);
+}
+
+ssize_t CRangePrefetcher::Read(char *buf, size_t size, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_pos >= m_fileSize)
+    return 0;
+
+  Schedule(true);
+
+  XbmcThreads::EndTime endTime(millis);
+
+  SegmentPtr segment = m_segments.front();
+  while (segment->consumed == segment->filled)
+  {
+    if (segment->state == SegmentState::FAILED)
+      return CACHE_RC_ERROR;
+
+    if (endTime.IsTimePast())
+      return CACHE_RC_WOULD_BLOCK;
+
+    m_dataCondition.wait(lock, endTime.MillisLeft());
+  }
+
+  size = std::min(size, segment->filled - segment->consumed);
+  memcpy(buf, segment->data.get() + segment->consumed, size);
+
+  segment->consumed += size;
+  m_pos += size;
+
+  if (segment->consumed == segment->length)
+  {
+    m_segments.pop_front();
+    Schedule(false);
+  }
+
+  return static_cast<ssize_t>(size);
+}
+
+CRangePrefetcher::SegmentPtr CRangePrefetcher::GetWork()
+{
+  CSingleLock lock(m_sync);
+
+  while (!m_bStopped)
+  {
+    if (m_fetching < m_readers)
+    {
+      // Fetch the segment needed soonest
+      for (auto &segment : m_segments)
+      {
+        if (segment->state == SegmentState::PENDING)
+        {
+          segment->state = SegmentState::FETCHING;
+          m_fetching++;
+          return segment;
+        }
+      }
+    }
+
+    m_workCondition.wait(lock);
+  }
+
+  return SegmentPtr();
+}
+
+bool CRangePrefetcher::AddData(const SegmentPtr &segment, size_t size)
+{
+  CSingleLock lock(m_sync);
+
+  segment->filled += size;
+  m_dataCondition.notifyAll();
+
+  return !segment->bAborted && !m_bStopped;
+}
+
+void CRangePrefetcher::Complete(const SegmentPtr &segment, bool bSuccess)
+{
+  CSingleLock lock(m_sync);
+
+  m_fetching--;
+
+  if (bSuccess && segment->filled == segment->length)
+    segment->state = SegmentState::DONE;
+  else if (!segment->bAborted)
+    segment->state = SegmentState::FAILED;
+
+  m_dataCondition.notifyAll();
+  m_workCondition.notifyAll();
+}
+
+void CRangePrefetcher::Schedule(bool bForce)
+{
+  int64_t next = m_segments.empty() ? m_pos : m_segments.back()->offset + m_segments.back()->length;
+
+  // Keep one segment more than readers, so a reader is never idle waiting
+  // for the segment at the read position to be consumed
+  while (m_segments.size() < m_readers + 1 && next < m_fileSize)
+  {
+    if (next >= m_limit && !(bForce && m_segments.empty()))
+      break;
+
+    SegmentPtr segment = std::make_shared<Segment>();
+    segment->offset = next;
+    segment->length = static_cast<size_t>(std::min(static_cast<int64_t>(m_segmentSize), m_fileSize - next));
+    segment->data.reset(new char[segment->length]);
+
+    m_segments.push_back(segment);
+    next += segment->length;
+  }
+
+  m_workCondition.notifyAll();
+}
+
+void CRangePrefetcher::Stop()
+{
+  {
+    CSingleLock lock(m_sync);
+
+    m_bStopped = true;
+    for (auto &segment : m_segments)
+      segment->bAborted = true;
+    m_segments.clear();
+
+    m_workCondition.notifyAll();
+    m_dataCondition.notifyAll();
+  }
+
+  for (auto &reader : m_readerThreads)
+    reader->StopThread(true);
+  m_readerThreads.clear();
+}
@@ -0,0 +1,133 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/Condition.h"
+#include "threads/CriticalSection.h"
+
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+class CURL;
+
+namespace XFILE
+{
+
+/*!
+ * \brief Reads a file with several concurrent range requests
+ *
+ * On links with a high round-trip time a single sequential reader can't
+ * reach the link rate. The prefetcher splits the file ahead of the read
+ * position into segments, fetches them concurrently on separate
+ * connections and returns the data in file order.
+ *
+ * Segments are read as soon as their first bytes arrive, so the
+ * prefetcher adds no latency over a sequential reader.
+ */
+class CRangePrefetcher
+{
+public:
+  /*!
+   * \param path The source to read
+   * \param maxReaders The max number of concurrent requests
+   * \param segmentSize The size of each range request
+   */
+  CRangePrefetcher(const std::string &path, unsigned int maxReaders, size_t segmentSize);
+  ~CRangePrefetcher();
+
+  /*!
+   * \brief Check if a source can be read with concurrent range requests
+   */
+  static bool IsSupported(const CURL &url);
+
+  /*!
+   * \brief Drop everything fetched and continue from a new position
+   */
+  void Reset(int64_t pos, int64_t fileSize);
+
+  /*!
+   * \brief Set the number of concurrent requests, from 1 up to the max
+   */
+  void SetReaders(unsigned int readers);
+  unsigned int GetReaders();
+
+  /*!
+   * \brief Don't start requests for data past this position
+   *
+   * The segment at the read position is always fetched.
+   */
+  void SetLimit(int64_t limit);
+
+  /*!
+   * \brief Read data at the current position
+   *
+   * \return The number of bytes read, 0 at the end of the file,
+   *         CACHE_RC_WOULD_BLOCK if no data arrived in time, or
+   *         CACHE_RC_ERROR if a range request failed
+   */
+  ssize_t Read(char *buf, size_t size, unsigned int millis);
+
+private:
+  class CReader;
+
+  enum class SegmentState
+  {
+    PENDING,
+    FETCHING,
+    DONE,
+    FAILED,
+  };
+
+  struct Segment
+  {
+    int64_t offset = 0;
+    size_t length = 0;
+    std::unique_ptr<char[]> data;
+    size_t filled = 0; // Written by the reader that fetches the segment
+    size_t consumed = 0;
+    SegmentState state = SegmentState::PENDING;
+    bool bAborted = false;
+  };
+
+  using SegmentPtr = std::shared_ptr<Segment>;
+
+  // Called by the readers
+  SegmentPtr GetWork();
+  bool AddData(const SegmentPtr &segment, size_t size);
+  void Complete(const SegmentPtr &segment, bool bSuccess);
+
+  void Schedule(bool bForce);
+  void Stop();
+
+  // Construction parameters
+  const std::string m_path;
+  const unsigned int m_maxReaders;
+  const size_t m_segmentSize;
+
+  // Prefetch state
+  std::deque<SegmentPtr> m_segments; // Consecutive segments from the read position
+  int64_t m_pos = 0;
+  int64_t m_fileSize = 0;
+  int64_t m_limit = 0;
+  unsigned int m_readers = 1;
+  unsigned int m_fetching = 0;
+  bool m_bStopped = false;
+  std::vector<std::unique_ptr<CReader>> m_readerThreads;
+
+  // Synchronization parameters
+  CCriticalSection m_sync;
+  XbmcThreads::ConditionVariable m_workCondition;
+  XbmcThreads::ConditionVariable m_dataCondition;
+};
+
+}
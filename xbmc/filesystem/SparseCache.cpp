@@ -0,0 +1,504 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "SparseCache.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string.h>
+
+using namespace XFILE;
+
+constexpr size_t CSparseCache::BLOCK_SIZE;
+
+CSparseCache::CSparseCache(size_t front, size_t back)
+ : CCacheStrategy()
+ , m_size(front + back)
+ , m_size_back(back)
+ // Allow for partially used blocks at both ends of the current range
+ , m_maxBlocks((front + back) / BLOCK_SIZE + 2)
+ , m_current(m_ranges.end())
+{
+}
+
+CSparseCache::~CSparseCache()
+{
+  Close();
+}
+
+int CSparseCache::Open()
+{
+  CSingleLock lock(m_sync);
+
+  ClearRanges();
+
+  m_current = m_ranges.emplace(0, Range()).first;
+  m_cur = 0;
+  Touch(m_current);
+
+  return CACHE_RC_OK;
+}
+
+void CSparseCache::Close()
+{
+  CSingleLock lock(m_sync);
+
+  ClearRanges();
+
+  for (uint8_t *block : m_freeBlocks)
+    delete[] block;
+  m_freeBlocks.clear();
+  m_allocatedBlocks = 0;
+}
+
+size_t CSparseCache::GetMaxWriteSize(const size_t& iRequestSize)
+{
+  CSingleLock lock(m_sync);
+
+  return GetMaxWriteSizeInternal(iRequestSize);
+}
+
+/**
+ * Appends data to the end of the current range. Any range that the new data
+ * overlaps is trimmed, so ranges stay disjoint.
+ *
+ * Like CCircularCache, data ahead of the read position is limited to the
+ * front size, and the back buffer is only reclaimed down to its guaranteed
+ * size.
+ */
+int CSparseCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_current == m_ranges.end())
+    return CACHE_RC_ERROR;
+
+  len = GetMaxWriteSizeInternal(len);
+  if (len == 0)
+    return 0;
+
+  size_t written = 0;
+  while (written < len)
+  {
+    Range &range = m_current->second;
+    const size_t blockIndex = static_cast<size_t>(range.end / BLOCK_SIZE - m_current->first / BLOCK_SIZE);
+
+    if (blockIndex == range.blocks.size())
+    {
+      // May evict the front of the current range, so look it up again
+      uint8_t *block = AllocateBlock();
+      if (block == nullptr)
+        break;
+
+      m_current->second.blocks.push_back(block);
+      continue;
+    }
+
+    const size_t offset = static_cast<size_t>(range.end % BLOCK_SIZE);
+    const size_t count = std::min(len - written, BLOCK_SIZE - offset);
+
+    memcpy(range.blocks[blockIndex] + offset, buf + written, count);
+
+    range.end += count;
+    written += count;
+  }
+
+  // Drop data that has been written again
+  const int64_t end = m_current->second.end;
+  RangeMap::iterator next = std::next(m_current);
+  while (next != m_ranges.end() && next->first < end)
+  {
+    if (next->second.end <= end)
+    {
+      EraseRange(next);
+      next = std::next(m_current);
+    }
+    else
+    {
+      TrimRange(next, end);
+      break;
+    }
+  }
+
+  if (written > 0)
+    m_written.Set();
+
+  return static_cast<int>(written);
+}
+
+/**
+ * Reads data from the current range. Will only read up till
+ * the end of a block. So multiple calls may be needed
+ */
+int CSparseCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_current == m_ranges.end())
+    return CACHE_RC_ERROR;
+
+  const Range &range = m_current->second;
+
+  const size_t front = static_cast<size_t>(range.end - m_cur);
+  if (front == 0)
+  {
+    if (IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  const size_t blockIndex = static_cast<size_t>(m_cur / BLOCK_SIZE - m_current->first / BLOCK_SIZE);
+  const size_t offset = static_cast<size_t>(m_cur % BLOCK_SIZE);
+  const size_t avail = std::min(front, BLOCK_SIZE - offset);
+
+  if (len > avail)
+    len = avail;
+
+  if (len == 0)
+    return 0;
+
+  memcpy(buf, range.blocks[blockIndex] + offset, len);
+  m_cur += len;
+
+  Touch(m_current);
+
+  m_space.Set();
+
+  return static_cast<int>(len);
+}
+
+/* Wait "millis" milliseconds for "minimum" amount of data to come in.
+ * Note that caller needs to make sure there's sufficient space in the forward
+ * buffer for "minimum" bytes else we may block the full timeout time
+ */
+int64_t CSparseCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_current == m_ranges.end())
+    return 0;
+
+  int64_t avail = m_current->second.end - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_size - m_size_back)
+    minimum = m_size - m_size_back;
+
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+
+    if (m_current == m_ranges.end())
+      return 0;
+
+    avail = m_current->second.end - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CSparseCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_current == m_ranges.end())
+    return CACHE_RC_ERROR;
+
+  // if seek is a bit over what we have, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  const int64_t end = m_current->second.end;
+  if (pos >= end && pos < end + 100000)
+  {
+    m_cur = end;
+    lock.Leave();
+    WaitForData(static_cast<unsigned int>(pos - end), 5000);
+    lock.Enter();
+  }
+
+  // Only the current range is being filled, so other ranges are reached
+  // through Reset() once the source has been positioned at their end
+  if (m_current != m_ranges.end() &&
+      pos >= m_current->first && pos <= m_current->second.end)
+  {
+    m_cur = pos;
+    Touch(m_current);
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+bool CSparseCache::Reset(int64_t pos, bool clearAnyway)
+{
+  CSingleLock lock(m_sync);
+
+  RangeMap::iterator previous = m_current;
+
+  if (clearAnyway)
+  {
+    ClearRanges();
+    previous = m_ranges.end();
+  }
+  else
+  {
+    RangeMap::iterator it = FindRange(pos);
+    if (it != m_ranges.end())
+    {
+      m_current = it;
+      m_cur = pos;
+      Touch(m_current);
+
+      if (previous != m_ranges.end() && previous != m_current && previous->second.blocks.empty())
+        m_ranges.erase(previous);
+
+      return false;
+    }
+  }
+
+  if (previous != m_ranges.end() && previous->second.blocks.empty())
+    m_ranges.erase(previous);
+
+  // Start a new range, keeping the others
+  m_current = m_ranges.emplace(pos, Range()).first;
+  m_current->second.end = pos;
+  m_cur = pos;
+  Touch(m_current);
+
+  return true;
+}
+
+int64_t CSparseCache::CachedDataEndPosIfSeekTo(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+
+  RangeMap::iterator it = FindRange(iFilePosition);
+  if (it != m_ranges.end())
+    return it->second.end;
+
+  return iFilePosition;
+}
+
+int64_t CSparseCache::CachedDataEndPos()
+{
+  CSingleLock lock(m_sync);
+
+  if (m_current == m_ranges.end())
+    return 0;
+
+  return m_current->second.end;
+}
+
+bool CSparseCache::IsCachedPosition(int64_t iFilePosition)
+{
+  CSingleLock lock(m_sync);
+
+  return FindRange(iFilePosition) != m_ranges.end();
+}
+
+CCacheStrategy *CSparseCache::CreateNew()
+{
+  return new CSparseCache(m_size - m_size_back, m_size_back);
+}
+
+size_t CSparseCache::GetRangeCount()
+{
+  CSingleLock lock(m_sync);
+
+  return m_ranges.size();
+}
+
+CSparseCache::RangeMap::iterator CSparseCache::FindRange(int64_t pos)
+{
+  RangeMap::iterator it = m_ranges.upper_bound(pos);
+  if (it == m_ranges.begin())
+    return m_ranges.end();
+
+  --it;
+  if (pos <= it->second.end)
+    return it;
+
+  return m_ranges.end();
+}
+
+CSparseCache::RangeMap::iterator CSparseCache::MoveRange(RangeMap::iterator it, int64_t start)
+{
+  const bool bCurrent = (it == m_current);
+
+  Range range = std::move(it->second);
+  m_ranges.erase(it);
+
+  RangeMap::iterator moved = m_ranges.emplace(start, std::move(range)).first;
+  if (bCurrent)
+    m_current = moved;
+
+  return moved;
+}
+
+void CSparseCache::TrimRange(RangeMap::iterator it, int64_t start)
+{
+  Range &range = it->second;
+
+  size_t count = static_cast<size_t>(start / BLOCK_SIZE - it->first / BLOCK_SIZE);
+  count = std::min(count, range.blocks.size());
+
+  for (size_t i = 0; i < count; i++)
+  {
+    m_freeBlocks.push_back(range.blocks.front());
+    range.blocks.pop_front();
+  }
+
+  MoveRange(it, start);
+}
+
+void CSparseCache::EraseRange(RangeMap::iterator it)
+{
+  for (uint8_t *block : it->second.blocks)
+    m_freeBlocks.push_back(block);
+
+  m_ranges.erase(it);
+}
+
+void CSparseCache::Touch(RangeMap::iterator it)
+{
+  it->second.lastUsed = ++m_useCounter;
+}
+
+size_t CSparseCache::GetMaxWriteSizeInternal(size_t requestSize)
+{
+  if (m_current == m_ranges.end())
+    return 0;
+
+  const Range &range = m_current->second;
+
+  const int64_t back = m_cur - m_current->first;
+  const int64_t front = range.end - m_cur;
+  const int64_t limit = static_cast<int64_t>(m_size) - std::min(back, static_cast<int64_t>(m_size_back)) - front;
+
+  if (limit <= 0)
+    return 0;
+
+  // Room left in the last block
+  const size_t blockIndex = static_cast<size_t>(range.end / BLOCK_SIZE - m_current->first / BLOCK_SIZE);
+  size_t capacity = 0;
+  if (blockIndex < range.blocks.size())
+    capacity = BLOCK_SIZE - static_cast<size_t>(range.end % BLOCK_SIZE);
+
+  // Blocks that can be allocated or evicted
+  size_t blocks = (m_maxBlocks - m_allocatedBlocks) + m_freeBlocks.size() + GetEvictableBlocks(m_current);
+  for (const auto &it : m_ranges)
+  {
+    if (&it.second != &range)
+      blocks += it.second.blocks.size();
+  }
+  capacity += blocks * BLOCK_SIZE;
+
+  return std::min(requestSize, std::min(static_cast<size_t>(limit), capacity));
+}
+
+size_t CSparseCache::GetEvictableBlocks(RangeMap::iterator it)
+{
+  const Range &range = it->second;
+
+  // Keep the guaranteed back buffer, and the block being written
+  const int64_t keepFrom = m_cur - static_cast<int64_t>(m_size_back);
+  if (keepFrom <= it->first || range.blocks.empty())
+    return 0;
+
+  const size_t count = static_cast<size_t>(keepFrom / BLOCK_SIZE - it->first / BLOCK_SIZE);
+
+  return std::min(count, range.blocks.size() - 1);
+}
+
+uint8_t *CSparseCache::AllocateBlock()
+{
+  if (m_freeBlocks.empty())
+  {
+    if (m_allocatedBlocks < m_maxBlocks)
+    {
+      m_allocatedBlocks++;
+      return new uint8_t[BLOCK_SIZE];
+    }
+
+    if (!EvictBlock())
+      return nullptr;
+  }
+
+  uint8_t *block = m_freeBlocks.back();
+  m_freeBlocks.pop_back();
+
+  return block;
+}
+
+bool CSparseCache::EvictBlock()
+{
+  // Evict from the end of the least recently used range
+  RangeMap::iterator lru = m_ranges.end();
+  for (RangeMap::iterator it = m_ranges.begin(); it != m_ranges.end(); ++it)
+  {
+    if (it == m_current || it->second.blocks.empty())
+      continue;
+
+    if (lru == m_ranges.end() || it->second.lastUsed < lru->second.lastUsed)
+      lru = it;
+  }
+
+  if (lru != m_ranges.end())
+  {
+    Range &range = lru->second;
+
+    m_freeBlocks.push_back(range.blocks.back());
+    range.blocks.pop_back();
+
+    if (range.blocks.empty())
+    {
+      m_ranges.erase(lru);
+    }
+    else
+    {
+      const int64_t blocksEnd = (lru->first / BLOCK_SIZE + static_cast<int64_t>(range.blocks.size())) * BLOCK_SIZE;
+      range.end = std::min(range.end, blocksEnd);
+    }
+
+    return true;
+  }
+
+  // Fall back to the back buffer of the current range
+  if (GetEvictableBlocks(m_current) > 0)
+  {
+    Range &range = m_current->second;
+
+    m_freeBlocks.push_back(range.blocks.front());
+    range.blocks.pop_front();
+
+    MoveRange(m_current, (m_current->first / BLOCK_SIZE + 1) * BLOCK_SIZE);
+
+    return true;
+  }
+
+  return false;
+}
+
+void CSparseCache::ClearRanges()
+{
+  for (auto &it : m_ranges)
+  {
+    for (uint8_t *block : it.second.blocks)
+      m_freeBlocks.push_back(block);
+  }
+
+  m_ranges.clear();
+  m_current = m_ranges.end();
+}
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <deque>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+namespace XFILE {
+
+/*!
+ * \brief Memory cache holding several disjoint ranges of a file
+ *
+ * Unlike CCircularCache, which drops everything on a seek outside its single
+ * window, the ranges cached before a seek are kept until their memory is
+ * needed. Seeking back to them (e.g. to the index of an MKV or MP4 file)
+ * only has to fetch data past the end of the range.
+ *
+ * Memory is allocated in fixed-size blocks aligned to file offsets, up to a
+ * fixed budget. Data is always written at the end of the current range. When
+ * a block is needed and the budget is spent, blocks are evicted from the end
+ * of the least recently used other range, and then from the back buffer of
+ * the current range.
+ */
+class CSparseCache : public CCacheStrategy
+{
+public:
+  /*!
+   * \param front Max bytes cached ahead of the read position
+   * \param back Min bytes kept behind the read position
+   */
+  CSparseCache(size_t front, size_t back);
+  ~CSparseCache() override;
+
+  int Open() override;
+  void Close() override;
+
+  size_t GetMaxWriteSize(const size_t& iRequestSize) override;
+  int WriteToCache(const char *buf, size_t len) override;
+  int ReadFromCache(char *buf, size_t len) override;
+  int64_t WaitForData(unsigned int minimum, unsigned int iMillis) override;
+
+  int64_t Seek(int64_t pos) override;
+  bool Reset(int64_t pos, bool clearAnyway=true) override;
+
+  int64_t CachedDataEndPosIfSeekTo(int64_t iFilePosition) override;
+  int64_t CachedDataEndPos() override;
+  bool IsCachedPosition(int64_t iFilePosition) override;
+
+  CCacheStrategy *CreateNew() override;
+
+  /*!
+   * \brief Get the number of disjoint ranges in the cache
+   */
+  size_t GetRangeCount();
+
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+protected:
+  struct Range
+  {
+    int64_t end = 0; // Index in file of the end of valid data, the start is the map key
+    std::deque<uint8_t*> blocks; // The first block holds the start of the range
+    uint64_t lastUsed = 0;
+  };
+
+  using RangeMap = std::map<int64_t, Range>;
+
+  RangeMap::iterator FindRange(int64_t pos);
+  RangeMap::iterator MoveRange(RangeMap::iterator it, int64_t start);
+  void TrimRange(RangeMap::iterator it, int64_t start);
+  void EraseRange(RangeMap::iterator it);
+  void Touch(RangeMap::iterator it);
+
+  size_t GetMaxWriteSizeInternal(size_t requestSize);
+  size_t GetEvictableBlocks(RangeMap::iterator it);
+  uint8_t *AllocateBlock();
+  bool EvictBlock();
+  void ClearRanges();
+
+  // Construction parameters
+  const size_t m_size; /**< memory budget, front + back */
+  const size_t m_size_back; /**< guaranteed size of back buffer of the current range */
+  const size_t m_maxBlocks;
+
+  // Cache state
+  RangeMap m_ranges;
+  RangeMap::iterator m_current; /**< range being read and written */
+  int64_t m_cur = 0; /**< current reading index in file */
+  uint64_t m_useCounter = 0;
+  std::vector<uint8_t*> m_freeBlocks;
+  size_t m_allocatedBlocks = 0;
+  CCriticalSection m_sync;
+  CEvent m_written;
+};
+
+} // namespace XFILE
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "FileItem.h"
+#include "filesystem/DirectoryCache.h"
+#include "filesystem/File.h"
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace XFILE;
+
+namespace
+{
+const std::string LISTING_PATH = "smb://server/share/movies";
+const long long LISTING_MTIME = 1500000000;
+const long long LISTING_INODE = 42;
+}
+
+class TestDirectoryCacheListing : public testing::Test
+{
+protected:
+  TestDirectoryCacheListing()
+  {
+    m_file = XBMC_CREATETEMPFILE("");
+    if (m_file)
+    {
+      m_file->Close();
+      m_path = XBMC_TEMPFILEPATH(m_file);
+    }
+  }
+
+  ~TestDirectoryCacheListing() override
+  {
+    if (m_file)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  void SaveListing()
+  {
+    CFileItemList items;
+    for (int i = 0; i < 20; i++)
+    {
+      CFileItemPtr item(new CFileItem(LISTING_PATH + "/movie" + std::to_string(i) + ".mkv", false));
+      item->m_dwSize = 1000000 + i;
+      items.Add(item);
+    }
+    ASSERT_TRUE(CDirectoryCache::SaveListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, true, items));
+  }
+
+  CFile *m_file = nullptr;
+  std::string m_path;
+};
+
+TEST_F(TestDirectoryCacheListing, SaveLoad)
+{
+  ASSERT_NE(nullptr, m_file);
+  SaveListing();
+
+  // The listing is written to a temp file, then renamed
+  EXPECT_FALSE(CFile::Exists(m_path + ".tmp", false));
+
+  CFileItemList items;
+  ASSERT_TRUE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, true, items));
+  ASSERT_EQ(items.Size(), 20);
+  EXPECT_EQ(items[3]->GetPath(), LISTING_PATH + "/movie3.mkv");
+  EXPECT_EQ(items[3]->m_dwSize, 1000003);
+
+  // A listing with file info serves requests without it
+  EXPECT_TRUE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, false, items));
+}
+
+TEST_F(TestDirectoryCacheListing, Changed)
+{
+  ASSERT_NE(nullptr, m_file);
+  SaveListing();
+
+  CFileItemList items;
+  EXPECT_FALSE(CDirectoryCache::LoadListing(m_path, LISTING_PATH + "/other", LISTING_MTIME, LISTING_INODE, true, items));
+  EXPECT_FALSE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME + 1, LISTING_INODE, true, items));
+  EXPECT_FALSE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE + 1, true, items));
+
+  // A listing without file info doesn't serve requests that need it
+  ASSERT_TRUE(CDirectoryCache::SaveListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, false, items));
+  EXPECT_FALSE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, true, items));
+  EXPECT_TRUE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, false, items));
+}
+
+TEST_F(TestDirectoryCacheListing, Truncated)
+{
+  ASSERT_NE(nullptr, m_file);
+  SaveListing();
+
+  std::vector<uint8_t> data;
+  {
+    CFile file;
+    ASSERT_TRUE(file.Open(m_path));
+    data.resize(static_cast<size_t>(file.GetLength()));
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), file.Read(data.data(), data.size()));
+  }
+  ASSERT_GT(data.size(), 100u);
+
+  CFileItemList items;
+  CFile file;
+
+  // Cut off before the end marker, in the items, and after the header
+  const size_t sizes[] = { data.size() - 4, data.size() / 2, 64 };
+  for (size_t size : sizes)
+  {
+    ASSERT_TRUE(file.OpenForWrite(m_path, true));
+    ASSERT_EQ(static_cast<ssize_t>(size), file.Write(data.data(), size));
+    file.Close();
+    EXPECT_FALSE(CDirectoryCache::LoadListing(m_path, LISTING_PATH, LISTING_MTIME, LISTING_INODE, true, items)) << "truncated to " << size;
+  }
+
+  EXPECT_TRUE(items.IsEmpty());
+}
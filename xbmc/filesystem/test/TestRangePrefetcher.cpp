@@ -0,0 +1,149 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "filesystem/CacheStrategy.h"
+#include "filesystem/File.h"
+#include "filesystem/RangePrefetcher.h"
+#include "test/TestUtils.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace XFILE;
+
+namespace
+{
+  constexpr size_t SEGMENT_SIZE = 64 * 1024;
+  constexpr int64_t FILE_SIZE = 20 * SEGMENT_SIZE + 123;
+
+  // Give up on a prefetcher that makes no progress for this long
+  constexpr unsigned int STALL_TIMEOUT_MS = 10000;
+
+  char GetByte(int64_t pos)
+  {
+    return static_cast<char>((pos * 13) & 0xff);
+  }
+
+  // Read from "pos" until "end", the end of the file or a stall. Returns
+  // the position reached, or -1 if the data read doesn't match the file.
+  int64_t ReadUntil(CRangePrefetcher &prefetcher, int64_t pos, int64_t end)
+  {
+    std::vector<char> buffer(10000); // Not a multiple of the segment size
+    XbmcThreads::EndTime deadline(STALL_TIMEOUT_MS);
+
+    while (pos < end)
+    {
+      const size_t count = static_cast<size_t>(std::min(static_cast<int64_t>(buffer.size()), end - pos));
+      const ssize_t read = prefetcher.Read(buffer.data(), count, 100);
+      if (read == CACHE_RC_WOULD_BLOCK)
+      {
+        if (deadline.IsTimePast())
+          break;
+        continue;
+      }
+      if (read <= 0)
+        break;
+
+      for (ssize_t i = 0; i < read; i++)
+      {
+        if (buffer[i] != GetByte(pos + i))
+          return -1;
+      }
+      pos += read;
+      deadline.Set(STALL_TIMEOUT_MS);
+    }
+
+    return pos;
+  }
+}
+
+class TestRangePrefetcher : public testing::Test
+{
+protected:
+  TestRangePrefetcher()
+  {
+    m_file = XBMC_CREATETEMPFILE("");
+    if (m_file == nullptr)
+      return;
+    m_file->Close();
+
+    std::vector<char> data(static_cast<size_t>(FILE_SIZE));
+    for (size_t i = 0; i < data.size(); i++)
+      data[i] = GetByte(i);
+
+    if (m_file->OpenForWrite(XBMC_TEMPFILEPATH(m_file), true))
+    {
+      m_file->Write(data.data(), data.size());
+      m_file->Close();
+    }
+  }
+
+  ~TestRangePrefetcher() override
+  {
+    if (m_file != nullptr)
+      XBMC_DELETETEMPFILE(m_file);
+  }
+
+  CFile *m_file = nullptr;
+};
+
+TEST_F(TestRangePrefetcher, ReadInOrder)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  CRangePrefetcher prefetcher(XBMC_TEMPFILEPATH(m_file), 4, SEGMENT_SIZE);
+  prefetcher.Reset(0, FILE_SIZE);
+  prefetcher.SetReaders(4);
+  prefetcher.SetLimit(FILE_SIZE);
+
+  EXPECT_EQ(FILE_SIZE, ReadUntil(prefetcher, 0, FILE_SIZE));
+
+  // At the end of the file
+  char byte;
+  EXPECT_EQ(0, prefetcher.Read(&byte, 1, 100));
+}
+
+TEST_F(TestRangePrefetcher, Seek)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  CRangePrefetcher prefetcher(XBMC_TEMPFILEPATH(m_file), 4, SEGMENT_SIZE);
+  prefetcher.Reset(0, FILE_SIZE);
+  prefetcher.SetReaders(4);
+  prefetcher.SetLimit(FILE_SIZE);
+
+  ASSERT_EQ(static_cast<int64_t>(3 * SEGMENT_SIZE), ReadUntil(prefetcher, 0, 3 * SEGMENT_SIZE));
+
+  // Continue from an offset that isn't on a segment boundary
+  const int64_t seekPos = 11 * SEGMENT_SIZE + 7;
+  prefetcher.Reset(seekPos, FILE_SIZE);
+  EXPECT_EQ(FILE_SIZE, ReadUntil(prefetcher, seekPos, FILE_SIZE));
+
+  // And back
+  prefetcher.Reset(5, FILE_SIZE);
+  EXPECT_EQ(FILE_SIZE, ReadUntil(prefetcher, 5, FILE_SIZE));
+}
+
+TEST_F(TestRangePrefetcher, ChangeReaders)
+{
+  ASSERT_NE(nullptr, m_file);
+
+  CRangePrefetcher prefetcher(XBMC_TEMPFILEPATH(m_file), 4, SEGMENT_SIZE);
+  prefetcher.Reset(0, FILE_SIZE);
+  prefetcher.SetReaders(1);
+  prefetcher.SetLimit(FILE_SIZE);
+
+  ASSERT_EQ(static_cast<int64_t>(4 * SEGMENT_SIZE), ReadUntil(prefetcher, 0, 4 * SEGMENT_SIZE));
+
+  prefetcher.SetReaders(4);
+  EXPECT_EQ(4U, prefetcher.GetReaders());
+  EXPECT_EQ(FILE_SIZE, ReadUntil(prefetcher, 4 * SEGMENT_SIZE, FILE_SIZE));
+}
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "filesystem/SparseCache.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace XFILE;
+
+namespace
+{
+  constexpr size_t BLOCK_SIZE = CSparseCache::BLOCK_SIZE;
+
+  char GetByte(int64_t pos)
+  {
+    return static_cast<char>((pos * 7) & 0xff);
+  }
+
+  // Write "size" bytes at the end of the current range, reading them back as
+  // a player would. Returns false if the data read doesn't match.
+  bool Stream(CSparseCache &cache, size_t size)
+  {
+    std::vector<char> buffer(4096);
+
+    while (size > 0)
+    {
+      const int64_t pos = cache.CachedDataEndPos();
+      const size_t count = std::min(size, buffer.size());
+      for (size_t i = 0; i < count; i++)
+        buffer[i] = GetByte(pos + i);
+
+      const int written = cache.WriteToCache(buffer.data(), count);
+      if (written <= 0)
+        return false;
+      size -= written;
+
+      int64_t readPos = cache.CachedDataEndPos() - written;
+      int read;
+      while ((read = cache.ReadFromCache(buffer.data(), buffer.size())) > 0)
+      {
+        for (int i = 0; i < read; i++)
+        {
+          if (buffer[i] != GetByte(readPos + i))
+            return false;
+        }
+        readPos += read;
+      }
+    }
+
+    return true;
+  }
+}
+
+TEST(TestSparseCache, WriteAndRead)
+{
+  CSparseCache cache(3 * BLOCK_SIZE, BLOCK_SIZE);
+  ASSERT_EQ(cache.Open(), CACHE_RC_OK);
+
+  EXPECT_TRUE(Stream(cache, 2 * BLOCK_SIZE + 100));
+  EXPECT_EQ(cache.CachedDataEndPos(), static_cast<int64_t>(2 * BLOCK_SIZE + 100));
+
+  char byte;
+  EXPECT_EQ(cache.ReadFromCache(&byte, 1), CACHE_RC_WOULD_BLOCK);
+
+  // Seek within the back buffer
+  EXPECT_EQ(cache.Seek(1000), 1000);
+  ASSERT_EQ(cache.ReadFromCache(&byte, 1), 1);
+  EXPECT_EQ(byte, GetByte(1000));
+}
+
+TEST(TestSparseCache, KeepRangesAcrossSeeks)
+{
+  CSparseCache cache(3 * BLOCK_SIZE, BLOCK_SIZE);
+  ASSERT_EQ(cache.Open(), CACHE_RC_OK);
+
+  EXPECT_TRUE(Stream(cache, 1000));
+
+  // Outside of the current range, the source has to seek
+  EXPECT_EQ(cache.Seek(100 * BLOCK_SIZE), CACHE_RC_ERROR);
+  EXPECT_TRUE(cache.Reset(100 * BLOCK_SIZE, false));
+  EXPECT_TRUE(Stream(cache, 1000));
+  EXPECT_EQ(cache.GetRangeCount(), 2u);
+
+  EXPECT_TRUE(cache.IsCachedPosition(500));
+  EXPECT_TRUE(cache.IsCachedPosition(100 * BLOCK_SIZE + 500));
+  EXPECT_FALSE(cache.IsCachedPosition(50 * BLOCK_SIZE));
+
+  EXPECT_EQ(cache.CachedDataEndPosIfSeekTo(500), 1000);
+  EXPECT_EQ(cache.CachedDataEndPosIfSeekTo(50 * BLOCK_SIZE), static_cast<int64_t>(50 * BLOCK_SIZE));
+
+  // Seeking back to the first range only switches ranges
+  EXPECT_FALSE(cache.Reset(500, false));
+  EXPECT_EQ(cache.CachedDataEndPos(), 1000);
+
+  char byte;
+  ASSERT_EQ(cache.ReadFromCache(&byte, 1), 1);
+  EXPECT_EQ(byte, GetByte(500));
+
+  // A full reset drops every range
+  EXPECT_TRUE(cache.Reset(0));
+  EXPECT_EQ(cache.GetRangeCount(), 1u);
+  EXPECT_FALSE(cache.IsCachedPosition(500));
+}
+
+TEST(TestSparseCache, OverwriteNextRange)
+{
+  CSparseCache cache(3 * BLOCK_SIZE, BLOCK_SIZE);
+  ASSERT_EQ(cache.Open(), CACHE_RC_OK);
+
+  EXPECT_TRUE(cache.Reset(BLOCK_SIZE, false));
+  EXPECT_TRUE(Stream(cache, BLOCK_SIZE));
+
+  // Writing from 0 runs into the range at BLOCK_SIZE, which is trimmed
+  EXPECT_TRUE(cache.Reset(0, false));
+  EXPECT_TRUE(Stream(cache, BLOCK_SIZE + 100));
+  EXPECT_EQ(cache.GetRangeCount(), 2u);
+  EXPECT_EQ(cache.CachedDataEndPos(), static_cast<int64_t>(BLOCK_SIZE + 100));
+  EXPECT_EQ(cache.CachedDataEndPosIfSeekTo(BLOCK_SIZE + 100), static_cast<int64_t>(2 * BLOCK_SIZE));
+}
+
+TEST(TestSparseCache, EvictLeastRecentlyUsed)
+{
+  // Budget of 4 blocks, and 2 more for partially used blocks
+  CSparseCache cache(3 * BLOCK_SIZE, BLOCK_SIZE);
+  ASSERT_EQ(cache.Open(), CACHE_RC_OK);
+
+  EXPECT_TRUE(Stream(cache, 2 * BLOCK_SIZE));
+  EXPECT_TRUE(cache.Reset(100 * BLOCK_SIZE, false));
+  EXPECT_TRUE(Stream(cache, 2 * BLOCK_SIZE));
+  EXPECT_TRUE(cache.Reset(200 * BLOCK_SIZE, false));
+
+  // Use the first range, so the second is the least recently used
+  EXPECT_FALSE(cache.Reset(0, false));
+  EXPECT_TRUE(cache.Reset(200 * BLOCK_SIZE, false));
+
+  // The end of the second range is evicted first
+  EXPECT_TRUE(Stream(cache, 3 * BLOCK_SIZE));
+  EXPECT_EQ(cache.CachedDataEndPosIfSeekTo(0), static_cast<int64_t>(2 * BLOCK_SIZE));
+  EXPECT_EQ(cache.CachedDataEndPosIfSeekTo(100 * BLOCK_SIZE), static_cast<int64_t>(101 * BLOCK_SIZE));
+
+  // Streaming on evicts every other range
+  EXPECT_TRUE(Stream(cache, 10 * BLOCK_SIZE));
+  EXPECT_EQ(cache.GetRangeCount(), 1u);
+  EXPECT_FALSE(cache.IsCachedPosition(0));
+  EXPECT_TRUE(cache.IsCachedPosition(213 * BLOCK_SIZE));
+}
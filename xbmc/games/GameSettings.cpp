@@ -22,8 +22,12 @@ namespace
   const std::string SETTING_GAMES_ENABLE = "gamesgeneral.enable";
   const std::string SETTING_GAMES_SHOW_OSD_HELP = "gamesgeneral.showosdhelp";
   const std::string SETTING_GAMES_ENABLEAUTOSAVE = "gamesgeneral.enableautosave";
+  const std::string SETTING_GAMES_COMPRESSSAVESTATES = "gamesgeneral.compresssavestates";
+  const std::string SETTING_GAMES_SYNCTODISPLAY = "gamesgeneral.synctodisplay";
   const std::string SETTING_GAMES_ENABLEREWIND = "gamesgeneral.enablerewind";
   const std::string SETTING_GAMES_REWINDTIME = "gamesgeneral.rewindtime";
+  const std::string SETTING_GAMES_REWINDMEMORY = "gamesgeneral.rewindmemory";
+  const std::string SETTING_GAMES_RUNAHEADFRAMES = "gamesgeneral.runaheadframes";
 }
 
 CGameSettings::CGameSettings()
@@ -33,6 +37,8 @@ CGameSettings::CGameSettings()
   m_settings->RegisterCallback(this, {
     SETTING_GAMES_ENABLEREWIND,
     SETTING_GAMES_REWINDTIME,
+    SETTING_GAMES_REWINDMEMORY,
+    SETTING_GAMES_RUNAHEADFRAMES,
   });
 }
 
@@ -72,6 +78,16 @@ bool CGameSettings::AutosaveEnabled()
   return m_settings->GetBool(SETTING_GAMES_ENABLEAUTOSAVE);
 }
 
+bool CGameSettings::CompressSavestates()
+{
+  return m_settings->GetBool(SETTING_GAMES_COMPRESSSAVESTATES);
+}
+
+bool CGameSettings::SyncToDisplay()
+{
+  return m_settings->GetBool(SETTING_GAMES_SYNCTODISPLAY);
+}
+
 bool CGameSettings::RewindEnabled()
 {
   return m_settings->GetBool(SETTING_GAMES_ENABLEREWIND);
@@ -84,6 +100,20 @@ unsigned int CGameSettings::MaxRewindTimeSec()
   return static_cast<unsigned int>(std::max(rewindTimeSec, 0));
 }
 
+unsigned int CGameSettings::MaxRewindMemoryMB()
+{
+  int rewindMemoryMB = m_settings->GetInt(SETTING_GAMES_REWINDMEMORY);
+
+  return static_cast<unsigned int>(std::max(rewindMemoryMB, 0));
+}
+
+unsigned int CGameSettings::RunaheadFrames()
+{
+  int runaheadFrames = m_settings->GetInt(SETTING_GAMES_RUNAHEADFRAMES);
+
+  return static_cast<unsigned int>(std::max(runaheadFrames, 0));
+}
+
 void CGameSettings::OnSettingChanged(std::shared_ptr<const CSetting> setting)
 {
   if (setting == nullptr)
@@ -92,7 +122,9 @@ void CGameSettings::OnSettingChanged(std::shared_ptr<const CSetting> setting)
   const std::string& settingId = setting->GetId();
 
   if (settingId == SETTING_GAMES_ENABLEREWIND ||
-      settingId == SETTING_GAMES_REWINDTIME)
+      settingId == SETTING_GAMES_REWINDTIME ||
+      settingId == SETTING_GAMES_REWINDMEMORY ||
+      settingId == SETTING_GAMES_RUNAHEADFRAMES)
   {
     SetChanged();
     NotifyObservers(ObservableMessageSettingsChanged);
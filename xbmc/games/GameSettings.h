@@ -32,8 +32,12 @@ public:
   void SetShowOSDHelp(bool bShow);
   void ToggleGames();
   bool AutosaveEnabled();
+  bool CompressSavestates();
+  bool SyncToDisplay();
   bool RewindEnabled();
   unsigned int MaxRewindTimeSec();
+  unsigned int MaxRewindMemoryMB();
+  unsigned int RunaheadFrames();
 
   // Inherited from ISettingCallback
   virtual void OnSettingChanged(std::shared_ptr<const CSetting> setting) override;
@@ -138,6 +138,17 @@ CFFmpegImage::~CFFmpegImage()
 bool CFFmpegImage::LoadImageFromMemory(unsigned char* buffer, unsigned int bufSize,
                                       unsigned int width, unsigned int height)
 {
+  // Large JPEGs are decoded at a reduced size in the DCT domain, when the
+  // caller scales them down anyway
+  unsigned int jpegWidth = 0;
+  unsigned int jpegHeight = 0;
+  m_lowres = 0;
+  if (GetJpegSize(buffer, bufSize, jpegWidth, jpegHeight))
+  {
+    const unsigned int scaleWidth = m_scaleWidth ? std::min(m_scaleWidth, width) : width;
+    const unsigned int scaleHeight = m_scaleHeight ? std::min(m_scaleHeight, height) : height;
+    m_lowres = GetJpegLowres(jpegWidth, jpegHeight, scaleWidth, scaleHeight);
+  }
 
   if (!Initialize(buffer, bufSize))
   {
@@ -148,9 +159,98 @@ bool CFFmpegImage::LoadImageFromMemory(unsigned char* buffer, unsigned int bufSi
   av_frame_free(&m_pFrame);
   m_pFrame = ExtractFrame();
 
+  if (m_pFrame && m_codec_ctx->lowres > 0)
+  {
+    // the original size is that of the image, not what was decoded
+    m_originalWidth = jpegWidth;
+    m_originalHeight = jpegHeight;
+  }
+
   return !(m_pFrame == nullptr);
 }
 
+void CFFmpegImage::SetScaleHint(unsigned int width, unsigned int height)
+{
+  m_scaleWidth = width;
+  m_scaleHeight = height;
+}
+
+bool CFFmpegImage::GetJpegSize(const unsigned char* buffer, size_t bufSize, unsigned int &width, unsigned int &height)
+{
+  if (bufSize < 4 || buffer[0] != 0xFF || buffer[1] != 0xD8)
+    return false;
+
+  size_t pos = 2;
+  while (pos + 4 <= bufSize)
+  {
+    if (buffer[pos] != 0xFF)
+      return false;
+
+    const unsigned char marker = buffer[pos + 1];
+    if (marker == 0xFF)
+    { // fill byte
+      pos++;
+      continue;
+    }
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+    { // markers without a segment
+      pos += 2;
+      continue;
+    }
+
+    // SOF0 - SOF2: baseline, extended and progressive Huffman coding
+    if (marker >= 0xC0 && marker <= 0xC2)
+    {
+      if (pos + 9 > bufSize)
+        return false;
+      height = (buffer[pos + 5] << 8) | buffer[pos + 6];
+      width = (buffer[pos + 7] << 8) | buffer[pos + 8];
+      return width > 0 && height > 0;
+    }
+
+    // any other frame type, or image data before a frame header
+    if ((marker >= 0xC3 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) ||
+        marker == 0xD9 || marker == 0xDA)
+      return false;
+
+    pos += 2 + ((buffer[pos + 2] << 8) | buffer[pos + 3]);
+  }
+  return false;
+}
+
+int CFFmpegImage::GetJpegLowres(unsigned int jpegWidth, unsigned int jpegHeight, unsigned int width, unsigned int height)
+{
+  if (jpegWidth == 0 || jpegHeight == 0 || width == 0 || height == 0)
+    return 0;
+
+  // the size the image is scaled to, keeping the aspect ratio
+  uint64_t fitWidth = jpegWidth;
+  uint64_t fitHeight = jpegHeight;
+  if (fitWidth > width)
+  {
+    fitWidth = width;
+    fitHeight = (static_cast<uint64_t>(jpegHeight) * width + jpegWidth - 1) / jpegWidth;
+  }
+  if (fitHeight > height)
+  {
+    fitHeight = height;
+    fitWidth = (static_cast<uint64_t>(jpegWidth) * height + jpegHeight - 1) / jpegHeight;
+  }
+
+  // the decoder rounds the scaled size up
+  int lowres = 0;
+  while (lowres < 3)
+  {
+    const int next = lowres + 1;
+    const uint64_t scaledWidth = (static_cast<uint64_t>(jpegWidth) + (1 << next) - 1) >> next;
+    const uint64_t scaledHeight = (static_cast<uint64_t>(jpegHeight) + (1 << next) - 1) >> next;
+    if (scaledWidth < fitWidth || scaledHeight < fitHeight)
+      break;
+    lowres = next;
+  }
+  return lowres;
+}
+
 bool CFFmpegImage::Initialize(unsigned char* buffer, size_t bufSize)
 {
   int bufferSize = 4096;
@@ -249,6 +349,9 @@ bool CFFmpegImage::Initialize(unsigned char* buffer, size_t bufSize)
     return false;
   }
 
+  if (m_lowres > 0 && codec_params->codec_id == AV_CODEC_ID_MJPEG)
+    m_codec_ctx->lowres = std::min(m_lowres, static_cast<int>(codec->max_lowres));
+
   if (avcodec_open2(m_codec_ctx, codec, NULL) < 0)
   {
     avformat_close_input(&m_fctx);
@@ -468,8 +571,8 @@ bool CFFmpegImage::DecodeFrame(AVFrame* frame, unsigned int width, unsigned int
 
   // assumption quadratic maximums e.g. 2048x2048
   float ratio = m_width / (float)m_height;
-  unsigned int nHeight = m_originalHeight;
-  unsigned int nWidth = m_originalWidth;
+  unsigned int nHeight = frame->height;
+  unsigned int nWidth = frame->width;
   if (nHeight > height)
   {
     nHeight = height;
@@ -481,7 +584,7 @@ bool CFFmpegImage::DecodeFrame(AVFrame* frame, unsigned int width, unsigned int
     nHeight = (unsigned int)(nWidth / ratio + 0.5f);
   }
 
-  struct SwsContext* context = sws_getContext(m_originalWidth, m_originalHeight, pixFormat,
+  struct SwsContext* context = sws_getContext(frame->width, frame->height, pixFormat,
     nWidth, nHeight, AV_PIX_FMT_RGB32, SWS_BICUBIC, NULL, NULL, NULL);
 
   if (range == AVCOL_RANGE_JPEG)
@@ -494,7 +597,7 @@ bool CFFmpegImage::DecodeFrame(AVFrame* frame, unsigned int width, unsigned int
     sws_setColorspaceDetails(context, inv_table, srcRange, table, dstRange, brightness, contrast, saturation);
   }
 
-  sws_scale(context, frame->data, frame->linesize, 0, m_originalHeight,
+  sws_scale(context, frame->data, frame->linesize, 0, frame->height,
     pictureRGB->data, pictureRGB->linesize);
   sws_freeContext(context);
 
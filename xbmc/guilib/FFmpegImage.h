@@ -60,6 +60,7 @@ public:
 
   bool LoadImageFromMemory(unsigned char* buffer, unsigned int bufSize,
                            unsigned int width, unsigned int height) override;
+  void SetScaleHint(unsigned int width, unsigned int height) override;
   bool Decode(unsigned char * const pixels, unsigned int width, unsigned int height,
               unsigned int pitch, unsigned int format) override;
   bool CreateThumbnailFromSurface(unsigned char* bufferin, unsigned int width,
@@ -73,6 +74,19 @@ public:
 
   std::shared_ptr<Frame> ReadFrame();
 
+  /*! \brief Read the size of a JPEG image from its frame header
+   Only Huffman coded images are handled, as only those can be decoded at a reduced size.
+   \return true if a frame header was found
+   */
+  static bool GetJpegSize(const unsigned char* buffer, size_t bufSize, unsigned int &width, unsigned int &height);
+
+  /*! \brief Get the DCT scaling for a JPEG image to be decoded with
+   \param width, height the maximum size the image will be scaled to fit in
+   \return the largest scaling (1/2^n, up to 1/8) that keeps the image at least as large
+           as the size it is scaled to
+   */
+  static int GetJpegLowres(unsigned int jpegWidth, unsigned int jpegHeight, unsigned int width, unsigned int height);
+
 private:
   static void FreeIOCtx(AVIOContext** ioctx);
   AVFrame* ExtractFrame();
@@ -80,6 +94,7 @@ private:
   static int EncodeFFmpegFrame(AVCodecContext *avctx, AVPacket *pkt, int *got_packet, AVFrame *frame);
   static int DecodeFFmpegFrame(AVCodecContext *avctx, AVFrame *frame, int *got_frame, AVPacket *pkt);
   static AVPixelFormat ConvertFormats(AVFrame* frame);
+
   std::string m_strMimeType;
   void CleanupLocalOutputBuffer();
 
@@ -92,4 +107,7 @@ private:
 
   AVFrame* m_pFrame;
   uint8_t* m_outputBuffer;
+  int m_lowres = 0; ///< JPEG images are decoded at 1/2^m_lowres of their size
+  unsigned int m_scaleWidth = 0; ///< width the caller scales the image to, 0 if not scaled
+  unsigned int m_scaleHeight = 0; ///< height the caller scales the image to, 0 if not scaled
 };
@@ -25,6 +25,14 @@ public:
    \return true if the image could be loaded
    */
   virtual bool LoadImageFromMemory(unsigned char* buffer, unsigned int bufSize, unsigned int width, unsigned int height)=0;
+  /*!
+   \brief Set the size the caller scales the image to after loading it
+   Loaders may decode at a reduced size that is still at least this large. Unlike the size
+   passed to LoadImageFromMemory, the hint doesn't limit the size of the loaded image.
+   \param width The width the image is scaled to fit in, 0 if not scaled
+   \param height The height the image is scaled to fit in, 0 if not scaled
+   */
+  virtual void SetScaleHint(unsigned int width, unsigned int height) {}
   /*!
    \brief Decodes the previously loaded image data to the output buffer in 32 bit raw bits
    \param pixels The output buffer
@@ -0,0 +1,193 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "guilib/FFmpegImage.h"
+#include "guilib/XBTF.h"
+#include "test/BenchmarkUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+  // SOI, an APP0 segment and a frame header with the given marker
+  std::vector<unsigned char> MakeJpeg(unsigned char sofMarker, unsigned int width, unsigned int height)
+  {
+    std::vector<unsigned char> jpeg = { 0xFF, 0xD8 };
+
+    const unsigned char app0[] = { 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00,
+                                   0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00 };
+    jpeg.insert(jpeg.end(), app0, app0 + sizeof(app0));
+
+    const unsigned char sof[] = { 0xFF, sofMarker, 0x00, 0x11, 0x08,
+                                  static_cast<unsigned char>(height >> 8), static_cast<unsigned char>(height),
+                                  static_cast<unsigned char>(width >> 8), static_cast<unsigned char>(width),
+                                  0x03, 0x01, 0x22, 0x00, 0x02, 0x11, 0x01, 0x03, 0x11, 0x01 };
+    jpeg.insert(jpeg.end(), sof, sof + sizeof(sof));
+
+    return jpeg;
+  }
+
+  bool GetJpegSize(const std::vector<unsigned char> &jpeg, unsigned int &width, unsigned int &height)
+  {
+    return CFFmpegImage::GetJpegSize(jpeg.data(), jpeg.size(), width, height);
+  }
+}
+
+TEST(TestFFmpegImage, GetJpegSize)
+{
+  unsigned int width = 0;
+  unsigned int height = 0;
+
+  // Baseline and progressive
+  EXPECT_TRUE(GetJpegSize(MakeJpeg(0xC0, 1920, 1080), width, height));
+  EXPECT_EQ(1920u, width);
+  EXPECT_EQ(1080u, height);
+
+  EXPECT_TRUE(GetJpegSize(MakeJpeg(0xC2, 65535, 1), width, height));
+  EXPECT_EQ(65535u, width);
+  EXPECT_EQ(1u, height);
+
+  // Fill bytes and tables before the frame header
+  std::vector<unsigned char> jpeg = MakeJpeg(0xC0, 640, 480);
+  const unsigned char dht[] = { 0xFF, 0xFF, 0xFF, 0xC4, 0x00, 0x04, 0x00, 0x00 };
+  jpeg.insert(jpeg.begin() + 2, dht, dht + sizeof(dht));
+  EXPECT_TRUE(GetJpegSize(jpeg, width, height));
+  EXPECT_EQ(640u, width);
+  EXPECT_EQ(480u, height);
+}
+
+TEST(TestFFmpegImage, GetJpegSizeInvalid)
+{
+  unsigned int width = 0;
+  unsigned int height = 0;
+
+  // Lossless and arithmetic coded frames can't be decoded at a reduced size
+  EXPECT_FALSE(GetJpegSize(MakeJpeg(0xC3, 1920, 1080), width, height));
+  EXPECT_FALSE(GetJpegSize(MakeJpeg(0xC9, 1920, 1080), width, height));
+
+  // No image
+  EXPECT_FALSE(GetJpegSize(MakeJpeg(0xC0, 0, 1080), width, height));
+  EXPECT_FALSE(GetJpegSize(MakeJpeg(0xC0, 1920, 0), width, height));
+  EXPECT_FALSE(CFFmpegImage::GetJpegSize(nullptr, 0, width, height));
+
+  // Not a JPEG
+  std::vector<unsigned char> jpeg = MakeJpeg(0xC0, 1920, 1080);
+  jpeg[1] = 0xD9;
+  EXPECT_FALSE(GetJpegSize(jpeg, width, height));
+
+  // Scan data or a segment without a marker before the frame header
+  jpeg = MakeJpeg(0xC0, 1920, 1080);
+  jpeg[3] = 0xDA;
+  EXPECT_FALSE(GetJpegSize(jpeg, width, height));
+  jpeg[2] = 0x00;
+  EXPECT_FALSE(GetJpegSize(jpeg, width, height));
+
+  // Truncated anywhere before the dimensions
+  const std::vector<unsigned char> full = MakeJpeg(0xC0, 1920, 1080);
+  const size_t sofEnd = full.size() - 10;
+  for (size_t size = 0; size < sofEnd; size++)
+  {
+    const std::vector<unsigned char> truncated(full.begin(), full.begin() + size);
+    EXPECT_FALSE(GetJpegSize(truncated, width, height)) << "truncated to " << size;
+  }
+  const std::vector<unsigned char> truncated(full.begin(), full.begin() + sofEnd);
+  EXPECT_TRUE(GetJpegSize(truncated, width, height));
+
+  // A segment length past the end of the buffer
+  jpeg = MakeJpeg(0xC0, 1920, 1080);
+  jpeg[4] = 0xFF;
+  EXPECT_FALSE(GetJpegSize(jpeg, width, height));
+}
+
+TEST(TestFFmpegImage, GetJpegLowres)
+{
+  // Not scaled down
+  EXPECT_EQ(0, CFFmpegImage::GetJpegLowres(800, 600, 1920, 1080));
+  EXPECT_EQ(0, CFFmpegImage::GetJpegLowres(1920, 1080, 1920, 1080));
+  EXPECT_EQ(0, CFFmpegImage::GetJpegLowres(1920, 1080, 1919, 1080));
+
+  // Unknown sizes
+  EXPECT_EQ(0, CFFmpegImage::GetJpegLowres(0, 1080, 1920, 1080));
+  EXPECT_EQ(0, CFFmpegImage::GetJpegLowres(1920, 1080, 0, 0));
+
+  // Exact multiples of the target
+  EXPECT_EQ(1, CFFmpegImage::GetJpegLowres(3840, 2160, 1920, 1080));
+  EXPECT_EQ(2, CFFmpegImage::GetJpegLowres(4000, 3000, 1000, 750));
+  EXPECT_EQ(3, CFFmpegImage::GetJpegLowres(4000, 3000, 500, 375));
+
+  // Scaling is limited to 1/8
+  EXPECT_EQ(3, CFFmpegImage::GetJpegLowres(65535, 65535, 1, 1));
+
+  // The decoder rounds the scaled size up, so 3999 / 8 is still 500 wide
+  EXPECT_EQ(3, CFFmpegImage::GetJpegLowres(3999, 2999, 500, 375));
+  EXPECT_EQ(2, CFFmpegImage::GetJpegLowres(3992, 2992, 500, 375));
+
+  // The fitted size is rounded up too: 2992 rows fit in 2992 * 500 / 3999 =
+  // 374.1, which 2992 / 8 = 374 rows don't cover
+  EXPECT_EQ(2, CFFmpegImage::GetJpegLowres(3999, 2992, 500, 1000));
+  EXPECT_EQ(3, CFFmpegImage::GetJpegLowres(4000, 2992, 500, 1000));
+
+  // A wide image is scaled by its width
+  EXPECT_EQ(1, CFFmpegImage::GetJpegLowres(4000, 1000, 2000, 2000));
+  EXPECT_EQ(3, CFFmpegImage::GetJpegLowres(4000, 1000, 500, 500));
+}
+
+TEST(TestFFmpegImage, DISABLED_LowresDecodeCost)
+{
+  constexpr unsigned int WIDTH = 4000;
+  constexpr unsigned int HEIGHT = 3000;
+  constexpr unsigned int RUNS = 5;
+
+  // A photo sized gradient, encoded by the thumbnail encoder
+  std::vector<unsigned char> surface(WIDTH * HEIGHT * 4);
+  for (unsigned int y = 0; y < HEIGHT; y++)
+  {
+    for (unsigned int x = 0; x < WIDTH; x++)
+    {
+      unsigned char *pixel = &surface[(y * WIDTH + x) * 4];
+      pixel[0] = static_cast<unsigned char>(x);
+      pixel[1] = static_cast<unsigned char>(y);
+      pixel[2] = static_cast<unsigned char>(x + y);
+      pixel[3] = 0xFF;
+    }
+  }
+
+  CFFmpegImage encoder("image/jpeg");
+  unsigned char *thumbnail = nullptr;
+  unsigned int thumbnailSize = 0;
+  ASSERT_TRUE(encoder.CreateThumbnailFromSurface(surface.data(), WIDTH, HEIGHT, XB_FMT_A8R8G8B8, WIDTH * 4,
+                                                 "benchmark.jpg", thumbnail, thumbnailSize));
+  std::vector<unsigned char> jpeg(thumbnail, thumbnail + thumbnailSize);
+  encoder.ReleaseThumbnailBuffer();
+
+  // Decoded as CBaseTexture does, at full size and for a 512 pixel thumbnail
+  for (unsigned int scale : { 0u, 512u })
+  {
+    std::vector<unsigned char> pixels;
+    unsigned int decodedWidth = 0;
+
+    const double decodeUs = CBenchmarkUtils::MeanUs(RUNS, [&jpeg, &pixels, &decodedWidth, scale]()
+    {
+      CFFmpegImage image("image/jpeg");
+      image.SetScaleHint(scale, scale);
+      if (image.LoadImageFromMemory(jpeg.data(), jpeg.size(), WIDTH, HEIGHT))
+      {
+        decodedWidth = image.Width();
+        pixels.resize(image.Width() * image.Height() * 4);
+        image.Decode(pixels.data(), image.Width(), image.Height(), image.Width() * 4, XB_FMT_A8R8G8B8);
+      }
+    });
+
+    EXPECT_GT(decodedWidth, 0u);
+    CBenchmarkUtils::Report("scale hint " + std::to_string(scale) + ", decoded " + std::to_string(decodedWidth) +
+                            " wide", decodeUs / 1000.0, "ms/image");
+  }
+}
@@ -270,6 +270,33 @@ JSONRPC_STATUS CPlayerOperations::GetItem(const std::string &method, ITransportL
   return OK;
 }
 
+JSONRPC_STATUS CPlayerOperations::GetVideoLatency(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  switch (GetPlayer(parameterObject["playerid"]))
+  {
+    case Video:
+    {
+      // Only filled in by decoders that measure their latency
+      const VideoLatencyInfo latency = CServiceBroker::GetDataCacheCore().GetVideoLatency();
+
+      result["samples"] = latency.sampleCount;
+      result["demuxtodecoder"] = SerializeLatency(latency.demuxToDecoder);
+      result["decoderwrite"] = SerializeLatency(latency.decoderWrite);
+      result["decoderqueue"] = SerializeLatency(latency.decoderQueue);
+      result["starvedbuffers"] = latency.starvedBuffers;
+      result["decoderdelay"] = latency.decoderDelayMs;
+      break;
+    }
+
+    case Audio:
+    case Picture:
+    default:
+      return FailedToExecute;
+  }
+
+  return OK;
+}
+
 JSONRPC_STATUS CPlayerOperations::PlayPause(const std::string &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
 {
   CGUIWindowSlideShow *slideshow = NULL;
@@ -1789,3 +1816,15 @@ CPVREpgInfoTagPtr CPlayerOperations::GetCurrentEpg()
 
   return currentChannel->GetEPGNow();
 }
+
+CVariant CPlayerOperations::SerializeLatency(const LatencyPercentiles &percentiles)
+{
+  CVariant result(CVariant::VariantTypeObject);
+
+  result["p50"] = percentiles.p50Ms;
+  result["p95"] = percentiles.p95Ms;
+  result["p99"] = percentiles.p99Ms;
+  result["max"] = percentiles.maxMs;
+
+  return result;
+}
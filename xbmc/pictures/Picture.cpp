@@ -259,6 +259,18 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
   return false;
 }
 
+void CPicture::GetMaxCacheSize(uint32_t &max_width, uint32_t &max_height)
+{
+  const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+
+  // 16x9 images may be cached at the fanart res
+  uint32_t cache_height = std::max(advancedSettings->m_imageRes, advancedSettings->m_fanartRes);
+  uint32_t cache_width = cache_height * 16/9;
+
+  max_width = max_width ? std::min(max_width, cache_width) : cache_width;
+  max_height = max_height ? std::min(max_height, cache_height) : cache_height;
+}
+
 bool CPicture::CreateTiledThumb(const std::vector<std::string> &files, const std::string &thumb)
 {
   if (!files.size())
@@ -48,6 +48,14 @@ public:
     uint32_t &dest_width, uint32_t &dest_height, const std::string &dest,
     CPictureScalingAlgorithm::Algorithm scalingAlgorithm = CPictureScalingAlgorithm::NoAlgorithm);
 
+  /*! \brief Get the largest size CacheTexture may cache an image at
+   Images can be decoded at a reduced size, as long as they are no smaller than this.
+   \param max_width [in/out] maximum width in pixels requested, 0 if none - replaced with the limit
+   \param max_height [in/out] maximum height in pixels requested, 0 if none - replaced with the limit
+   \sa CacheTexture
+   */
+  static void GetMaxCacheSize(uint32_t &max_width, uint32_t &max_height);
+
 private:
   static void GetScale(unsigned int width, unsigned int height, unsigned int &out_width, unsigned int &out_height);
   static bool ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
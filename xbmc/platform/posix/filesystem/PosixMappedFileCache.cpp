@@ -0,0 +1,110 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "PosixMappedFileCache.h"
+#include "filesystem/SpecialProtocol.h"
+#include "Util.h"
+#include "utils/log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace XFILE;
+
+#define HUGE_PAGE_SIZE (2*1024*1024)
+
+CPosixMappedFileCache::CPosixMappedFileCache(size_t front, size_t back)
+ : CCircularCache(front, back)
+{
+}
+
+CPosixMappedFileCache::~CPosixMappedFileCache()
+{
+  Close();
+}
+
+int CPosixMappedFileCache::Open()
+{
+  Close();
+
+  m_filename = CSpecialProtocol::TranslatePath(CUtil::GetNextFilename("special://temp/filecache%03d.cache", 999));
+  if (m_filename.empty())
+  {
+    CLog::Log(LOGERROR, "%s - Unable to generate a new filename", __FUNCTION__);
+    return CACHE_RC_ERROR;
+  }
+
+  int fd = open(m_filename.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  if (fd < 0)
+  {
+    CLog::LogF(LOGERROR, "failed to create file \"%s\" (%s)", m_filename.c_str(), strerror(errno));
+    return CACHE_RC_ERROR;
+  }
+
+  // The mapping keeps the file alive, and nothing is left behind on a crash
+  unlink(m_filename.c_str());
+
+  // Allocate the disk budget, writing to a hole of a full disk would raise SIGBUS
+  int err = posix_fallocate(fd, 0, m_size);
+  if (err == EINVAL || err == EOPNOTSUPP)
+    err = (ftruncate(fd, m_size) == 0) ? 0 : errno; // Not supported by the filesystem
+
+  if (err != 0)
+  {
+    CLog::LogF(LOGERROR, "failed to allocate %zu bytes for \"%s\" (%s)", m_size, m_filename.c_str(), strerror(err));
+    close(fd);
+    return CACHE_RC_ERROR;
+  }
+
+  void *buf = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (buf == MAP_FAILED)
+  {
+    CLog::LogF(LOGERROR, "failed to map \"%s\" (%s)", m_filename.c_str(), strerror(errno));
+    return CACHE_RC_ERROR;
+  }
+
+  m_buf = static_cast<uint8_t*>(buf);
+
+  // Data is written and read in order, read-ahead and early reclaim help
+  madvise(m_buf, m_size, MADV_SEQUENTIAL);
+
+#ifdef MADV_HUGEPAGE
+  // Only honored where the temp filesystem supports huge pages (e.g. tmpfs)
+  if (m_size >= HUGE_PAGE_SIZE)
+    madvise(m_buf, m_size, MADV_HUGEPAGE);
+#endif
+
+  m_beg = 0;
+  m_end = 0;
+  m_cur = 0;
+
+  CLog::Log(LOGDEBUG, "CPosixMappedFileCache::Open - mapped %zu bytes of \"%s\"", m_size, m_filename.c_str());
+
+  return CACHE_RC_OK;
+}
+
+void CPosixMappedFileCache::Close()
+{
+  if (m_buf != NULL)
+  {
+    munmap(m_buf, m_size);
+    m_buf = NULL;
+  }
+
+  m_filename.clear();
+}
+
+CCacheStrategy *CPosixMappedFileCache::CreateNew()
+{
+  return new CPosixMappedFileCache(m_size - m_size_back, m_size_back);
+}
@@ -0,0 +1,47 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "filesystem/CircularCache.h"
+
+#include <string>
+
+namespace XFILE {
+
+/*!
+ * \brief Circular cache stored in a memory-mapped temp file
+ *
+ * Replaces the read/write calls of CSimpleFileCache with plain memory
+ * copies into and out of the mapping. The kernel writes pages back to disk
+ * and drops them under memory pressure, so a large cache doesn't need
+ * to fit in RAM.
+ *
+ * The size of the file is a fixed disk budget, allocated up front so that
+ * running out of disk space fails Open() instead of a later write.
+ */
+class CPosixMappedFileCache : public CCircularCache
+{
+public:
+  /*!
+   * \param front Max bytes cached ahead of the read position
+   * \param back Min bytes kept behind the read position
+   */
+  CPosixMappedFileCache(size_t front, size_t back);
+  ~CPosixMappedFileCache() override;
+
+  int Open() override;
+  void Close() override;
+
+  CCacheStrategy *CreateNew() override;
+
+private:
+  std::string m_filename;
+};
+
+} // namespace XFILE
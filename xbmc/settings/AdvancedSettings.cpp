@@ -177,6 +177,7 @@ void CAdvancedSettings::Initialize()
   m_videoFpsDetect = 1;
   m_maxTempo = 1.55f;
   m_videoPreferStereoStream = false;
+  m_videoFastOpen = false;
 
   m_mediacodecForceSoftwareRendering = false;
 
@@ -389,10 +390,16 @@ void CAdvancedSettings::Initialize()
   m_bPVRTimeshiftSimpleOSD = true;
 
   m_cacheMemSize = 1024 * 1024 * 20;
+  // disk budget of the cache when memorysize is 0, 0 (default) uses an
+  // unbounded temp file
+  m_cacheDiskSize = 0;
   m_cacheBufferMode = CACHE_BUFFER_MODE_INTERNET; // Default (buffer all internet streams/filesystems)
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_cacheReadFactor = 4.0f;
+  // number of concurrent range requests for high-latency network sources,
+  // 0 or 1 reads sequentially
+  m_cacheParallelReads = 0;
 
   m_addonPackageFolderSize = 200;
 
@@ -725,6 +732,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "fpsdetect", m_videoFpsDetect, 0, 2);
     XMLUtils::GetFloat(pElement, "maxtempo", m_maxTempo, 1.5, 2.1);
     XMLUtils::GetBoolean(pElement, "preferstereostream", m_videoPreferStereoStream);
+    XMLUtils::GetBoolean(pElement, "fastopen", m_videoFastOpen);
 
     // Store global display latency settings
     TiXmlElement* pVideoLatency = pElement->FirstChildElement("latency");
@@ -847,8 +855,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
   if (pElement)
   {
     XMLUtils::GetUInt(pElement, "memorysize", m_cacheMemSize);
+    XMLUtils::GetUInt(pElement, "disksize", m_cacheDiskSize);
     XMLUtils::GetUInt(pElement, "buffermode", m_cacheBufferMode, 0, 4);
     XMLUtils::GetFloat(pElement, "readfactor", m_cacheReadFactor);
+    XMLUtils::GetUInt(pElement, "parallelreads", m_cacheParallelReads, 0, 16);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -392,6 +392,12 @@ void CSettingsComponent::CreateUserDirs() const
   XFILE::CDirectory::Create("special://temp/");
   XFILE::CDirectory::Create("special://logpath");
   XFILE::CDirectory::Create("special://temp/temp"); // temp directory for python and dllGetTempPathA
+  XFILE::CDirectory::Create("special://temp/directory_cache"); // directory listings kept across sessions
+  XFILE::CDirectory::Create("special://temp/seekindex"); // keyframe indexes kept across sessions
+
+  // the caches kept across sessions only grow, drop the least recently written entries
+  CUtil::PruneCacheFolder("special://temp/directory_cache/", 1000, 30);
+  CUtil::PruneCacheFolder("special://temp/seekindex/", 500, 90);
 
   //Let's clear our archive cache before starting up anything more
   auto archiveCachePath = CSpecialProtocol::TranslatePath("special://temp/archive_cache/");
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/*!
+ * \brief Helpers for micro-benchmarks
+ *
+ * Benchmarks are gtest cases named DISABLED_<name>Cost, so they are skipped
+ * by the normal test run. Run them with:
+ *
+ *   kodi-test --gtest_also_run_disabled_tests --gtest_filter=*Cost
+ *
+ * Results are printed, not checked, as they depend on the machine.
+ */
+class CBenchmarkUtils
+{
+public:
+  /*!
+   * \brief Call a function repeatedly
+   *
+   * \param runs The number of calls
+   * \param func The function to time
+   *
+   * \return The mean time of a call, in microseconds
+   */
+  template<typename F>
+  static double MeanUs(unsigned int runs, F&& func)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < runs; i++)
+      func();
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / runs;
+  }
+
+  /*!
+   * \brief Print a result in line with the gtest output
+   */
+  static void Report(const std::string& name, double value, const std::string& unit)
+  {
+    std::cout << "[          ] " << name << ": " << value << " " << unit << std::endl;
+  }
+};
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "TextureCache.h"
+#include "TextureDatabase.h"
+#include "test/TestUtils.h"
+#include "threads/SingleLock.h"
+#include "utils/JobManager.h"
+
+#include "gtest/gtest.h"
+
+class TestTextureCache : public testing::Test
+{
+protected:
+  TestTextureCache()
+  {
+    CTextureCache::GetInstance().Initialize();
+  }
+
+  ~TestTextureCache() override
+  {
+    CJobManager::GetInstance().UnPauseJobs();
+    CTextureCache::GetInstance().Deinitialize();
+  }
+
+  unsigned int GetLookups()
+  {
+    CTextureCache &cache = CTextureCache::GetInstance();
+    CSingleLock lock(cache.m_databaseSection);
+    return cache.m_lookups;
+  }
+};
+
+TEST_F(TestTextureCache, PendingTextureHasId)
+{
+  CTextureCache &cache = CTextureCache::GetInstance();
+  const std::string image = XBMC_REF_FILE_PATH("xbmc/network/test/data/webserver/test.png");
+
+  // keep background jobs waiting, so textures cached meanwhile stay in the
+  // pending batch
+  CJobManager::GetInstance().PauseJobs();
+  const char *sizes[] = { "width=16", "width=32", "width=64" };
+  for (const char *size : sizes)
+    cache.BackgroundCacheImage(CTextureUtils::GetWrappedImageURL(image, "", size));
+
+  EXPECT_EQ(3u, cache.GetJobCount());
+
+  // requests for queued images are coalesced without a database lookup
+  const unsigned int lookups = GetLookups();
+  cache.BackgroundCacheImage(CTextureUtils::GetWrappedImageURL(image, "", sizes[0]));
+  cache.BackgroundCacheImage(CTextureUtils::GetWrappedImageURL(image, "", sizes[2]));
+  EXPECT_EQ(lookups, GetLookups());
+  EXPECT_EQ(3u, cache.GetJobCount());
+
+  ASSERT_FALSE(cache.CacheImage(image).empty());
+
+  // the details of a pending texture must refer to its database row
+  CTextureDetails details;
+  ASSERT_TRUE(cache.CacheImage(image, details));
+  EXPECT_LT(0, details.id);
+  EXPECT_TRUE(details.hash.empty());
+}
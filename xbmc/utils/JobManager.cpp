@@ -23,9 +23,12 @@ bool CJob::ShouldCancel(unsigned int progress, unsigned int total) const
   return false;
 }
 
-CJobWorker::CJobWorker(CJobManager *manager) : CThread("JobWorker")
+CJobWorker::CJobWorker(CJobManager *manager, CJob::PRIORITY priority) : CThread("JobWorker"),
+  m_current(NULL, 0, priority, NULL)
 {
   m_jobManager = manager;
+  m_priority = priority;
+  m_processing = false;
   Create(true); // start work immediately, and kill ourselves when we're done
 }
 
@@ -58,7 +61,7 @@ void CJobWorker::Process()
     {
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
     }
-    m_jobManager->OnJobComplete(success, job);
+    m_jobManager->OnJobComplete(this, success, job);
   }
 }
 
@@ -153,6 +156,12 @@ bool CJobQueue::IsProcessing() const
   return CJobManager::GetInstance().m_running && (!m_processing.empty() || !m_jobQueue.empty());
 }
 
+size_t CJobQueue::GetJobCount() const
+{
+  CSingleLock lock(m_section);
+  return m_jobQueue.size() + m_processing.size();
+}
+
 bool CJobQueue::QueueEmpty() const
 {
   CSingleLock lock(m_section);
@@ -165,6 +174,7 @@ CJobManager &CJobManager::GetInstance()
   return sJobManager;
 }
 
+
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
@@ -183,241 +193,432 @@ void CJobManager::Restart()
 
 void CJobManager::CancelJobs()
 {
-  CSingleLock lock(m_section);
-  m_running = false;
-
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), [](CWorkItem& wi) { wi.FreeJob(); });
-    m_jobQueue[priority].clear();
+    CSingleLock lock(m_section);
+    m_running = false;
   }
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), [](CWorkItem& wi) { wi.Cancel(); });
+  for (CLane &lane : m_lanes)
+  {
+    CSingleLock lock(lane.section);
+
+    for (CJobWorker *worker : lane.workers)
+    {
+      CSingleLock workerLock(worker->m_section);
+
+      // clear any pending jobs
+      for_each(worker->m_jobQueue.begin(), worker->m_jobQueue.end(), [](CWorkItem& wi) { wi.FreeJob(); });
+      worker->m_jobQueue.clear();
+
+      // cancel any callbacks on jobs still processing
+      if (worker->m_processing)
+        worker->m_current.Cancel();
+    }
+    lane.queued = 0;
+
+    {
+      CSingleLock statsLock(lane.statsSection);
+      for (auto &it : lane.stats)
+      {
+        it.second.cancelled += it.second.queued;
+        it.second.queued = 0;
+      }
+    }
+  }
 
   // tell our workers to finish
-  while (m_workers.size())
+  for (CLane &lane : m_lanes)
   {
-    lock.Leave();
-    m_jobEvent.Set();
-    Sleep(0); // yield after setting the event to give the workers some time to die
-    lock.Enter();
+    CSingleLock lock(lane.section);
+    while (lane.workers.size())
+    {
+      lane.jobCondition.notifyAll();
+      lock.Leave();
+      Sleep(0); // yield after notifying to give the workers some time to die
+      lock.Enter();
+    }
   }
 }
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  CLane &lane = m_lanes[priority];
+  CSingleLock lock(lane.section);
 
   if (!m_running)
     return 0;
 
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = ++m_jobCounter;
+  if (id == 0)
+    id = ++m_jobCounter;
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem work(job, id, priority, callback);
+  work.m_queuedTime = XbmcThreads::SystemClockMillis();
+
+  lane.queued++;
+  {
+    CSingleLock statsLock(lane.statsSection);
+    lane.stats[job->GetType()].queued++;
+  }
 
   StartWorkers(priority);
+
+  // queue on the workers in turn, idle workers steal the jobs of busy ones
+  CJobWorker *worker = lane.workers[lane.nextWorker++ % lane.workers.size()];
+  {
+    CSingleLock workerLock(worker->m_section);
+    worker->m_jobQueue.push_back(work);
+  }
+
+  lane.jobCondition.notifyAll();
+
   return work.m_id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
-
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_DEDICATED; ++priority)
+  for (CLane &lane : m_lanes)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    CSingleLock lock(lane.section);
+
+    for (CJobWorker *worker : lane.workers)
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
-      return;
+      CSingleLock workerLock(worker->m_section);
+
+      // check whether we have this job in the queue
+      JobQueue::iterator i = find(worker->m_jobQueue.begin(), worker->m_jobQueue.end(), jobID);
+      if (i != worker->m_jobQueue.end())
+      {
+        {
+          CSingleLock statsLock(lane.statsSection);
+          JobTypeStats &stats = lane.stats[i->m_job->GetType()];
+          stats.queued--;
+          stats.cancelled++;
+        }
+        lane.queued--;
+
+        delete i->m_job;
+        worker->m_jobQueue.erase(i);
+        return;
+      }
+
+      // or if we're processing it
+      if (worker->m_processing && worker->m_current.m_id == jobID)
+      {
+        // job is in progress, so only thing to do is to remove callback.
+        // It's counted as cancelled once it completes
+        worker->m_current.Cancel();
+        return;
+      }
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
 }
 
 void CJobManager::StartWorkers(CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
+  CLane &lane = m_lanes[priority];
+  CSingleLock lock(lane.section);
+
+  // start a worker for each queued job that no free worker can take, up to
+  // the number of workers of the priority
+  while (lane.workers.size() < GetMaxWorkers(priority) &&
+         lane.workers.size() < lane.busy + lane.queued)
+    lane.workers.push_back(new CJobWorker(this, priority));
+}
 
-  // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
-    return;
+CJob *CJobManager::PopJob(CJobWorker *worker)
+{
+  // Check whether we're pausing pausable jobs
+  if (IsPaused(worker->m_priority))
+    return NULL;
 
-  // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  // our own queue first, without contending with the rest of the lane
   {
-    m_jobEvent.Set();
-    return;
+    CSingleLock lock(worker->m_section);
+    if (!worker->m_jobQueue.empty())
+    {
+      CWorkItem work = worker->m_jobQueue.front();
+      worker->m_jobQueue.pop_front();
+
+      StartProcessing(worker, work, false);
+      return work.m_job;
+    }
   }
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
-}
+  // steal the newest job of another worker. Holding the lane keeps the job
+  // visible to CancelJob() while it moves between workers
+  CLane &lane = m_lanes[worker->m_priority];
+  CSingleLock lock(lane.section);
 
-CJob *CJobManager::PopJob()
-{
-  CSingleLock lock(m_section);
-  for (int priority = CJob::PRIORITY_DEDICATED; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
+  for (size_t i = 0; i < lane.workers.size(); i++)
   {
-    // Check whether we're pausing pausable jobs
-    if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
+    CJobWorker *victim = lane.workers[(lane.nextWorker + i) % lane.workers.size()];
+    if (victim == worker)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    CSingleLock victimLock(victim->m_section);
+    if (!victim->m_jobQueue.empty())
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      CWorkItem work = victim->m_jobQueue.back();
+      victim->m_jobQueue.pop_back();
+      victimLock.Leave();
+
+      CSingleLock workerLock(worker->m_section);
+      StartProcessing(worker, work, true);
+      return work.m_job;
     }
   }
+
   return NULL;
 }
 
+void CJobManager::StartProcessing(CJobWorker *worker, const CWorkItem &work, bool stolen)
+{
+  CLane &lane = m_lanes[worker->m_priority];
+
+  // add to the processing job of the worker
+  worker->m_current = work;
+  worker->m_current.m_startTime = XbmcThreads::SystemClockMillis();
+  worker->m_processing = true;
+  work.m_job->m_callback = this;
+
+  lane.queued--;
+  lane.busy++;
+
+  const unsigned int waitMs = worker->m_current.m_startTime - work.m_queuedTime;
+
+  CSingleLock statsLock(lane.statsSection);
+  JobTypeStats &stats = lane.stats[work.m_job->GetType()];
+  stats.queued--;
+  stats.processing++;
+  if (stolen)
+    stats.stolen++;
+  stats.totalWaitMs += waitMs;
+  stats.maxWaitMs = std::max(stats.maxWaitMs, waitMs);
+}
+
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
   m_pauseJobs = false;
+
+  CLane &lane = m_lanes[CJob::PRIORITY_LOW_PAUSABLE];
+  CSingleLock lock(lane.section);
+
+  // idle workers may have stopped while paused
+  StartWorkers(CJob::PRIORITY_LOW_PAUSABLE);
+  lane.jobCondition.notifyAll();
 }
 
-bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
+bool CJobManager::IsPaused(CJob::PRIORITY priority) const
 {
-  CSingleLock lock(m_section);
+  return priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs;
+}
 
+bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
+{
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
-  {
-    if (priority == it->m_priority)
-      return true;
-  }
-  return false;
+  return m_lanes[priority].busy > 0;
 }
 
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (const CLane &lane : m_lanes)
   {
-    if (type == std::string(it->m_job->GetType()))
-      jobsMatched++;
+    CSingleLock lock(lane.section);
+
+    for (CJobWorker *worker : lane.workers)
+    {
+      CSingleLock workerLock(worker->m_section);
+      if (worker->m_processing && type == std::string(worker->m_current.m_job->GetType()))
+        jobsMatched++;
+    }
   }
   return jobsMatched;
 }
 
-CJob *CJobManager::GetNextJob(const CJobWorker *worker)
+std::map<std::string, CJobManager::JobTypeStats> CJobManager::GetJobStats() const
 {
-  CSingleLock lock(m_section);
+  std::map<std::string, JobTypeStats> result;
+
+  for (const CLane &lane : m_lanes)
+  {
+    CSingleLock lock(lane.statsSection);
+
+    for (const auto &it : lane.stats)
+    {
+      JobTypeStats &stats = result[it.first];
+      stats.queued += it.second.queued;
+      stats.processing += it.second.processing;
+      stats.completed += it.second.completed;
+      stats.cancelled += it.second.cancelled;
+      stats.stolen += it.second.stolen;
+      stats.totalWaitMs += it.second.totalWaitMs;
+      stats.maxWaitMs = std::max(stats.maxWaitMs, it.second.maxWaitMs);
+      stats.totalRunMs += it.second.totalRunMs;
+      stats.maxRunMs = std::max(stats.maxRunMs, it.second.maxRunMs);
+    }
+  }
+
+  return result;
+}
+
+void CJobManager::ResetJobStats()
+{
+  for (CLane &lane : m_lanes)
+  {
+    CSingleLock lock(lane.statsSection);
+
+    for (auto &it : lane.stats)
+    {
+      JobTypeStats stats;
+      stats.queued = it.second.queued;
+      stats.processing = it.second.processing;
+      it.second = stats;
+    }
+  }
+}
+
+CJob *CJobManager::GetNextJob(CJobWorker *worker)
+{
+  CLane &lane = m_lanes[worker->m_priority];
+
   while (m_running)
   {
     // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    CJob *job = PopJob(worker);
     if (job)
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
+
+    CSingleLock lock(lane.section);
+    if (!m_running)
       break;
+
+    // ensure no jobs have come in since we looked
+    const bool paused = IsPaused(worker->m_priority);
+    if (lane.queued > 0 && !paused)
+      continue;
+
+    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+    if (!lane.jobCondition.wait(lock, 30000))
+    {
+      bool empty;
+      {
+        CSingleLock workerLock(worker->m_section);
+        empty = worker->m_jobQueue.empty();
+      }
+
+      // keep our paused jobs, other workers can't steal them once we're gone
+      if (lane.queued == 0 || (paused && empty))
+      {
+        // have no jobs
+        RemoveWorker(worker);
+        return NULL;
+      }
+    }
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
-  // have no jobs
+
   RemoveWorker(worker);
   return NULL;
 }
 
 bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  // find the job being processed, and check whether it's cancelled (no callback)
+  for (const CLane &lane : m_lanes)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    CSingleLock lock(lane.section);
+
+    for (CJobWorker *worker : lane.workers)
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      CSingleLock workerLock(worker->m_section);
+      if (worker->m_processing && worker->m_current.m_job == job)
+      {
+        CWorkItem item(worker->m_current);
+        workerLock.Leave();
+        lock.Leave(); // leave section prior to call
+        if (item.m_callback)
+        {
+          item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+          return false;
+        }
+        return true;
+      }
     }
   }
   return true; // couldn't find the job, or it's been cancelled
 }
 
-void CJobManager::OnJobComplete(bool success, CJob *job)
+void CJobManager::OnJobComplete(CJobWorker *worker, bool success, CJob *job)
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CLane &lane = m_lanes[worker->m_priority];
+
+  CSingleLock lock(worker->m_section);
+  if (!worker->m_processing || worker->m_current.m_job != job)
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  CWorkItem item(worker->m_current);
+  lock.Leave();
+  try
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
-    {
-      if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
-    }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
+    if (item.m_callback)
+      item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
   }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
+  }
+  lock.Enter();
+  const bool cancelled = worker->m_current.m_cancelled;
+  worker->m_processing = false;
+  lane.busy--;
+  lock.Leave();
+
+  const unsigned int runMs = XbmcThreads::SystemClockMillis() - item.m_startTime;
+  {
+    CSingleLock statsLock(lane.statsSection);
+    JobTypeStats &stats = lane.stats[item.m_job->GetType()];
+    stats.processing--;
+    if (cancelled)
+      stats.cancelled++;
+    else
+      stats.completed++;
+    stats.totalRunMs += runMs;
+    stats.maxRunMs = std::max(stats.maxRunMs, runMs);
+  }
+
+  item.FreeJob();
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  CLane &lane = m_lanes[worker->m_priority];
+  CSingleLock lock(lane.section);
   // remove our worker
-  Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
-  if (i != m_workers.end())
-    m_workers.erase(i); // workers auto-delete
+  std::vector<CJobWorker*>::iterator i = find(lane.workers.begin(), lane.workers.end(), worker);
+  if (i != lane.workers.end())
+    lane.workers.erase(i); // workers auto-delete
 }
 
 unsigned int CJobManager::GetMaxWorkers(CJob::PRIORITY priority)
 {
-  static const unsigned int max_workers = 5;
+  // workers are started on demand, up to this number for each priority
+  static const unsigned int max_workers = 2;
   if (priority == CJob::PRIORITY_DEDICATED)
     return 10000; // A large number..
-  return max_workers - (CJob::PRIORITY_HIGH - priority);
+  return max_workers;
 }
@@ -8,25 +8,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <map>
 #include <queue>
+#include <stdint.h>
 #include <vector>
 #include <string>
+#include "threads/Condition.h"
 #include "threads/CriticalSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
 
 class CJobManager;
-
-class CJobWorker : public CThread
-{
-public:
-  explicit CJobWorker(CJobManager *manager);
-  ~CJobWorker() override;
-
-  void Process() override;
-private:
-  CJobManager  *m_jobManager;
-};
+class CJobWorker;
 
 template<typename F>
 class CLambdaJob : public CJob
@@ -141,6 +136,11 @@ public:
    */
   bool IsProcessing() const;
 
+  /*!
+   \brief Returns the number of jobs waiting or processing in the queue
+   */
+  size_t GetJobCount() const;
+
   /*!
    \brief The callback used when a job completes.
 
@@ -182,9 +182,10 @@ private:
  \brief Job Manager class for scheduling asynchronous jobs.
 
  Controls asynchronous job execution, by allowing clients to add and cancel jobs.
- Should be accessed via CJobManager::GetInstance().  Jobs are allocated based on
- priority levels.  Lower priority jobs are executed only if there are sufficient
- spare worker threads free to allow for higher priority jobs that may arise.
+ Should be accessed via CJobManager::GetInstance().  Each priority level has its
+ own lane of worker threads, started on demand, so jobs of one priority never wait
+ for jobs of another.  Within a lane, jobs are queued on the workers in turn, and
+ a worker whose queue is empty steals the newest job of another worker.
 
  \sa CJob and IJobCallback
  */
@@ -199,6 +200,9 @@ class CJobManager final
       m_id = id;
       m_callback = callback;
       m_priority = priority;
+      m_queuedTime = 0;
+      m_startTime = 0;
+      m_cancelled = false;
     }
     bool operator==(unsigned int jobID) const
     {
@@ -216,14 +220,35 @@ class CJobManager final
     void Cancel()
     {
       m_callback = NULL;
+      m_cancelled = true;
     };
     CJob         *m_job;
     unsigned int  m_id;
     IJobCallback *m_callback;
     CJob::PRIORITY m_priority;
+    unsigned int  m_queuedTime;
+    unsigned int  m_startTime;
+    bool          m_cancelled;
   };
 
 public:
+  /*!
+   \brief Queue depth and latency of the jobs of one type
+   \sa GetJobStats()
+   */
+  struct JobTypeStats
+  {
+    unsigned int queued = 0;     //!< Jobs waiting for a worker
+    unsigned int processing = 0; //!< Jobs being processed
+    uint64_t completed = 0;
+    uint64_t cancelled = 0;
+    uint64_t stolen = 0;         //!< Jobs taken from the queue of another worker
+    uint64_t totalWaitMs = 0;    //!< Time from AddJob() until processing started
+    unsigned int maxWaitMs = 0;
+    uint64_t totalRunMs = 0;     //!< Time spent in DoWork() and the completion callback
+    unsigned int maxRunMs = 0;
+  };
+
   /*!
    \brief The only way through which the global instance of the CJobManager should be accessed.
    \return the global instance.
@@ -308,6 +333,19 @@ public:
    */
   bool IsProcessing(const CJob::PRIORITY &priority) const;
 
+  /*!
+   \brief Get the queue depth and latency of every job type seen so far
+   \return statistics indexed by CJob::GetType()
+   */
+  std::map<std::string, JobTypeStats> GetJobStats() const;
+
+  /*!
+   \brief Reset the counters and latencies of the job statistics
+   Jobs that are queued or processing are still accounted for.
+   \sa GetJobStats()
+   */
+  void ResetJobStats();
+
 protected:
   friend class CJobWorker;
   friend class CJob;
@@ -318,16 +356,17 @@ protected:
    \param worker a pointer to the current CJobWorker instance requesting a job.
    \sa CJob
    */
-  CJob *GetNextJob(const CJobWorker *worker);
+  CJob *GetNextJob(CJobWorker *worker);
 
   /*!
    \brief Callback from CJobWorker after a job has completed.
    Calls IJobCallback::OnJobComplete(), and then destroys job.
-   \param job a pointer to the calling subclassed CJob instance.
+   \param worker a pointer to the CJobWorker instance that processed the job.
    \param success the result from the DoWork call
+   \param job a pointer to the calling subclassed CJob instance.
    \sa IJobCallback, CJob
    */
-  void  OnJobComplete(bool success, CJob *job);
+  void  OnJobComplete(CJobWorker *worker, bool success, CJob *job);
 
   /*!
    \brief Callback from CJob to report progress and check for cancellation.
@@ -346,27 +385,63 @@ private:
   CJobManager(const CJobManager&) = delete;
   CJobManager const& operator=(CJobManager const&) = delete;
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*!
+   \brief Workers and queued jobs of one priority
+   Each priority has its own workers, so a flood of low priority jobs never
+   delays a high priority job. Jobs are queued on the workers in turn, and
+   a worker with an empty queue steals from the others.
+   */
+  struct CLane
+  {
+    mutable CCriticalSection section;
+    XbmcThreads::ConditionVariable jobCondition;
+    std::vector<CJobWorker*> workers;
+    unsigned int nextWorker = 0;
+    std::atomic<unsigned int> queued{0};
+    std::atomic<unsigned int> busy{0};
+
+    mutable CCriticalSection statsSection;
+    std::map<std::string, JobTypeStats> stats;
+  };
+
+  /*! \brief Pop a job off the queue of the worker, or steal one from another worker of its lane
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(CJobWorker *worker);
+  void StartProcessing(CJobWorker *worker, const CWorkItem &work, bool stolen);
 
   void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
+  bool IsPaused(CJob::PRIORITY priority) const;
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  std::atomic<unsigned int> m_jobCounter;
 
   typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
-  typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_DEDICATED + 1];
-  bool       m_pauseJobs;
-  Processing m_processing;
-  Workers    m_workers;
+  CLane      m_lanes[CJob::PRIORITY_DEDICATED + 1];
+  std::atomic<bool> m_pauseJobs;
 
   mutable CCriticalSection m_section;
-  CEvent           m_jobEvent;
-  bool             m_running;
+  std::atomic<bool> m_running;
+};
+
+class CJobWorker : public CThread
+{
+public:
+  CJobWorker(CJobManager *manager, CJob::PRIORITY priority);
+  ~CJobWorker() override;
+
+  void Process() override;
+private:
+  friend class CJobManager;
+
+  CJobManager  *m_jobManager;
+  CJob::PRIORITY m_priority;
+
+  // Guards the queue and the job being processed
+  CCriticalSection m_section;
+  CJobManager::JobQueue m_jobQueue;
+  CJobManager::CWorkItem m_current;
+  bool m_processing;
 };
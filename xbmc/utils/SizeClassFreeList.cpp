@@ -0,0 +1,81 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "SizeClassFreeList.h"
+
+#include <algorithm>
+
+CSizeClassFreeList::CSizeClassFreeList(size_t minSize, size_t maxSize)
+{
+  for (size_t size = minSize; size < maxSize; size *= 2)
+  {
+    for (size_t quarter = 4; quarter < 8; quarter++)
+      m_classSizes.push_back(size * quarter / 4);
+  }
+  m_classSizes.push_back(maxSize);
+
+  m_freeBlocks.resize(m_classSizes.size());
+}
+
+int CSizeClassFreeList::GetSizeClass(size_t size) const
+{
+  auto it = std::lower_bound(m_classSizes.begin(), m_classSizes.end(), size);
+  if (it == m_classSizes.end())
+    return -1;
+
+  return static_cast<int>(it - m_classSizes.begin());
+}
+
+uint8_t* CSizeClassFreeList::Pop(int sizeClass)
+{
+  std::vector<uint8_t*>& blocks = m_freeBlocks[sizeClass];
+  if (blocks.empty())
+    return nullptr;
+
+  uint8_t* block = blocks.back();
+  blocks.pop_back();
+
+  return block;
+}
+
+void CSizeClassFreeList::Push(int sizeClass, uint8_t* block)
+{
+  m_freeBlocks[sizeClass].push_back(block);
+}
+
+uint8_t* CSizeClassFreeList::PopLargest(int keepClass, int& sizeClass)
+{
+  sizeClass = -1;
+  size_t largestBytes = 0;
+  for (size_t i = 0; i < m_freeBlocks.size(); i++)
+  {
+    const size_t bytes = m_freeBlocks[i].size() * m_classSizes[i];
+    if (static_cast<int>(i) != keepClass && bytes > largestBytes)
+    {
+      sizeClass = static_cast<int>(i);
+      largestBytes = bytes;
+    }
+  }
+
+  if (sizeClass < 0)
+    return nullptr;
+
+  return Pop(sizeClass);
+}
+
+std::vector<uint8_t*> CSizeClassFreeList::PopAll()
+{
+  std::vector<uint8_t*> blocks;
+  for (auto& freeBlocks : m_freeBlocks)
+  {
+    blocks.insert(blocks.end(), freeBlocks.begin(), freeBlocks.end());
+    freeBlocks.clear();
+  }
+
+  return blocks;
+}
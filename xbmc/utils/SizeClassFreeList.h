@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/*!
+ * \brief Free lists of memory blocks grouped in size classes
+ *
+ * The size classes are spaced a quarter power of two apart, from a min to
+ * a max size, so a block wastes at most a fifth of its size and a request
+ * of a similar size can reuse it.
+ *
+ * Only keeps track of the blocks, the owner allocates and frees them and
+ * provides the locking.
+ */
+class CSizeClassFreeList
+{
+public:
+  CSizeClassFreeList(size_t minSize, size_t maxSize);
+
+  /*!
+   * \brief Get the smallest size class that fits size bytes
+   *
+   * \return The size class, or -1 if size is larger than the max size
+   */
+  int GetSizeClass(size_t size) const;
+
+  size_t GetClassSize(int sizeClass) const { return m_classSizes[sizeClass]; }
+
+  /*!
+   * \brief Get the number of blocks on the free list of a size class
+   */
+  size_t GetCount(int sizeClass) const { return m_freeBlocks[sizeClass].size(); }
+
+  /*!
+   * \brief Take a block from the free list of a size class
+   *
+   * \return The block, or nullptr if the free list is empty
+   */
+  uint8_t* Pop(int sizeClass);
+
+  void Push(int sizeClass, uint8_t* block);
+
+  /*!
+   * \brief Take a block from the size class holding the most memory
+   *
+   * \param keepClass A size class to leave alone, or -1
+   * \param[out] sizeClass The size class of the block
+   *
+   * \return The block, or nullptr if the other free lists are empty
+   */
+  uint8_t* PopLargest(int keepClass, int& sizeClass);
+
+  /*!
+   * \brief Take the blocks of all free lists
+   */
+  std::vector<uint8_t*> PopAll();
+
+private:
+  std::vector<size_t> m_classSizes;
+  std::vector<std::vector<uint8_t*>> m_freeBlocks;
+};
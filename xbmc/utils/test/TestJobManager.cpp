@@ -11,6 +11,7 @@
 
 #include "gtest/gtest.h"
 #include <atomic>
+#include <string>
 
 #ifdef TARGET_POSIX
 #include "platform/linux/XTimeUtils.h"
@@ -36,6 +37,8 @@ class TestJobManager : public testing::Test
 protected:
   TestJobManager()
   {
+    /* The stats live in the singleton, start each test from zero */
+    CJobManager::GetInstance().ResetJobStats();
   }
 
   ~TestJobManager() override
@@ -134,10 +137,12 @@ private:
 };
 
 BroadcastingJob *
-WaitForJobToStartProcessing(CJob::PRIORITY priority, JobControlPackage &package)
+WaitForJobToStartProcessing(CJob::PRIORITY priority, JobControlPackage &package, unsigned int *id = NULL)
 {
   BroadcastingJob* job = new BroadcastingJob(package);
-  CJobManager::GetInstance().AddJob(job, NULL, priority);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(job, NULL, priority);
+  if (id)
+    *id = jobID;
 
   // We're now ready to wait, wait and then unblock once ready
   while (!package.ready)
@@ -170,3 +175,116 @@ TEST_F(TestJobManager, IsProcessing)
 
   job->FinishAndStopBlocking();
 }
+
+namespace
+{
+class StatsJob : public CJob
+{
+public:
+  explicit StatsJob(const char *type = "StatsJob") :
+    m_type(type)
+  {
+  }
+
+  const char * GetType() const override
+  {
+    return m_type;
+  }
+
+  bool DoWork() override
+  {
+    return true;
+  }
+
+private:
+  const char *m_type;
+};
+
+bool WaitForJobsDone(const std::string &type, uint64_t count)
+{
+  for (int i = 0; i < 500; i++)
+  {
+    CJobManager::JobTypeStats stats = CJobManager::GetInstance().GetJobStats()[type];
+    if (stats.processing == 0 && stats.completed + stats.cancelled >= count)
+      return true;
+    Sleep(10);
+  }
+  return false;
+}
+}
+
+TEST_F(TestJobManager, CancelQueuedJob)
+{
+  CJobManager::GetInstance().PauseJobs();
+
+  unsigned int id = CJobManager::GetInstance().AddJob(new StatsJob(), NULL, CJob::PRIORITY_LOW_PAUSABLE);
+  EXPECT_EQ(1u, CJobManager::GetInstance().GetJobStats()["StatsJob"].queued);
+
+  CJobManager::GetInstance().CancelJob(id);
+  CJobManager::JobTypeStats stats = CJobManager::GetInstance().GetJobStats()["StatsJob"];
+  EXPECT_EQ(0u, stats.queued);
+  EXPECT_EQ(1u, stats.cancelled);
+  EXPECT_EQ(0u, stats.completed);
+
+  CJobManager::GetInstance().UnPauseJobs();
+}
+
+TEST_F(TestJobManager, CancelProcessingJob)
+{
+  JobControlPackage package;
+  unsigned int id;
+  BroadcastingJob *job (WaitForJobToStartProcessing(CJob::PRIORITY_NORMAL, package, &id));
+
+  CJobManager::GetInstance().CancelJob(id);
+  job->FinishAndStopBlocking();
+
+  ASSERT_TRUE(WaitForJobsDone("BroadcastingJob", 1));
+  CJobManager::JobTypeStats stats = CJobManager::GetInstance().GetJobStats()["BroadcastingJob"];
+  EXPECT_EQ(1u, stats.cancelled);
+  EXPECT_EQ(0u, stats.completed);
+}
+
+TEST_F(TestJobManager, StealJobs)
+{
+  // block one of the two workers of the lane, the jobs queued on it can
+  // only run if the other worker steals them
+  JobControlPackage package;
+  BroadcastingJob *job (WaitForJobToStartProcessing(CJob::PRIORITY_NORMAL, package));
+
+  for (int i = 0; i < 10; i++)
+    CJobManager::GetInstance().AddJob(new StatsJob(), NULL, CJob::PRIORITY_NORMAL);
+
+  EXPECT_TRUE(WaitForJobsDone("StatsJob", 10));
+  CJobManager::JobTypeStats stats = CJobManager::GetInstance().GetJobStats()["StatsJob"];
+  EXPECT_EQ(10u, stats.completed);
+  EXPECT_LT(0u, stats.stolen);
+
+  job->FinishAndStopBlocking();
+}
+
+TEST_F(TestJobManager, PriorityIsolation)
+{
+  // keep all low priority workers busy, with a backlog behind them
+  BroadcastingJob *job1;
+  BroadcastingJob *job2;
+  {
+    JobControlPackage package;
+    job1 = WaitForJobToStartProcessing(CJob::PRIORITY_LOW, package);
+  }
+  {
+    JobControlPackage package;
+    job2 = WaitForJobToStartProcessing(CJob::PRIORITY_LOW, package);
+  }
+
+  for (int i = 0; i < 100; i++)
+    CJobManager::GetInstance().AddJob(new StatsJob(), NULL, CJob::PRIORITY_LOW);
+
+  CJobManager::GetInstance().AddJob(new StatsJob("HighJob"), NULL, CJob::PRIORITY_HIGH);
+
+  EXPECT_TRUE(WaitForJobsDone("HighJob", 1));
+  EXPECT_EQ(1u, CJobManager::GetInstance().GetJobStats()["HighJob"].completed);
+  EXPECT_EQ(100u, CJobManager::GetInstance().GetJobStats()["StatsJob"].queued);
+
+  job1->FinishAndStopBlocking();
+  job2->FinishAndStopBlocking();
+}